@@ -0,0 +1,50 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "anchor-validation-policy.hpp"
+
+#include <ndn-cxx/security/certificate-fetcher-offline.hpp>
+
+namespace chronochat {
+
+using ndn::security::CertificateRequest;
+using ndn::security::ValidationState;
+
+void
+AnchorValidationPolicy::checkPolicy(const Data& data, const shared_ptr<ValidationState>& state,
+                                    const ValidationContinuation& continueValidation)
+{
+  Name keyLocatorName = ndn::security::getKeyLocatorName(data, *state);
+  if (!state->getOutcome()) // already failed
+    return;
+
+  continueValidation(std::make_shared<CertificateRequest>(keyLocatorName), state);
+}
+
+void
+AnchorValidationPolicy::checkPolicy(const Interest& interest,
+                                    const shared_ptr<ValidationState>& state,
+                                    const ValidationContinuation& continueValidation)
+{
+  Name keyLocatorName = ndn::security::getKeyLocatorName(interest, *state);
+  if (!state->getOutcome()) // already failed
+    return;
+
+  continueValidation(std::make_shared<CertificateRequest>(keyLocatorName), state);
+}
+
+shared_ptr<ndn::security::Validator>
+AnchorValidationPolicy::makeValidator(const ndn::security::Certificate& certificate)
+{
+  auto validator = std::make_shared<ndn::security::Validator>(
+    std::make_unique<AnchorValidationPolicy>(),
+    std::make_unique<ndn::security::CertificateFetcherOffline>());
+  validator->loadAnchor(certificate.getName().toUri(), ndn::security::Certificate(certificate));
+  return validator;
+}
+
+} // namespace chronochat
@@ -0,0 +1,47 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_ANCHOR_VALIDATION_POLICY_HPP
+#define CHRONOCHAT_ANCHOR_VALIDATION_POLICY_HPP
+
+#include "common.hpp"
+
+#include <ndn-cxx/security/certificate.hpp>
+#include <ndn-cxx/security/validation-policy.hpp>
+#include <ndn-cxx/security/validator.hpp>
+
+namespace chronochat {
+
+/**
+ * @brief accept only the packets signed directly by a trust anchor of the validator
+ *
+ * The certificate named by the KeyLocator is requested from the validator, which finds it
+ * among its anchors or fails: with an offline certificate fetcher no other certificate is
+ * retrieved, so a packet signed by any other key is rejected. The owner of the validator
+ * pins the certificates of a single exchange by loading them as anchors.
+ */
+class AnchorValidationPolicy : public ndn::security::ValidationPolicy
+{
+public:
+  void
+  checkPolicy(const Data& data, const shared_ptr<ndn::security::ValidationState>& state,
+              const ValidationContinuation& continueValidation) override;
+
+  void
+  checkPolicy(const Interest& interest, const shared_ptr<ndn::security::ValidationState>& state,
+              const ValidationContinuation& continueValidation) override;
+
+  /**
+   * @brief create a validator which accepts only the packets signed with @p certificate
+   */
+  static shared_ptr<ndn::security::Validator>
+  makeValidator(const ndn::security::Certificate& certificate);
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_ANCHOR_VALIDATION_POLICY_HPP
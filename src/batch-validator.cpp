@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "batch-validator.hpp"
+
+#include <thread>
+#include <ndn-cxx/security/verification-helpers.hpp>
+
+namespace chronochat {
+
+// fewer checks than this on a thread cost more to hand out than to run
+static const size_t MIN_CHECKS_PER_THREAD = 8;
+
+enum {
+  UNDECIDED,
+  VALIDATED,
+  FAILED
+};
+
+class BatchValidator::Batch
+{
+public:
+  std::vector<shared_ptr<const Data>> packets;
+  std::vector<int> outcomes;
+  // the validations still running, plus one while they are being started
+  size_t nPending;
+  DeliverCallback deliver;
+};
+
+static bool
+isSignedWithGroupKey(const Data& data)
+{
+  return data.getSignatureInfo().getSignatureType() == ndn::tlv::SignatureHmacWithSha256;
+}
+
+BatchValidator::BatchValidator(ndn::security::Validator& validator,
+                               VerifiedKeyCache& verifiedKeys,
+                               const GroupKeyValidationPolicy::GetGroupKey& getGroupKey,
+                               size_t nThreads)
+  : m_validator(validator)
+  , m_verifiedKeys(verifiedKeys)
+  , m_getGroupKey(getGroupKey)
+  , m_nThreads(nThreads)
+  , m_nFullValidations(0)
+{
+  if (m_nThreads == 0)
+    m_nThreads = std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+void
+BatchValidator::validate(const std::vector<shared_ptr<const Data>>& packets,
+                         const DeliverCallback& deliver)
+{
+  auto batch = std::make_shared<Batch>();
+  batch->packets = packets;
+  batch->outcomes.assign(packets.size(), UNDECIDED);
+  batch->nPending = 1;
+  batch->deliver = deliver;
+
+  std::vector<size_t> known;
+  std::vector<size_t> unknown;
+  std::map<Name, std::vector<size_t>> signers;
+  for (size_t i = 0; i < packets.size(); i++) {
+    const Data& data = *packets[i];
+    const ndn::SignatureInfo& info = data.getSignatureInfo();
+    if (isSignedWithGroupKey(data) || m_verifiedKeys.findKey(data) != nullptr)
+      known.push_back(i);
+    else if (info.hasKeyLocator() && info.getKeyLocator().getType() == tlv::Name)
+      signers[info.getKeyLocator().getName()].push_back(i);
+    else
+      unknown.push_back(i);
+  }
+
+  verifyInParallel(*batch, known);
+
+  for (size_t index : unknown) {
+    batch->nPending++;
+    validateInFull(batch, index, [this, batch] { finishOne(batch); });
+  }
+
+  for (const auto& signer : signers) {
+    const std::vector<size_t>& indexes = signer.second;
+    batch->nPending++;
+    validateInFull(batch, indexes.front(),
+                   [this, batch, indexes] { onFirstValidated(batch, indexes); });
+  }
+
+  finishOne(batch);
+}
+
+void
+BatchValidator::verifyInParallel(Batch& batch, const std::vector<size_t>& indexes)
+{
+  shared_ptr<const GroupKey> groupKey = m_getGroupKey();
+
+  std::vector<size_t> checked;
+  // the key of each checked packet, nullptr for the group key
+  std::vector<shared_ptr<const ndn::security::transform::PublicKey>> keys;
+  for (size_t index : indexes) {
+    const Data& data = *batch.packets[index];
+    if (isSignedWithGroupKey(data)) {
+      if (groupKey == nullptr) {
+        batch.outcomes[index] = FAILED;
+        continue;
+      }
+      checked.push_back(index);
+      keys.push_back(nullptr);
+    }
+    else {
+      auto key = m_verifiedKeys.findKey(data);
+      if (key == nullptr)
+        continue;
+      checked.push_back(index);
+      keys.push_back(key);
+    }
+  }
+
+  if (checked.empty())
+    return;
+
+  size_t nThreads = std::min(m_nThreads,
+                             (checked.size() + MIN_CHECKS_PER_THREAD - 1) / MIN_CHECKS_PER_THREAD);
+  // every thread checks its own packets, which are only read
+  std::vector<char> results(checked.size(), 0);
+  auto check = [&] (size_t first) {
+    for (size_t i = first; i < checked.size(); i += nThreads) {
+      const Data& data = *batch.packets[checked[i]];
+      if (keys[i] != nullptr)
+        results[i] = ndn::security::verifySignature(data, *keys[i]);
+      else
+        results[i] = groupKey->verify(data);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < nThreads; t++)
+    threads.emplace_back(check, t);
+  check(0);
+  for (auto& thread : threads)
+    thread.join();
+
+  for (size_t i = 0; i < checked.size(); i++)
+    batch.outcomes[checked[i]] = results[i] ? VALIDATED : FAILED;
+}
+
+void
+BatchValidator::validateInFull(const shared_ptr<Batch>& batch, size_t index,
+                               const function<void()>& onComplete)
+{
+  m_nFullValidations++;
+  m_validator.validate(*batch->packets[index],
+    [this, batch, index, onComplete] (const Data& data) {
+      batch->outcomes[index] = VALIDATED;
+      if (!isSignedWithGroupKey(data))
+        m_verifiedKeys.learn(data, m_validator);
+      onComplete();
+    },
+    [batch, index, onComplete] (const Data& data, const ndn::security::ValidationError& error) {
+      batch->outcomes[index] = FAILED;
+      onComplete();
+    });
+}
+
+void
+BatchValidator::onFirstValidated(const shared_ptr<Batch>& batch,
+                                 const std::vector<size_t>& indexes)
+{
+  // the sessions whose key was learnt with the first packet need a signature check only
+  std::vector<size_t> others(indexes.begin() + 1, indexes.end());
+  verifyInParallel(*batch, others);
+
+  for (size_t index : others) {
+    if (batch->outcomes[index] != UNDECIDED)
+      continue;
+    // another session of the signer, its certificate is now found locally
+    batch->nPending++;
+    validateInFull(batch, index, [this, batch] { finishOne(batch); });
+  }
+
+  finishOne(batch);
+}
+
+void
+BatchValidator::finishOne(const shared_ptr<Batch>& batch)
+{
+  BOOST_ASSERT(batch->nPending > 0);
+  if (--batch->nPending > 0)
+    return;
+
+  for (size_t i = 0; i < batch->packets.size(); i++)
+    batch->deliver(*batch->packets[i], batch->outcomes[i] == VALIDATED);
+}
+
+} // namespace chronochat
@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_BATCH_VALIDATOR_HPP
+#define CHRONOCHAT_BATCH_VALIDATOR_HPP
+
+#include "common.hpp"
+#include "group-key-validation-policy.hpp"
+#include "verified-key-cache.hpp"
+
+namespace chronochat {
+
+/**
+ * @brief validate the chat data fetched together, when catching up after a disconnection
+ *
+ * The packets are grouped by signer. The first packet of each signer goes through the full
+ * validation, which fetches and verifies its certificate once; the keys of the sessions learnt
+ * this way make the other packets of the signer a single signature check, and those checks,
+ * like the ones of the packets signed with the group key, run in parallel on several threads.
+ * The outcomes are delivered in the order of the batch, once all of them are known.
+ */
+class BatchValidator
+{
+public:
+  typedef function<void(const Data& data, bool isValidated)> DeliverCallback;
+
+  /**
+   * @param validator the full validator, which must be used from a single thread
+   * @param verifiedKeys the keys of the sessions, shared with @p validator
+   * @param getGroupKey get the current group key, or nullptr if there is none
+   * @param nThreads the maximum number of threads checking signatures, 0 for the number of
+   *                 hardware threads
+   */
+  BatchValidator(ndn::security::Validator& validator,
+                 VerifiedKeyCache& verifiedKeys,
+                 const GroupKeyValidationPolicy::GetGroupKey& getGroupKey,
+                 size_t nThreads = 0);
+
+  /**
+   * @brief validate @p packets, then call @p deliver for each of them, in order
+   *
+   * @p deliver may be called before this method returns, if no certificate has to be fetched.
+   */
+  void
+  validate(const std::vector<shared_ptr<const Data>>& packets, const DeliverCallback& deliver);
+
+  /**
+   * @return the number of packets that went through the full validation
+   */
+  size_t
+  getNFullValidations() const
+  {
+    return m_nFullValidations;
+  }
+
+private:
+  class Batch;
+
+  /**
+   * @brief check the signatures of @p indexes against their known keys, on several threads
+   *
+   * A packet whose key is not known is left undecided.
+   */
+  void
+  verifyInParallel(Batch& batch, const std::vector<size_t>& indexes);
+
+  /**
+   * @brief validate the packet at @p index with the full validator
+   */
+  void
+  validateInFull(const shared_ptr<Batch>& batch, size_t index,
+                 const function<void()>& onComplete);
+
+  /**
+   * @brief go on with the other packets of a signer, once its first packet is validated
+   */
+  void
+  onFirstValidated(const shared_ptr<Batch>& batch, const std::vector<size_t>& indexes);
+
+  void
+  finishOne(const shared_ptr<Batch>& batch);
+
+private:
+  ndn::security::Validator& m_validator;
+  VerifiedKeyCache& m_verifiedKeys;
+  GroupKeyValidationPolicy::GetGroupKey m_getGroupKey;
+  size_t m_nThreads;
+  size_t m_nFullValidations;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_BATCH_VALIDATOR_HPP
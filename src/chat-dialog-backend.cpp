@@ -10,12 +10,16 @@
  */
 
 #include "chat-dialog-backend.hpp"
+#include "group-key-validation-policy.hpp"
+#include "verified-key-validation-policy.hpp"
 
 #include <QFile>
 
 #ifndef Q_MOC_RUN
 #include <boost/iostreams/stream.hpp>
 
+#include <ndn-cxx/security/certificate-fetcher-from-network.hpp>
+#include <ndn-cxx/security/validation-policy-config.hpp>
 #include <ndn-cxx/util/io.hpp>
 #include <ndn-cxx/util/string-helper.hpp>
 #endif
@@ -25,8 +29,16 @@ namespace chronochat {
 static const time::milliseconds FRESHNESS_PERIOD(60000);
 static const time::seconds HELLO_INTERVAL(60);
 static const Name::Component ROUTING_HINT_SEPARATOR = Name::Component::fromEscapedString("%F0%2E");
-static const int IDENTITY_OFFSET = -3;
-static const int CONNECTION_RETRY_TIMER = 3;
+// a sync update missing at least this many chat data is a catch-up, validated as a batch
+static const size_t MIN_CATCH_UP_SIZE = 8;
+static const int FETCH_RETRIES = 2;
+
+class ChatDialogBackend::CatchUp
+{
+public:
+  std::vector<shared_ptr<const Data>> packets;
+  size_t nPending;
+};
 
 ChatDialogBackend::ChatDialogBackend(const Name& chatroomPrefix,
                                      const Name& userChatPrefix,
@@ -43,12 +55,27 @@ ChatDialogBackend::ChatDialogBackend(const Name& chatroomPrefix,
   , m_chatroomName(chatroomName)
   , m_nick(nick)
   , m_signingId(signingId)
+  , m_roster(chatroomName)
 {
   updatePrefixes();
 }
 
 ChatDialogBackend::~ChatDialogBackend() = default;
 
+void
+ChatDialogBackend::setGroupKey(shared_ptr<const GroupKey> key)
+{
+  std::lock_guard<std::mutex> lock(m_groupKeyMutex);
+  m_groupKey = std::move(key);
+}
+
+shared_ptr<const GroupKey>
+ChatDialogBackend::getGroupKey() const
+{
+  std::lock_guard<std::mutex> lock(m_groupKeyMutex);
+  return m_groupKey;
+}
+
 // protected methods:
 void
 ChatDialogBackend::run()
@@ -73,18 +100,10 @@ ChatDialogBackend::run()
         std::lock_guard<std::mutex>lock(m_resumeMutex);
         m_shouldResume = true;
       }
-#ifdef BOOST_THREAD_USES_CHRONO
-      time::seconds reconnectTimer = time::seconds(CONNECTION_RETRY_TIMER);
-#else
-      boost::posix_time::time_duration reconnectTimer;
-      reconnectTimer = boost::posix_time::seconds(CONNECTION_RETRY_TIMER);
-#endif
-      while (!m_isNfdConnected) {
-#ifdef BOOST_THREAD_USES_CHRONO
-        boost::this_thread::sleep_for(reconnectTimer);
-#else
-        boost::this_thread::sleep(reconnectTimer);
-#endif
+      {
+        // woken up by onNfdReconnect, as soon as the forwarder is back
+        std::unique_lock<std::mutex> lock(m_nfdConnectionMutex);
+        m_nfdConnectionCondition.wait(lock, [this] { return m_isNfdConnected; });
       }
       emit refreshChatDialog(m_routableUserChatPrefix);
     }
@@ -98,18 +117,33 @@ ChatDialogBackend::run()
   } while (shouldResume);
 }
 
-// private methods:
+shared_ptr<ndn::Face>
+ChatDialogBackend::makeFace()
+{
+  return std::make_shared<ndn::Face>();
+}
+
 void
 ChatDialogBackend::initializeSync()
 {
   BOOST_ASSERT(m_sock == nullptr);
 
-  m_face = std::make_shared<ndn::Face>();
+  m_face = makeFace();
   m_scheduler = std::make_unique<ndn::Scheduler>(m_face->getIoService());
 
-  // initialize validator
-  m_validator = std::make_shared<ndn::security::ValidatorConfig>(*m_face);
-  m_validator->load("security/validation-chat.conf");
+  // initialize validator, the data signed with the group key or with the known key of their
+  // session skip the configured rules
+  auto configPolicy = std::make_unique<ndn::security::ValidationPolicyConfig>();
+  ndn::security::ValidationPolicyConfig& config = *configPolicy;
+  auto policy = std::make_unique<GroupKeyValidationPolicy>([this] { return getGroupKey(); });
+  policy->setInnerPolicy(std::make_unique<VerifiedKeyValidationPolicy>(m_verifiedKeys));
+  policy->setInnerPolicy(std::move(configPolicy));
+  m_validator = std::make_shared<ndn::security::Validator>(
+    std::move(policy),
+    std::make_unique<ndn::security::CertificateFetcherFromNetwork>(*m_face));
+  config.load("security/validation-chat.conf");
+  m_batchValidator = std::make_unique<BatchValidator>(*m_validator, m_verifiedKeys,
+                                                      [this] { return getGroupKey(); });
 
   // create a new SyncSocket
   m_sock = std::make_shared<chronosync::Socket>(m_chatroomPrefix,
@@ -119,6 +153,16 @@ ChatDialogBackend::initializeSync()
                                                 m_signingId,
                                                 m_validator);
 
+  {
+    std::lock_guard<std::mutex> lock(m_groupKeyMutex);
+    m_groupKeySignedData = std::make_unique<ndn::InMemoryStoragePersistent>();
+  }
+  // the socket registers the prefix
+  m_groupKeySignedDataFilter = m_face->setInterestFilter(m_routableUserChatPrefix,
+    [this] (const ndn::InterestFilter&, const Interest& interest) {
+      onChatDataInterest(interest);
+    });
+
   // schedule a new join event
   m_scheduler->schedule(time::milliseconds(600),
                         bind(&ChatDialogBackend::sendJoin, this));
@@ -162,11 +206,20 @@ ChatDialogBackend::close()
 {
   m_scheduler->cancelAllEvents();
   m_helloEventId.reset();
+  m_sessionTimeouts.clear();
   m_roster.clear();
+  m_verifiedKeys.clear();
+  m_batchValidator.reset();
+  m_groupKeySignedDataFilter.cancel();
+  {
+    std::lock_guard<std::mutex> lock(m_groupKeyMutex);
+    m_groupKeySignedData.reset();
+  }
   m_validator.reset();
   m_sock.reset();
 }
 
+// private methods:
 void
 ChatDialogBackend::processSyncUpdate(const std::vector<chronosync::MissingDataInfo>& updates)
 {
@@ -175,33 +228,33 @@ ChatDialogBackend::processSyncUpdate(const std::vector<chronosync::MissingDataIn
   }
 
   std::vector<NodeInfo> nodeInfos;
+  std::vector<std::pair<Name, chronosync::SeqNo>> missing;
 
   for (size_t i = 0; i < updates.size(); i++) {
-    // update roster
-    if (m_roster.find(updates[i].session) == m_roster.end()) {
-      m_roster[updates[i].session].sessionPrefix = updates[i].session;
-      m_roster[updates[i].session].hasNick = false;
-    }
+    // track the session until its first message tells us the nick
+    if (m_sessionTimeouts.find(updates[i].session) == m_sessionTimeouts.end())
+      m_sessionTimeouts[updates[i].session];
 
     // fetch missing chat data
     if (updates[i].high - updates[i].low < 3) {
-      for (chronosync::SeqNo seq = updates[i].low; seq <= updates[i].high; ++seq) {
-        m_sock->fetchData(updates[i].session, seq,
-                          bind(&ChatDialogBackend::processChatData, this, _1, true, true),
-                          bind(&ChatDialogBackend::processChatData, this, _1, true, false),
-                          [] (const ndn::Interest& interest) {},
-                          2);
-      }
+      for (chronosync::SeqNo seq = updates[i].low; seq <= updates[i].high; ++seq)
+        missing.emplace_back(updates[i].session, seq);
     }
     else {
       // There are too many msgs to fetch, let's just fetch the latest one
-      m_sock->fetchData(updates[i].session, updates[i].high,
-                        bind(&ChatDialogBackend::processChatData, this, _1, true, true),
-                        bind(&ChatDialogBackend::processChatData, this, _1, true, false),
-                        [] (const ndn::Interest& interest) {},
-                        2);
+      missing.emplace_back(updates[i].session, updates[i].high);
     }
+  }
 
+  if (missing.size() >= MIN_CATCH_UP_SIZE)
+    fetchCatchUp(missing);
+  else {
+    for (const auto& entry : missing)
+      m_sock->fetchData(entry.first, entry.second,
+                        bind(&ChatDialogBackend::onChatDataValidated, this, _1),
+                        bind(&ChatDialogBackend::processChatData, this, _1, true, false),
+                        [] (const ndn::Interest& interest) {},
+                        FETCH_RETRIES);
   }
 
   // reflect the changes on GUI
@@ -209,6 +262,70 @@ ChatDialogBackend::processSyncUpdate(const std::vector<chronosync::MissingDataIn
                        QString::fromStdString(ndn::toHex(*m_sock->getRootDigest(), false)));
 }
 
+void
+ChatDialogBackend::fetchCatchUp(const std::vector<std::pair<Name, chronosync::SeqNo>>& missing)
+{
+  auto catchUp = std::make_shared<CatchUp>();
+  catchUp->packets.resize(missing.size());
+  catchUp->nPending = missing.size();
+
+  for (size_t i = 0; i < missing.size(); i++) {
+    // the Interest of Socket::fetchData, the data is not validated on arrival
+    Interest interest(Name(missing[i].first).appendNumber(missing[i].second));
+    interest.setMustBeFresh(true);
+    fetchCatchUpData(catchUp, i, interest, FETCH_RETRIES);
+  }
+}
+
+void
+ChatDialogBackend::fetchCatchUpData(const shared_ptr<CatchUp>& catchUp, size_t index,
+                                    const Interest& interest, int nRetries)
+{
+  m_face->expressInterest(interest,
+    [this, catchUp, index] (const Interest&, const Data& data) {
+      catchUp->packets[index] = std::make_shared<Data>(data);
+      onCatchUpDataFetched(catchUp);
+    },
+    [this, catchUp] (const Interest&, const ndn::lp::Nack&) {
+      onCatchUpDataFetched(catchUp);
+    },
+    [this, catchUp, index, nRetries] (const Interest& expired) {
+      if (nRetries > 0) {
+        Interest retry(expired);
+        retry.refreshNonce();
+        fetchCatchUpData(catchUp, index, retry, nRetries - 1);
+      }
+      else
+        onCatchUpDataFetched(catchUp);
+    });
+}
+
+void
+ChatDialogBackend::onCatchUpDataFetched(const shared_ptr<CatchUp>& catchUp)
+{
+  if (--catchUp->nPending > 0 || m_batchValidator == nullptr)
+    return;
+
+  // the data that could not be fetched are skipped, as with Socket::fetchData
+  std::vector<shared_ptr<const Data>> packets;
+  for (const auto& packet : catchUp->packets)
+    if (packet != nullptr)
+      packets.push_back(packet);
+
+  m_batchValidator->validate(packets, [this] (const Data& data, bool isValidated) {
+    processChatData(data, true, isValidated);
+  });
+}
+
+void
+ChatDialogBackend::onChatDataValidated(const ndn::Data& data)
+{
+  if (data.getSignatureInfo().getSignatureType() != ndn::tlv::SignatureHmacWithSha256)
+    m_verifiedKeys.learn(data, *m_validator);
+
+  processChatData(data, true, true);
+}
+
 void
 ChatDialogBackend::processChatData(const ndn::Data& data, bool needDisplay, bool isValidated)
 {
@@ -227,29 +344,26 @@ ChatDialogBackend::processChatData(const ndn::Data& data, bool needDisplay, bool
   Name remoteSessionPrefix = data.getName().getPrefix(-1);
 
   if (msg.getMsgType() == ChatMessage::LEAVE) {
-    BackendRoster::iterator it = m_roster.find(remoteSessionPrefix);
+    auto it = m_sessionTimeouts.find(remoteSessionPrefix);
 
-    if (it != m_roster.end()) {
+    if (it != m_sessionTimeouts.end()) {
       // cancel timeout event
-      if (it->second.timeoutEventId)
-        it->second.timeoutEventId.cancel();
+      m_sessionTimeouts.erase(it);
+      m_verifiedKeys.erase(remoteSessionPrefix);
 
-      // notify frontend to remove the remote session (node)
+      // notify frontend to print the leave message
       emit sessionRemoved(QString::fromStdString(remoteSessionPrefix.toUri()),
                           QString::fromStdString(msg.getNick()),
                           msg.getTimestamp());
 
-      // remove roster entry
-      m_roster.erase(remoteSessionPrefix);
-
-      emit eraseInRoster(remoteSessionPrefix.getPrefix(IDENTITY_OFFSET),
-                         Name::Component(m_chatroomName));
+      // remove roster entry, the roster notifies the frontend and discovery
+      m_roster.removeSession(remoteSessionPrefix);
     }
   }
   else {
-    BackendRoster::iterator it = m_roster.find(remoteSessionPrefix);
+    auto it = m_sessionTimeouts.find(remoteSessionPrefix);
 
-    if (it == m_roster.end()) {
+    if (it == m_sessionTimeouts.end()) {
       // Should not happen
       BOOST_ASSERT(false);
     }
@@ -257,7 +371,7 @@ ChatDialogBackend::processChatData(const ndn::Data& data, bool needDisplay, bool
     uint64_t seqNo = data.getName().get(-1).toNumber();
 
     // (Re)schedule another timeout event after 3 HELLO_INTERVAL;
-    it->second.timeoutEventId =
+    m_sessionTimeouts[remoteSessionPrefix] =
       m_scheduler->schedule(HELLO_INTERVAL * 3,
                             bind(&ChatDialogBackend::remoteSessionTimeout,
                                  this, remoteSessionPrefix));
@@ -277,18 +391,14 @@ ChatDialogBackend::processChatData(const ndn::Data& data, bool needDisplay, bool
     // Notify frontend to plot notification on DigestTree.
 
     // If we haven't got any message from this session yet.
-    if (m_roster[remoteSessionPrefix].hasNick == false) {
-      m_roster[remoteSessionPrefix].userNick = msg.getNick();
-      m_roster[remoteSessionPrefix].hasNick = true;
-
+    if (!m_roster.hasSession(remoteSessionPrefix)) {
       emit messageReceived(QString::fromStdString(remoteSessionPrefix.toUri()),
                            QString::fromStdString(msg.getNick()),
                            seqNo,
                            msg.getTimestamp(),
                            true);
 
-      emit addInRoster(remoteSessionPrefix.getPrefix(IDENTITY_OFFSET),
-                       Name::Component(m_chatroomName));
+      m_roster.addSession(remoteSessionPrefix, msg.getNick());
     }
     else
       emit messageReceived(QString::fromStdString(remoteSessionPrefix.toUri()),
@@ -307,14 +417,13 @@ ChatDialogBackend::remoteSessionTimeout(const Name& sessionPrefix)
 
   // notify frontend
   emit sessionRemoved(QString::fromStdString(sessionPrefix.toUri()),
-                      QString::fromStdString(m_roster[sessionPrefix].userNick),
+                      QString::fromStdString(m_roster.getNick(sessionPrefix)),
                       timestamp);
 
   // remove roster entry
-  m_roster.erase(sessionPrefix);
-
-  emit eraseInRoster(sessionPrefix.getPrefix(IDENTITY_OFFSET),
-                     Name::Component(m_chatroomName));
+  m_sessionTimeouts.erase(sessionPrefix);
+  m_verifiedKeys.erase(sessionPrefix);
+  m_roster.removeSession(sessionPrefix);
 }
 
 void
@@ -325,7 +434,12 @@ ChatDialogBackend::sendMsg(ChatMessage& msg)
 
   uint64_t nextSequence = m_sock->getLogic().getSeqNo() + 1;
 
-  m_sock->publishData(buf.wire(), buf.size(), FRESHNESS_PERIOD);
+  shared_ptr<const GroupKey> groupKey = getGroupKey();
+  if (groupKey != nullptr &&
+      (msg.getMsgType() == ChatMessage::CHAT || msg.getMsgType() == ChatMessage::HELLO))
+    publishWithGroupKey(buf, *groupKey);
+  else
+    m_sock->publishData(buf.wire(), buf.size(), FRESHNESS_PERIOD);
 
   std::vector<NodeInfo> nodeInfos;
   Name sessionName = m_sock->getLogic().getSessionName();
@@ -343,6 +457,39 @@ ChatDialogBackend::sendMsg(ChatMessage& msg)
                        msg.getMsgType() == ChatMessage::JOIN);
 }
 
+void
+ChatDialogBackend::publishWithGroupKey(const Block& content, const GroupKey& groupKey)
+{
+  chronosync::SeqNo seqNo = m_sock->getLogic().getSeqNo() + 1;
+  Name dataName = m_sock->getLogic().getSessionName();
+  dataName.appendNumber(seqNo);
+
+  Data data(dataName);
+  data.setContent(content.wire(), content.size());
+  data.setFreshnessPeriod(FRESHNESS_PERIOD);
+  groupKey.sign(data);
+
+  {
+    std::lock_guard<std::mutex> lock(m_groupKeyMutex);
+    if (m_groupKeySignedData != nullptr)
+      m_groupKeySignedData->insert(data);
+  }
+  m_sock->getLogic().updateSeqNo(seqNo);
+}
+
+void
+ChatDialogBackend::onChatDataInterest(const Interest& interest)
+{
+  shared_ptr<const Data> data;
+  {
+    std::lock_guard<std::mutex> lock(m_groupKeyMutex);
+    if (m_groupKeySignedData != nullptr)
+      data = m_groupKeySignedData->find(interest);
+  }
+  if (data != nullptr)
+    m_face->put(*data);
+}
+
 void
 ChatDialogBackend::sendJoin()
 {
@@ -352,6 +499,8 @@ ChatDialogBackend::sendJoin()
   prepareControlMessage(msg, ChatMessage::JOIN);
   sendMsg(msg);
 
+  m_roster.addSession(m_sock->getLogic().getSessionName(), m_nick, true);
+
   m_helloEventId = m_scheduler->schedule(HELLO_INTERVAL,
                                          bind(&ChatDialogBackend::sendHello, this));
   emit newChatroomForDiscovery(Name::Component(m_chatroomName));
@@ -375,9 +524,8 @@ ChatDialogBackend::sendLeave()
   prepareControlMessage(msg, ChatMessage::LEAVE);
   sendMsg(msg);
 
-  // get my own identity with routable prefix by getPrefix(-2)
-  emit eraseInRoster(m_routableUserChatPrefix.getPrefix(-2),
-                     Name::Component(m_chatroomName));
+  // remove my own session, the roster notifies discovery
+  m_roster.removeSession(m_sock->getLogic().getSessionName());
 
   usleep(5000);
   m_joined = false;
@@ -471,6 +619,7 @@ ChatDialogBackend::shutdown()
     std::lock_guard<std::mutex>lock(m_nfdConnectionMutex);
     m_isNfdConnected = true;
   }
+  m_nfdConnectionCondition.notify_all();
 
   exitChatroom();
 
@@ -480,8 +629,11 @@ ChatDialogBackend::shutdown()
 void
 ChatDialogBackend::onNfdReconnect()
 {
-  std::lock_guard<std::mutex>lock(m_nfdConnectionMutex);
-  m_isNfdConnected = true;
+  {
+    std::lock_guard<std::mutex>lock(m_nfdConnectionMutex);
+    m_isNfdConnected = true;
+  }
+  m_nfdConnectionCondition.notify_all();
 }
 
 } // namespace chronochat
@@ -17,10 +17,16 @@
 #include "common.hpp"
 #include "chatroom-info.hpp"
 #include "chat-message.hpp"
+#include "batch-validator.hpp"
+#include "chatroom-roster.hpp"
+#include "group-key.hpp"
+#include "verified-key-cache.hpp"
+#include <condition_variable>
 #include <mutex>
 #include <ChronoSync/socket.hpp>
 #include <boost/thread.hpp>
-#include <ndn-cxx/security/validator-config.hpp>
+#include <ndn-cxx/ims/in-memory-storage-persistent.hpp>
+#include <ndn-cxx/security/validator.hpp>
 #endif
 
 namespace chronochat {
@@ -32,15 +38,6 @@ public:
   chronosync::SeqNo seqNo;
 };
 
-class UserInfo
-{
-public:
-  ndn::Name sessionPrefix;
-  bool hasNick;
-  std::string userNick;
-  ndn::scheduler::ScopedEventId timeoutEventId;
-};
-
 class ChatDialogBackend : public QThread
 {
   Q_OBJECT
@@ -56,23 +53,70 @@ public:
 
   ~ChatDialogBackend();
 
+  ChatroomRoster*
+  getRoster()
+  {
+    return &m_roster;
+  }
+
+  /**
+   * @brief set the group key of the chatroom
+   *
+   * The chat messages and HELLOs are then signed with the key, the JOINs and LEAVEs keep the
+   * signature of the identity. The chat data signed with the key are validated against it.
+   */
+  void
+  setGroupKey(shared_ptr<const GroupKey> key);
+
+  shared_ptr<const GroupKey>
+  getGroupKey() const;
+
 protected:
   void
   run();
 
-private:
+  /**
+   * @brief create the face of a new session of the backend
+   *
+   * The tests run the backend without its thread, on a face of their own.
+   */
+  virtual shared_ptr<ndn::Face>
+  makeFace();
+
   void
   initializeSync();
 
   void
-  exitChatroom();
+  close();
 
+private:
   void
-  close();
+  exitChatroom();
 
   void
   processSyncUpdate(const std::vector<chronosync::MissingDataInfo>& updates);
 
+  class CatchUp;
+
+  /**
+   * @brief fetch the missing chat data together, then validate them as a batch
+   */
+  void
+  fetchCatchUp(const std::vector<std::pair<Name, chronosync::SeqNo>>& missing);
+
+  void
+  fetchCatchUpData(const shared_ptr<CatchUp>& catchUp, size_t index, const Interest& interest,
+                   int nRetries);
+
+  void
+  onCatchUpDataFetched(const shared_ptr<CatchUp>& catchUp);
+
+  /**
+   * @brief remember the key of the session of @p data, then process it
+   */
+  void
+  onChatDataValidated(const ndn::Data& data);
+
   void
   processChatData(const ndn::Data& data,
                   bool needDisplay,
@@ -84,6 +128,18 @@ private:
   void
   sendMsg(ChatMessage& msg);
 
+  /**
+   * @brief publish the next chat data of the session, signed with @p groupKey
+   *
+   * The socket signs what it publishes with the identity, so the data is served from its own
+   * storage instead.
+   */
+  void
+  publishWithGroupKey(const Block& content, const GroupKey& groupKey);
+
+  void
+  onChatDataInterest(const Interest& interest);
+
   void
   sendJoin();
 
@@ -125,12 +181,6 @@ signals:
   void
   refreshChatDialog(ndn::Name chatPrefix);
 
-  void
-  eraseInRoster(ndn::Name sessionPrefix, ndn::Name::Component chatroomName);
-
-  void
-  addInRoster(ndn::Name sessionPrefix, ndn::Name::Component chatroomName);
-
   void
   newChatroomForDiscovery(ndn::Name::Component chatroomName);
 
@@ -151,7 +201,7 @@ public slots:
   onNfdReconnect();
 
 private:
-  typedef std::map<ndn::Name, UserInfo> BackendRoster;
+  typedef std::map<ndn::Name, ndn::scheduler::ScopedEventId> SessionTimeouts;
 
   bool m_shouldResume;
   bool m_isNfdConnected;
@@ -166,18 +216,28 @@ private:
   std::string m_nick;                                           // user nick
 
   Name m_signingId;                                             // signing identity
-  shared_ptr<ndn::security::ValidatorConfig> m_validator;       // validator
+  shared_ptr<ndn::security::Validator> m_validator;             // validator
+  VerifiedKeyCache m_verifiedKeys;                              // keys of remote sessions
+  unique_ptr<BatchValidator> m_batchValidator;                  // validator of catch-ups
   shared_ptr<chronosync::Socket> m_sock;                        // SyncSocket
 
+  shared_ptr<const GroupKey> m_groupKey;                        // group key of the chatroom
+  // the chat data signed with the group key, which the socket does not serve
+  unique_ptr<ndn::InMemoryStoragePersistent> m_groupKeySignedData;
+  ndn::ScopedInterestFilterHandle m_groupKeySignedDataFilter;
+
   unique_ptr<ndn::Scheduler> m_scheduler;                       // scheduler
   ndn::scheduler::EventId m_helloEventId;                       // event id of timeout
 
   bool m_joined;                                                // true if in a chatroom
 
-  BackendRoster m_roster;                                       // User roster
+  ChatroomRoster m_roster;                                      // User roster
+  SessionTimeouts m_sessionTimeouts;                            // Remote session timeouts
 
   std::mutex m_resumeMutex;
   std::mutex m_nfdConnectionMutex;
+  std::condition_variable m_nfdConnectionCondition;
+  mutable std::mutex m_groupKeyMutex;
 };
 
 } // namespace chronochat
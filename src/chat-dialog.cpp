@@ -105,6 +105,12 @@ ChatDialog::ChatDialog(const Name& chatroomPrefix,
   connect(&m_backend, SIGNAL(refreshChatDialog(ndn::Name)),
           this,       SLOT(updateLabels(ndn::Name)));
 
+  // When the roster changes, update the roster list and the sync tree.
+  connect(m_backend.getRoster(), SIGNAL(sessionAdded(ndn::Name, QString)),
+          this,                  SLOT(onRosterSessionAdded(ndn::Name, QString)));
+  connect(m_backend.getRoster(), SIGNAL(sessionRemoved(ndn::Name)),
+          this,                  SLOT(onRosterSessionRemoved(ndn::Name)));
+
   // When frontend gets a message to send, notify backend.
   connect(this,       SIGNAL(msgToSent(QString, time_t)),
           &m_backend, SLOT(sendChatMessage(QString, time_t)));
@@ -121,6 +127,10 @@ ChatDialog::ChatDialog(const Name& chatroomPrefix,
           this, SLOT(onSyncTreeButtonPressed()));
   connect(ui->trustTreeButton, SIGNAL(pressed()),
           this, SLOT(onTrustTreeButtonPressed()));
+  connect(ui->inviteButton, SIGNAL(clicked()),
+          this, SLOT(onInviteButtonClicked()));
+  // any member may invite, the invitees of a secured chatroom are also granted its group key
+  ui->inviteButton->setEnabled(true);
 
   disableSyncTreeDisplay();
   QTimer::singleShot(2200, this, SLOT(enableSyncTreeDisplay()));
@@ -178,12 +188,8 @@ ChatDialog::getChatroomInfo()
 {
   ChatroomInfo chatroomInfo;
   chatroomInfo.setName(Name::Component(m_chatroomName));
-  QStringList prefixList = m_scene->getRosterPrefixList();
-  for(QStringList::iterator it = prefixList.begin();
-      it != prefixList.end(); ++it ) {
-    Name participant = Name(it->toStdString()).getPrefix(-3);
+  for (const Name& participant : m_backend.getRoster()->getParticipants())
     chatroomInfo.addParticipant(participant);
-  }
 
   chatroomInfo.setSyncPrefix(m_chatroomPrefix);
   if (m_isSecured)
@@ -339,9 +345,6 @@ void
 ChatDialog::removeSession(QString sessionPrefix, QString nick, time_t timestamp)
 {
   appendControlMessage(nick, "leaves room", timestamp);
-  m_scene->removeNode(sessionPrefix);
-  m_rosterModel->setStringList(m_scene->getRosterList());
-  fitView();
 }
 
 void
@@ -350,10 +353,8 @@ ChatDialog::receiveMessage(QString sessionPrefix, QString nick, uint64_t seqNo,
 {
   m_scene->updateNode(sessionPrefix, nick, seqNo);
   m_scene->messageReceived(sessionPrefix);
-  if (addSession) {
+  if (addSession)
     appendControlMessage(nick, "enters room", timestamp);
-    m_rosterModel->setStringList(m_scene->getRosterList());
-  }
   fitView();
 }
 
@@ -389,6 +390,26 @@ ChatDialog::updateLabels(Name newChatPrefix)
   fitView();
 }
 
+void
+ChatDialog::onRosterSessionAdded(Name sessionPrefix, QString nick)
+{
+  m_rosterModel->setStringList(m_backend.getRoster()->getNickList());
+}
+
+void
+ChatDialog::onRosterSessionRemoved(Name sessionPrefix)
+{
+  m_scene->removeNode(QString::fromStdString(sessionPrefix.toUri()));
+  m_rosterModel->setStringList(m_backend.getRoster()->getNickList());
+  fitView();
+}
+
+void
+ChatDialog::onInviteButtonClicked()
+{
+  emit inviteRequested(QString::fromStdString(m_chatroomName));
+}
+
 void
 ChatDialog::onReturnPressed()
 {
@@ -117,6 +117,9 @@ signals:
   void
   resetIcon();
 
+  void
+  inviteRequested(const QString& chatroomName);
+
 public slots:
   void
   onShow();
@@ -141,9 +144,18 @@ private slots:
   void
   updateLabels(ndn::Name newChatPrefix);
 
+  void
+  onRosterSessionAdded(ndn::Name sessionPrefix, QString nick);
+
+  void
+  onRosterSessionRemoved(ndn::Name sessionPrefix);
+
   void
   onReturnPressed();
 
+  void
+  onInviteButtonClicked();
+
   void
   onSyncTreeButtonPressed();
 
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "chatroom-credentials.hpp"
+
+#include <ndn-cxx/security/signing-helpers.hpp>
+
+namespace chronochat {
+
+ChatroomCredentials::ChatroomCredentials(ndn::KeyChain& keyChain)
+  : m_keyChain(keyChain)
+{
+}
+
+shared_ptr<const ChatroomCredentials::Credential>
+ChatroomCredentials::get(const std::string& chatroom, const Name& identity)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_credentials.find(chatroom);
+  if (it != m_credentials.end() && it->second->identity == identity)
+    return it->second;
+
+  // the chatrooms of an identity share its certificate
+  shared_ptr<const Credential> credential;
+  for (const auto& entry : m_credentials) {
+    if (entry.second->identity == identity) {
+      credential = entry.second;
+      break;
+    }
+  }
+
+  if (credential == nullptr) {
+    auto created = std::make_shared<Credential>();
+    created->identity = identity;
+    created->certificate = loadCertificate(identity);
+    created->certificateWire = created->certificate.wireEncode();
+    created->signingInfo = ndn::security::signingByCertificate(created->certificate);
+    credential = created;
+  }
+
+  m_credentials[chatroom] = credential;
+  return credential;
+}
+
+void
+ChatroomCredentials::erase(const std::string& chatroom)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_credentials.erase(chatroom);
+}
+
+void
+ChatroomCredentials::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_credentials.clear();
+}
+
+size_t
+ChatroomCredentials::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_credentials.size();
+}
+
+ndn::security::Certificate
+ChatroomCredentials::loadCertificate(const Name& identity)
+{
+  try {
+    return m_keyChain.getPib().getIdentity(identity).getDefaultKey().getDefaultCertificate();
+  }
+  catch (const ndn::security::Pib::Error&) {
+    return m_keyChain.createIdentity(identity).getDefaultKey().getDefaultCertificate();
+  }
+}
+
+} // namespace chronochat
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_CHATROOM_CREDENTIALS_HPP
+#define CHRONOCHAT_CHATROOM_CREDENTIALS_HPP
+
+#include "common.hpp"
+
+#include <mutex>
+#include <ndn-cxx/security/key-chain.hpp>
+
+namespace chronochat {
+
+/**
+ * @brief the certificate each chatroom is joined with, and how to sign with it
+ *
+ * A credential is created or loaded from the PIB once, with its certificate already encoded
+ * and its signing info resolved, so that answering a burst of invitations costs one signature
+ * per answer and no PIB or TPM lookup. For now the certificate of a chatroom is the default
+ * certificate of the identity, shared by all the chatrooms of the identity.
+ *
+ * The credentials are safe to use from several threads.
+ */
+class ChatroomCredentials
+{
+public:
+  class Credential
+  {
+  public:
+    Name identity;
+    ndn::security::Certificate certificate;
+    Block certificateWire;
+    ndn::security::SigningInfo signingInfo;
+  };
+
+  explicit
+  ChatroomCredentials(ndn::KeyChain& keyChain);
+
+  /**
+   * @brief get the credential of @p identity in @p chatroom, created at the first call
+   */
+  shared_ptr<const Credential>
+  get(const std::string& chatroom, const Name& identity);
+
+  void
+  erase(const std::string& chatroom);
+
+  void
+  clear();
+
+  size_t
+  size() const;
+
+private:
+  /**
+   * @brief get the default certificate of @p identity, which is created if it does not exist
+   */
+  ndn::security::Certificate
+  loadCertificate(const Name& identity);
+
+private:
+  ndn::KeyChain& m_keyChain;
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, shared_ptr<const Credential>> m_credentials;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_CHATROOM_CREDENTIALS_HPP
@@ -9,19 +9,35 @@
  */
 
 #include "chatroom-discovery-backend.hpp"
+#include "manager-election.hpp"
 
 #include <QStringList>
 
+#ifndef Q_MOC_RUN
+#include <boost/filesystem.hpp>
+#endif
+
 namespace chronochat {
 
 static const time::milliseconds FRESHNESS_PERIOD(60000);
-static const time::seconds REFRESH_INTERVAL(60);
 static const time::seconds HELLO_INTERVAL(60);
+// chatrooms that the user is not in expire in buckets advanced every EXPIRY_TICK
+static const time::seconds EXPIRY_TICK(10);
+static const size_t REMOTE_EXPIRY_TICKS = HELLO_INTERVAL * 5 / EXPIRY_TICK + 1;
+static const size_t EXPIRY_BUCKETS = REMOTE_EXPIRY_TICKS + 1;
+// delay to coalesce the chatroom list changes pushed to the discovery panel
+static const time::milliseconds LIST_CHANGES_DELAY(200);
+// the discovery cache is saved periodically and when the backend stops
+static const time::minutes CACHE_SAVE_INTERVAL(5);
+static const time::hours CACHE_MAX_AGE(24);
 static const Name::Component ROUTING_HINT_SEPARATOR = Name::Component::fromEscapedString("%F0%2E");
 // a count enforced when a manager himself find another one publish chatroom data
 static const int MAXIMUM_COUNT = 3;
 static const int IDENTITY_OFFSET = -1;
-static const int CONNECTION_RETRY_TIMER = 3;
+// data name := routable identity/CHRONOCHAT-DISCOVERYDATA/<chatroom>/<session>/<seq>
+static const int PUBLISHER_OFFSET = -4;
+// the manager publishes a full snapshot after this many deltas
+static const int SNAPSHOT_INTERVAL = 5;
 
 ChatroomDiscoveryBackend::ChatroomDiscoveryBackend(const Name& routingPrefix,
                                                    const Name& identity,
@@ -30,8 +46,10 @@ ChatroomDiscoveryBackend::ChatroomDiscoveryBackend(const Name& routingPrefix,
   , m_shouldResume(false)
   , m_routingPrefix(routingPrefix)
   , m_identity(identity)
-  , m_randomGenerator(static_cast<unsigned int>(std::time(0)))
-  , m_rangeUniformRandom(m_randomGenerator, boost::uniform_int<>(500,2000))
+  , m_chatroomList(EXPIRY_BUCKETS)
+  , m_discoveryCache((boost::filesystem::path(getenv("HOME")) / ".chronos" /
+                      "discovery-cache").string(),
+                     CACHE_MAX_AGE)
 {
   m_discoveryPrefix.append("ndn")
     .append("broadcast")
@@ -68,17 +86,10 @@ ChatroomDiscoveryBackend::run()
         std::lock_guard<std::mutex>lock(m_resumeMutex);
         m_shouldResume = true;
       }
-#ifdef BOOST_THREAD_USES_CHRONO
-      time::seconds reconnectTimer = time::seconds(CONNECTION_RETRY_TIMER);
-#else
-      boost::posix_time::time_duration reconnectTimer = boost::posix_time::seconds(CONNECTION_RETRY_TIMER);
-#endif
-      while (!m_isNfdConnected) {
-#ifdef BOOST_THREAD_USES_CHRONO
-        boost::this_thread::sleep_for(reconnectTimer);
-#else
-        boost::this_thread::sleep(reconnectTimer);
-#endif
+      {
+        // woken up by onNfdReconnect, as soon as the forwarder is back
+        std::unique_lock<std::mutex> lock(m_nfdConnectionMutex);
+        m_nfdConnectionCondition.wait(lock, [this] { return m_isNfdConnected; });
       }
     }
     {
@@ -91,12 +102,18 @@ ChatroomDiscoveryBackend::run()
   } while (shouldResume);
 }
 
+shared_ptr<ndn::Face>
+ChatroomDiscoveryBackend::makeFace()
+{
+  return std::make_shared<ndn::Face>();
+}
+
 void
 ChatroomDiscoveryBackend::initializeSync()
 {
   BOOST_ASSERT(m_sock == nullptr);
 
-  m_face = shared_ptr<ndn::Face>(new ndn::Face);
+  m_face = makeFace();
   m_scheduler = unique_ptr<ndn::Scheduler>(new ndn::Scheduler(m_face->getIoService()));
 
   m_sock = std::make_shared<chronosync::Socket>(m_discoveryPrefix,
@@ -105,17 +122,68 @@ ChatroomDiscoveryBackend::initializeSync()
                                                 bind(&ChatroomDiscoveryBackend::processSyncUpdate,
                                                      this, _1));
 
-  // add an timer to refresh front end
-  m_refreshPanelId = m_scheduler->schedule(REFRESH_INTERVAL,
-                                           [this] { sendChatroomList(); });
+  // add an timer to expire the chatrooms that are no longer announced
+  m_expiryTickId = m_scheduler->schedule(EXPIRY_TICK, [this] { onExpiryTick(); });
+
+  // show the chatrooms known from the last run until the network refreshes them
+  loadDiscoveryCache();
+  scheduleDiscoveryCacheSave();
 }
 
 void
 ChatroomDiscoveryBackend::close()
 {
+  saveDiscoveryCache();
+
   m_scheduler->cancelAllEvents();
   m_chatroomList.clear();
   m_sock.reset();
+
+  emit chatroomListReady(QStringList());
+}
+
+void
+ChatroomDiscoveryBackend::loadDiscoveryCache()
+{
+  for (const auto& entry : m_discoveryCache.load()) {
+    const Name::Component& chatroomName = entry.info.getName();
+    if (m_chatroomList.find(chatroomName) != m_chatroomList.end())
+      continue;
+
+    ChatroomInfoBackend& chatroom = m_chatroomList.get(chatroomName);
+    chatroom.info = entry.info;
+    chatroom.lastUpdate = entry.timestamp;
+    chatroom.isStale = true;
+    // a cached chatroom that is not announced any more goes away like any other
+    m_chatroomList.setExpiry(m_chatroomList.find(chatroomName), REMOTE_EXPIRY_TICKS);
+  }
+
+  sendChatroomListChanges();
+}
+
+void
+ChatroomDiscoveryBackend::saveDiscoveryCache()
+{
+  std::vector<DiscoveryCache::Entry> entries;
+  for (const auto& chatroom : m_chatroomList) {
+    // the user's own chatrooms are announced again by the chat dialogs
+    if (chatroom.second.isParticipant || chatroom.second.isManager ||
+        chatroom.second.info.getParticipants().empty())
+      continue;
+
+    entries.push_back({chatroom.second.info, chatroom.second.lastUpdate});
+  }
+
+  m_discoveryCache.save(entries);
+}
+
+void
+ChatroomDiscoveryBackend::scheduleDiscoveryCacheSave()
+{
+  m_cacheSaveId = m_scheduler->schedule(CACHE_SAVE_INTERVAL, [this] {
+    saveDiscoveryCache();
+    scheduleDiscoveryCacheSave();
+  });
 }
 
 void
@@ -137,12 +205,9 @@ ChatroomDiscoveryBackend::processChatroomData(const ndn::Data& data)
   Name::Component chatroomName = data.getName().get(-3);
   auto it = m_chatroomList.find(chatroomName);
   if (it == m_chatroomList.end()) {
-    m_chatroomList[chatroomName].chatroomName = chatroomName.toUri();
-    m_chatroomList[chatroomName].count = 0;
-    m_chatroomList[chatroomName].isPrint = false;
-    m_chatroomList[chatroomName].isParticipant = false;
-    m_chatroomList[chatroomName].isManager = false;
+    m_chatroomList.get(chatroomName);
     it = m_chatroomList.find(chatroomName);
+    scheduleChatroomListChanges();
   }
   // If the user is the manager of this chatroom, he should not receive any data from this chatroom
   if (it->second.isManager) {
@@ -171,6 +236,11 @@ ChatroomDiscoveryBackend::processChatroomData(const ndn::Data& data)
     if (it->second.localChatroomTimeoutEventId)
       it->second.localChatroomTimeoutEventId.cancel();
 
+    // Remember the manager, it is left out when the participants elect a new one
+    Name manager = data.getName().getPrefix(PUBLISHER_OFFSET);
+    if (it->second.info.getManagerPrefix() != manager)
+      it->second.info.setManager(manager);
+
     // If a user start a random timer it means that he think his own chatroom is not alive
     // But when he receive some packet, it means that this chatroom is alive, so he can
     // cancel the timer
@@ -184,46 +254,113 @@ ChatroomDiscoveryBackend::processChatroomData(const ndn::Data& data)
   }
   else {
     if (data.hasContent()) {
-      ChatroomInfo chatroom;
-      chatroom.wireDecode(data.getContent().blockFromValue());
-      it->second.info = chatroom;
+      Name session = data.getName().getPrefix(-1);
+      chronosync::SeqNo seqNo = data.getName().get(-1).toNumber();
+      try {
+        Block content = data.getContent().blockFromValue();
+        if (content.type() == tlv::ChatroomInfoDelta) {
+          ChatroomInfoDelta delta(content);
+          if (!applyChatroomInfoDelta(it->second, session, seqNo, delta)) {
+            // we missed the snapshot the delta is based on, fetch it and apply the delta again
+            m_sock->fetchData(session, delta.getBaseVersion(),
+                              [this, chatroomName, session, seqNo, delta] (const ndn::Data& base) {
+                                processChatroomData(base);
+                                auto chatroom = m_chatroomList.find(chatroomName);
+                                if (chatroom != m_chatroomList.end() &&
+                                    !chatroom->second.isParticipant &&
+                                    !chatroom->second.isManager)
+                                  applyChatroomInfoDelta(chatroom->second, session, seqNo, delta);
+                              }, 2);
+          }
+        }
+        else {
+          applyChatroomInfoSnapshot(it->second, session, seqNo, ChatroomInfo(content));
+        }
+      }
+      catch (const ndn::tlv::Error&) {
+        return;
+      }
+      catch (const ChatroomInfo::Error&) {
+        return;
+      }
+      catch (const ChatroomInfoDelta::Error&) {
+        return;
+      }
     }
 
-    if (it->second.remoteChatroomTimeoutEventId)
-      it->second.remoteChatroomTimeoutEventId.cancel();
+    m_chatroomList.setExpiry(it, REMOTE_EXPIRY_TICKS);
+  }
+}
 
-    it->second.remoteChatroomTimeoutEventId =
-      m_scheduler->schedule(HELLO_INTERVAL * 5,
-                            bind(&ChatroomDiscoveryBackend::remoteSessionTimeout,
-                                 this, chatroomName));
+void
+ChatroomDiscoveryBackend::applyChatroomInfoSnapshot(ChatroomInfoBackend& chatroom,
+                                                    const Name& session,
+                                                    chronosync::SeqNo seqNo,
+                                                    const ChatroomInfo& info)
+{
+  if (chatroom.snapshotSession == session) {
+    // a snapshot fetched to fill a gap may arrive after newer ones
+    if (seqNo <= chatroom.snapshotSeqNo)
+      return;
   }
-  // if this is a chatroom that haven't been print on the discovery panel, print it.
-  if(!it->second.isPrint) {
-    sendChatroomList();
-    it->second.isPrint = true;
+  else {
+    // the chatroom has a new manager
+    chatroom.snapshotSession = session;
+    chatroom.infoSeqNo = 0;
+  }
+
+  chatroom.snapshot = info;
+  chatroom.snapshotSeqNo = seqNo;
+  if (seqNo > chatroom.infoSeqNo) {
+    chatroom.info = info;
+    chatroom.infoSeqNo = seqNo;
+    chatroom.lastUpdate = time::system_clock::now();
+    chatroom.isStale = false;
   }
 }
 
+bool
+ChatroomDiscoveryBackend::applyChatroomInfoDelta(ChatroomInfoBackend& chatroom,
+                                                 const Name& session,
+                                                 chronosync::SeqNo seqNo,
+                                                 const ChatroomInfoDelta& delta)
+{
+  if (chatroom.snapshotSession != session || chatroom.snapshotSeqNo != delta.getBaseVersion())
+    return false;
+
+  if (seqNo > chatroom.infoSeqNo) {
+    chatroom.info = chatroom.snapshot;
+    delta.apply(chatroom.info);
+    chatroom.infoSeqNo = seqNo;
+    chatroom.lastUpdate = time::system_clock::now();
+    chatroom.isStale = false;
+  }
+  return true;
+}
+
 void
 ChatroomDiscoveryBackend::localSessionTimeout(const Name::Component& chatroomName)
 {
   auto it = m_chatroomList.find(chatroomName);
   if (it == m_chatroomList.end() || it->second.isParticipant == false)
     return;
+
+  // Every participant ranks the same candidates, the first one takes over and the others
+  // back off by their rank, cancelling when they receive data from the new manager
+  Name self = m_routableUserDiscoveryPrefix.getPrefix(IDENTITY_OFFSET);
+  std::list<Name> candidates = it->second.info.getParticipants();
+  candidates.remove(it->second.info.getManagerPrefix());
+  candidates.push_back(self);
+
+  ManagerElection election(chatroomName, candidates);
   it->second.managerSelectionTimeoutEventId =
-    m_scheduler->schedule(time::milliseconds(m_rangeUniformRandom()),
-                          bind(&ChatroomDiscoveryBackend::randomSessionTimeout,
+    m_scheduler->schedule(election.getBackoff(self),
+                          bind(&ChatroomDiscoveryBackend::managerSelectionTimeout,
                                this, chatroomName));
 }
 
 void
-ChatroomDiscoveryBackend::remoteSessionTimeout(const Name::Component& chatroomName)
-{
-  m_chatroomList.erase(chatroomName);
-}
-
-void
-ChatroomDiscoveryBackend::randomSessionTimeout(const Name::Component& chatroomName)
+ChatroomDiscoveryBackend::managerSelectionTimeout(const Name::Component& chatroomName)
 {
   Name prefix = m_routableUserDiscoveryPrefix;
   prefix.append(chatroomName);
@@ -237,18 +374,42 @@ ChatroomDiscoveryBackend::sendUpdate(const Name::Component& chatroomName)
 {
   auto it = m_chatroomList.find(chatroomName);
   if (it != m_chatroomList.end() && it->second.isManager) {
-    ndn::Block buf = it->second.info.wireEncode();
+    ChatroomInfoBackend& chatroom = it->second;
+    Name session = m_sock->getLogic().getSessionName(chatroom.chatroomPrefix);
+    const ChatroomInfo& info = chatroom.info;
+
+    // Deltas only carry participant changes, anything else requires a new snapshot
+    bool isSnapshot = chatroom.snapshotSession != session ||
+                      chatroom.deltaCount >= SNAPSHOT_INTERVAL ||
+                      chatroom.snapshot.getTrustModel() != info.getTrustModel() ||
+                      chatroom.snapshot.getSyncPrefix() != info.getSyncPrefix() ||
+                      chatroom.snapshot.getManagerPrefix() != info.getManagerPrefix();
+
+    ChatroomInfoDelta delta;
+    if (!isSnapshot) {
+      delta.setName(chatroomName);
+      delta.setBaseVersion(chatroom.snapshotSeqNo);
+      delta.setParticipants(chatroom.snapshot.getParticipants(), info.getParticipants());
+      // a delta touching most of the roster is no cheaper than a snapshot
+      isSnapshot = delta.size() * 2 > info.getParticipants().size();
+    }
 
-    m_sock->publishData(buf.wire(), buf.size(), FRESHNESS_PERIOD, it->second.chatroomPrefix);
+    ndn::Block buf = isSnapshot ? info.wireEncode() : delta.wireEncode();
+    m_sock->publishData(buf.wire(), buf.size(), FRESHNESS_PERIOD, chatroom.chatroomPrefix);
+
+    if (isSnapshot) {
+      chatroom.snapshot = info;
+      chatroom.snapshotSession = session;
+      chatroom.snapshotSeqNo = m_sock->getLogic().getSeqNo(chatroom.chatroomPrefix);
+      chatroom.deltaCount = 0;
+    }
+    else {
+      chatroom.deltaCount++;
+    }
 
     it->second.helloTimeoutEventId =
       m_scheduler->schedule(HELLO_INTERVAL,
                             bind(&ChatroomDiscoveryBackend::sendUpdate, this, chatroomName));
-    // if this is a chatroom that haven't been print on the discovery panel, print it.
-    if(!it->second.isPrint) {
-      sendChatroomList();
-      it->second.isPrint = true;
-    }
   }
 }
 
@@ -308,14 +469,13 @@ ChatroomDiscoveryBackend::onEraseInRoster(ndn::Name sessionPrefix,
       Name prefix = sessionPrefix;
       prefix.append("CHRONOCHAT-DISCOVERYDATA").append(chatroomName);
       m_sock->removeSyncNode(prefix);
-      sendChatroomList();
+      scheduleChatroomListChanges();
       return;
     }
 
     if (sessionPrefix.isPrefixOf(m_routableUserDiscoveryPrefix)) {
       it->second.isParticipant = false;
       it->second.isManager = false;
-      it->second.isPrint = false;
       it->second.count = 0;
       if (it->second.helloTimeoutEventId)
         it->second.helloTimeoutEventId.cancel();
@@ -323,10 +483,7 @@ ChatroomDiscoveryBackend::onEraseInRoster(ndn::Name sessionPrefix,
       if (it->second.localChatroomTimeoutEventId)
         it->second.localChatroomTimeoutEventId.cancel();
 
-      it->second.remoteChatroomTimeoutEventId =
-      m_scheduler->schedule(HELLO_INTERVAL * 5,
-                            bind(&ChatroomDiscoveryBackend::remoteSessionTimeout,
-                                 this, chatroomName));
+      m_chatroomList.setExpiry(it, REMOTE_EXPIRY_TICKS);
     }
 
     if (it->second.isManager) {
@@ -357,13 +514,12 @@ ChatroomDiscoveryBackend::onNewChatroomForDiscovery(ndn::Name::Component chatroo
   newPrefix.append(chatroomName);
   auto it = m_chatroomList.find(chatroomName);
   if (it == m_chatroomList.end()) {
-    m_chatroomList[chatroomName].chatroomPrefix = newPrefix;
-    m_chatroomList[chatroomName].isParticipant = true;
-    m_chatroomList[chatroomName].isManager = false;
-    m_chatroomList[chatroomName].count = 0;
-    m_chatroomList[chatroomName].isPrint = false;
+    ChatroomInfoBackend& chatroom = m_chatroomList.get(chatroomName);
+    chatroom.chatroomPrefix = newPrefix;
+    chatroom.isParticipant = true;
+    scheduleChatroomListChanges();
     m_scheduler->schedule(time::milliseconds(600),
-                          bind(&ChatroomDiscoveryBackend::randomSessionTimeout, this,
+                          bind(&ChatroomDiscoveryBackend::managerSelectionTimeout, this,
                                chatroomName));
   }
   else {
@@ -372,9 +528,7 @@ ChatroomDiscoveryBackend::onNewChatroomForDiscovery(ndn::Name::Component chatroo
     it->second.isManager = false;
     it->second.chatroomPrefix = newPrefix;
 
-    if (it->second.remoteChatroomTimeoutEventId)
-     it->second.remoteChatroomTimeoutEventId.cancel();
-    it->second.isPrint = false;
+    m_chatroomList.cancelExpiry(it);
 
     it->second.localChatroomTimeoutEventId =
       m_scheduler->schedule(HELLO_INTERVAL * 3,
@@ -390,11 +544,14 @@ ChatroomDiscoveryBackend::onRespondChatroomInfoRequest(ChatroomInfo chatroomInfo
   if (isManager)
     chatroomInfo.setManager(m_routableUserDiscoveryPrefix.getPrefix(IDENTITY_OFFSET));
   Name::Component chatroomName = chatroomInfo.getName();
-  m_chatroomList[chatroomName].chatroomName = chatroomName.toUri();
-  m_chatroomList[chatroomName].isManager = isManager;
-  m_chatroomList[chatroomName].count = 0;
-  m_chatroomList[chatroomName].info = chatroomInfo;
-  sendChatroomList();
+  ChatroomInfoBackend& chatroom = m_chatroomList.get(chatroomName);
+  chatroom.isManager = isManager;
+  chatroom.count = 0;
+  chatroom.info = chatroomInfo;
+  // a new manager starts with a full snapshot of its own
+  if (isManager)
+    chatroom.snapshotSession.clear();
+  scheduleChatroomListChanges();
   onAddInRoster(m_routableUserDiscoveryPrefix.getPrefix(IDENTITY_OFFSET), chatroomName);
 }
 
@@ -408,16 +565,43 @@ ChatroomDiscoveryBackend::onIdentityUpdated(const QString& identity)
 }
 
 void
-ChatroomDiscoveryBackend::sendChatroomList()
+ChatroomDiscoveryBackend::onExpiryTick()
 {
-  QStringList chatroomList;
-  for (const auto& chatroom : m_chatroomList) {
-    chatroomList << QString::fromStdString(chatroom.first.toUri());
-  }
+  if (m_chatroomList.advance() > 0)
+    scheduleChatroomListChanges();
+
+  m_expiryTickId = m_scheduler->schedule(EXPIRY_TICK, [this] { onExpiryTick(); });
+}
+
+void
+ChatroomDiscoveryBackend::sendChatroomListChanges()
+{
+  if (!m_chatroomList.hasChanges())
+    return;
+
+  std::vector<std::string> added;
+  std::vector<std::string> removed;
+  m_chatroomList.takeChanges(added, removed);
+
+  QStringList addedList;
+  for (const auto& chatroomName : added)
+    addedList << QString::fromStdString(chatroomName);
+
+  QStringList removedList;
+  for (const auto& chatroomName : removed)
+    removedList << QString::fromStdString(chatroomName);
 
-  emit chatroomListReady(chatroomList);
-  m_refreshPanelId = m_scheduler->schedule(REFRESH_INTERVAL,
-                                           [this] { sendChatroomList(); });
+  emit chatroomListChanged(addedList, removedList);
+}
+
+void
+ChatroomDiscoveryBackend::scheduleChatroomListChanges()
+{
+  if (m_listChangesId)
+    return;
+
+  m_listChangesId = m_scheduler->schedule(LIST_CHANGES_DELAY,
+                                          [this] { sendChatroomListChanges(); });
 }
 
 void
@@ -425,7 +609,8 @@ ChatroomDiscoveryBackend::onWaitForChatroomInfo(const QString& chatroomName)
 {
   auto chatroom = m_chatroomList.find(Name::Component(chatroomName.toStdString()));
   if (chatroom != m_chatroomList.end())
-    emit chatroomInfoReady(chatroom->second.info, chatroom->second.isParticipant);
+    emit chatroomInfoReady(chatroom->second.info, chatroom->second.isParticipant,
+                           chatroom->second.isStale);
 }
 
 void
@@ -441,6 +626,7 @@ ChatroomDiscoveryBackend::shutdown()
     std::lock_guard<std::mutex>lock(m_nfdConnectionMutex);
     m_isNfdConnected = true;
   }
+  m_nfdConnectionCondition.notify_all();
 
   m_face->getIoService().stop();
 }
@@ -448,8 +634,11 @@ ChatroomDiscoveryBackend::shutdown()
 void
 ChatroomDiscoveryBackend::onNfdReconnect()
 {
-  std::lock_guard<std::mutex>lock(m_nfdConnectionMutex);
-  m_isNfdConnected = true;
+  {
+    std::lock_guard<std::mutex>lock(m_nfdConnectionMutex);
+    m_isNfdConnected = true;
+  }
+  m_nfdConnectionCondition.notify_all();
 }
 
 } // namespace chronochat
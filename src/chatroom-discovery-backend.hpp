@@ -16,7 +16,10 @@
 #ifndef Q_MOC_RUN
 #include "common.hpp"
 #include "chatroom-info.hpp"
-#include <boost/random.hpp>
+#include "chatroom-info-delta.hpp"
+#include "chatroom-discovery-table.hpp"
+#include "discovery-cache.hpp"
+#include <condition_variable>
 #include <mutex>
 #include <ChronoSync/socket.hpp>
 #include <boost/thread.hpp>
@@ -24,31 +27,6 @@
 
 namespace chronochat {
 
-class ChatroomInfoBackend
-{
-public:
-  std::string chatroomName;
-  Name chatroomPrefix;
-  ChatroomInfo info;
-  // For a chatroom's user to check whether his own chatroom is alive
-  ndn::scheduler::EventId localChatroomTimeoutEventId;
-  // If the manager no longer exist, set a random timer to compete for manager
-  ndn::scheduler::EventId managerSelectionTimeoutEventId;
-  // For a user to check the status of the chatroom that he is not in.
-  ndn::scheduler::EventId remoteChatroomTimeoutEventId;
-  // If the user is manager, he will need the helloEventId to keep track of hello message
-  ndn::scheduler::ScopedEventId helloTimeoutEventId;
-  // To tell whether the user is in this chatroom
-  bool isParticipant;
-  // To tell whether the user is the manager
-  bool isManager;
-  // Variable to tell whether another manager exists
-  int count;
-  // Variable to tell whether to print on the panel
-  bool isPrint;
-
-};
-
 class ChatroomDiscoveryBackend : public QThread
 {
   Q_OBJECT
@@ -65,27 +43,71 @@ protected:
   void
   run();
 
-private:
+  /**
+   * @brief create the face of a new session of the backend
+   *
+   * The tests run the backend without its thread, on a face of their own.
+   */
+  virtual shared_ptr<ndn::Face>
+  makeFace();
+
   void
   initializeSync();
 
   void
   close();
 
+private:
+  /**
+   * @brief fill the chatroom list with the cached chatrooms, marked as stale
+   */
+  void
+  loadDiscoveryCache();
+
+  /**
+   * @brief save the chatrooms received from the network to the discovery cache
+   */
+  void
+  saveDiscoveryCache();
+
+  void
+  scheduleDiscoveryCacheSave();
+
   void
   processSyncUpdate(const std::vector<chronosync::MissingDataInfo>& updates);
 
   void
   processChatroomData(const ndn::Data& data);
 
+  /**
+   * @brief replace the info of a remote chatroom with a snapshot
+   *
+   * @param chatroom the chatroom to update
+   * @param session the session that published the snapshot
+   * @param seqNo the sequence number of the snapshot
+   * @param info the snapshot
+   */
   void
-  localSessionTimeout(const Name::Component& chatroomName);
+  applyChatroomInfoSnapshot(ChatroomInfoBackend& chatroom, const Name& session,
+                            chronosync::SeqNo seqNo, const ChatroomInfo& info);
+
+  /**
+   * @brief apply a delta to the info of a remote chatroom
+   *
+   * @return false if the snapshot that the delta is based on is missing
+   */
+  bool
+  applyChatroomInfoDelta(ChatroomInfoBackend& chatroom, const Name& session,
+                         chronosync::SeqNo seqNo, const ChatroomInfoDelta& delta);
 
   void
-  remoteSessionTimeout(const Name::Component& chatroomName);
+  localSessionTimeout(const Name::Component& chatroomName);
 
+  /**
+   * @brief take over as the manager of a chatroom
+   */
   void
-  randomSessionTimeout(const Name::Component& chatroomName);
+  managerSelectionTimeout(const Name::Component& chatroomName);
 
   void
   sendUpdate(const Name::Component& chatroomName);
@@ -93,8 +115,23 @@ private:
   void
   updatePrefixes();
 
+  /**
+   * @brief advance the expiry of the chatrooms that the user is not in
+   */
+  void
+  onExpiryTick();
+
+  /**
+   * @brief push the chatrooms added and removed since the last push to front end
+   */
+  void
+  sendChatroomListChanges();
+
+  /**
+   * @brief push the changes of the chatroom list shortly, coalescing bursts of changes
+   */
   void
-  sendChatroomList();
+  scheduleChatroomListChanges();
 
 signals:
   /**
@@ -116,14 +153,24 @@ signals:
   void
   chatroomListReady(const QStringList& chatroomList);
 
+  /**
+   * @brief send the changes of the chatroom list to front end
+   *
+   * @param added the chatrooms discovered since the last update
+   * @param removed the chatrooms gone since the last update
+   */
+  void
+  chatroomListChanged(const QStringList& added, const QStringList& removed);
+
   /**
    * @brief send chatroom info to front end
    *
    * @param info the chatroom info request by front end
    * @param isParticipant if the user is a participant of the chatroom
+   * @param isStale if the info comes from the discovery cache and is not confirmed yet
    */
   void
-  chatroomInfoReady(const ChatroomInfo& info, bool isParticipant);
+  chatroomInfoReady(const ChatroomInfo& info, bool isParticipant, bool isStale);
 
   void
   nfdError();
@@ -213,8 +260,6 @@ public slots:
 
 private:
 
-  typedef std::map<ndn::Name::Component, ChatroomInfoBackend> ChatroomList;
-
   bool m_shouldResume;
   bool m_isNfdConnected;
   Name m_discoveryPrefix;
@@ -223,18 +268,19 @@ private:
   Name m_userDiscoveryPrefix;
   Name m_identity;
 
-  boost::mt19937 m_randomGenerator;
-  boost::variate_generator<boost::mt19937&, boost::uniform_int<> > m_rangeUniformRandom;
-
   shared_ptr<ndn::Face> m_face;
 
   unique_ptr<ndn::Scheduler> m_scheduler;            // scheduler
-  ndn::scheduler::ScopedEventId m_refreshPanelId;
+  ndn::scheduler::ScopedEventId m_expiryTickId;
+  ndn::scheduler::ScopedEventId m_listChangesId;
+  ndn::scheduler::ScopedEventId m_cacheSaveId;
   shared_ptr<chronosync::Socket> m_sock; // SyncSocket
 
-  ChatroomList m_chatroomList;
+  ChatroomDiscoveryTable m_chatroomList;
+  DiscoveryCache m_discoveryCache;
   std::mutex m_resumeMutex;
   std::mutex m_nfdConnectionMutex;
+  std::condition_variable m_nfdConnectionCondition;
 
 };
 
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Qiuhan Ding <qiuhanding@cs.ucla.edu>
+ *         Yingdi Yu <yingdi@cs.ucla.edu>
+ */
+
+#include "chatroom-discovery-table.hpp"
+
+#include <boost/functional/hash.hpp>
+
+namespace chronochat {
+
+size_t
+ChatroomDiscoveryTable::ComponentHash::operator()(const Name::Component& component) const
+{
+  return boost::hash_range(component.value_begin(), component.value_end());
+}
+
+ChatroomDiscoveryTable::ChatroomDiscoveryTable(size_t nBuckets)
+  : m_buckets(nBuckets)
+  , m_currentTick(0)
+{
+  BOOST_ASSERT(nBuckets > 1);
+}
+
+ChatroomInfoBackend&
+ChatroomDiscoveryTable::get(const Name::Component& chatroomName)
+{
+  auto it = m_table.find(chatroomName);
+  if (it != m_table.end())
+    return it->second;
+
+  ChatroomInfoBackend& chatroom = m_table[chatroomName];
+  chatroom.chatroomName = chatroomName.toUri();
+  recordChange(chatroomName, true);
+  return chatroom;
+}
+
+void
+ChatroomDiscoveryTable::erase(const Name::Component& chatroomName)
+{
+  if (m_table.erase(chatroomName) > 0)
+    recordChange(chatroomName, false);
+}
+
+void
+ChatroomDiscoveryTable::clear()
+{
+  m_table.clear();
+  for (auto& bucket : m_buckets)
+    bucket.clear();
+  m_changes.clear();
+}
+
+void
+ChatroomDiscoveryTable::setExpiry(iterator it, size_t nTicks)
+{
+  BOOST_ASSERT(nTicks > 0 && nTicks < m_buckets.size());
+
+  it->second.expiryTick = m_currentTick + nTicks;
+  m_buckets[it->second.expiryTick % m_buckets.size()].push_back(it->first);
+}
+
+void
+ChatroomDiscoveryTable::cancelExpiry(iterator it)
+{
+  // the bucket slot becomes stale and is skipped when swept
+  it->second.expiryTick = 0;
+}
+
+size_t
+ChatroomDiscoveryTable::advance()
+{
+  ++m_currentTick;
+
+  std::vector<Name::Component> bucket;
+  bucket.swap(m_buckets[m_currentTick % m_buckets.size()]);
+
+  size_t nRemoved = 0;
+  for (const auto& chatroomName : bucket) {
+    auto it = m_table.find(chatroomName);
+    if (it != m_table.end() && it->second.expiryTick == m_currentTick) {
+      m_table.erase(it);
+      recordChange(chatroomName, false);
+      ++nRemoved;
+    }
+  }
+  return nRemoved;
+}
+
+void
+ChatroomDiscoveryTable::takeChanges(std::vector<std::string>& added,
+                                    std::vector<std::string>& removed)
+{
+  for (const auto& change : m_changes) {
+    if (change.second)
+      added.push_back(change.first.toUri());
+    else
+      removed.push_back(change.first.toUri());
+  }
+  m_changes.clear();
+}
+
+std::vector<std::string>
+ChatroomDiscoveryTable::getNames() const
+{
+  std::vector<std::string> names;
+  names.reserve(m_table.size());
+  for (const auto& chatroom : m_table)
+    names.push_back(chatroom.first.toUri());
+  return names;
+}
+
+void
+ChatroomDiscoveryTable::recordChange(const Name::Component& chatroomName, bool isAdded)
+{
+  auto it = m_changes.find(chatroomName);
+  if (it == m_changes.end())
+    m_changes.emplace(chatroomName, isAdded);
+  else if (it->second != isAdded)
+    // added and removed again, or removed and added again, since the last push
+    m_changes.erase(it);
+}
+
+} // namespace chronochat
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Qiuhan Ding <qiuhanding@cs.ucla.edu>
+ *         Yingdi Yu <yingdi@cs.ucla.edu>
+ */
+
+#ifndef CHRONOCHAT_CHATROOM_DISCOVERY_TABLE_HPP
+#define CHRONOCHAT_CHATROOM_DISCOVERY_TABLE_HPP
+
+#include "common.hpp"
+#include "chatroom-info.hpp"
+#include <ndn-cxx/util/scheduler.hpp>
+#include <unordered_map>
+
+namespace chronochat {
+
+class ChatroomInfoBackend
+{
+public:
+  std::string chatroomName;
+  Name chatroomPrefix;
+  ChatroomInfo info;
+  // The last full snapshot, deltas are published and applied against it
+  ChatroomInfo snapshot;
+  // The session and sequence number under which the snapshot was published
+  Name snapshotSession;
+  uint64_t snapshotSeqNo = 0;
+  // The sequence number of the update that info reflects
+  uint64_t infoSeqNo = 0;
+  // For the manager to count the deltas published since the last snapshot
+  int deltaCount = 0;
+  // For a chatroom's user to check whether his own chatroom is alive
+  ndn::scheduler::EventId localChatroomTimeoutEventId;
+  // If the manager no longer exist, set a timer ranked by the election to take over
+  ndn::scheduler::EventId managerSelectionTimeoutEventId;
+  // If the user is manager, he will need the helloEventId to keep track of hello message
+  ndn::scheduler::ScopedEventId helloTimeoutEventId;
+  // For a user to drop a chatroom that he is not in, 0 if the chatroom does not expire
+  uint64_t expiryTick = 0;
+  // When the info was last received from the network
+  time::system_clock::TimePoint lastUpdate;
+  // The info was loaded from the discovery cache and not refreshed by the network yet
+  bool isStale = false;
+  // To tell whether the user is in this chatroom
+  bool isParticipant = false;
+  // To tell whether the user is the manager
+  bool isManager = false;
+  // Variable to tell whether another manager exists
+  int count = 0;
+};
+
+/**
+ * @brief the table of discovered chatrooms
+ *
+ * Chatrooms are indexed by a hash of their name. Instead of one scheduler event per chatroom,
+ * expiry is tracked in a ring of buckets that is advanced by a single periodic tick; refreshing
+ * a chatroom just records its new expiry tick, stale bucket slots are skipped when swept.
+ *
+ * Insertions and removals are accumulated until they are taken with takeChanges(), so that the
+ * discovery panel only receives what changed since the last push.
+ */
+class ChatroomDiscoveryTable
+{
+public:
+  class ComponentHash
+  {
+  public:
+    size_t
+    operator()(const Name::Component& component) const;
+  };
+
+  typedef std::unordered_map<Name::Component, ChatroomInfoBackend, ComponentHash> Table;
+  typedef Table::iterator iterator;
+  typedef Table::const_iterator const_iterator;
+
+  /**
+   * @param nBuckets the number of expiry buckets, bounds the longest expiry in ticks
+   */
+  explicit
+  ChatroomDiscoveryTable(size_t nBuckets);
+
+  iterator
+  find(const Name::Component& chatroomName);
+
+  /**
+   * @brief get the entry of a chatroom, create it if it does not exist
+   */
+  ChatroomInfoBackend&
+  get(const Name::Component& chatroomName);
+
+  void
+  erase(const Name::Component& chatroomName);
+
+  /**
+   * @brief remove all the chatrooms without recording the changes
+   */
+  void
+  clear();
+
+  /**
+   * @brief let a chatroom expire @p nTicks ticks from now, replacing its previous expiry
+   */
+  void
+  setExpiry(iterator it, size_t nTicks);
+
+  void
+  cancelExpiry(iterator it);
+
+  /**
+   * @brief move to the next tick and remove the chatrooms that expire at it
+   *
+   * @return the number of removed chatrooms
+   */
+  size_t
+  advance();
+
+  bool
+  hasChanges() const;
+
+  /**
+   * @brief get the chatrooms added and removed since the last call
+   */
+  void
+  takeChanges(std::vector<std::string>& added, std::vector<std::string>& removed);
+
+  /**
+   * @brief get the names of all the chatrooms
+   */
+  std::vector<std::string>
+  getNames() const;
+
+  iterator
+  begin();
+
+  iterator
+  end();
+
+  size_t
+  size() const;
+
+private:
+  void
+  recordChange(const Name::Component& chatroomName, bool isAdded);
+
+private:
+  Table m_table;
+  std::vector<std::vector<Name::Component>> m_buckets;
+  uint64_t m_currentTick;
+  // true if the chatroom was added since the last takeChanges(), false if it was removed
+  std::unordered_map<Name::Component, bool, ComponentHash> m_changes;
+};
+
+inline ChatroomDiscoveryTable::iterator
+ChatroomDiscoveryTable::find(const Name::Component& chatroomName)
+{
+  return m_table.find(chatroomName);
+}
+
+inline ChatroomDiscoveryTable::iterator
+ChatroomDiscoveryTable::begin()
+{
+  return m_table.begin();
+}
+
+inline ChatroomDiscoveryTable::iterator
+ChatroomDiscoveryTable::end()
+{
+  return m_table.end();
+}
+
+inline size_t
+ChatroomDiscoveryTable::size() const
+{
+  return m_table.size();
+}
+
+inline bool
+ChatroomDiscoveryTable::hasChanges() const
+{
+  return !m_changes.empty();
+}
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_CHATROOM_DISCOVERY_TABLE_HPP
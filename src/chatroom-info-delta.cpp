@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Qiuhan Ding <qiuhanding@cs.ucla.edu>
+ *         Yingdi Yu <yingdi@cs.ucla.edu>
+ */
+
+#include "chatroom-info-delta.hpp"
+
+#include <set>
+
+namespace chronochat {
+
+BOOST_CONCEPT_ASSERT((ndn::WireEncodable<ChatroomInfoDelta>));
+BOOST_CONCEPT_ASSERT((ndn::WireDecodable<ChatroomInfoDelta>));
+
+ChatroomInfoDelta::ChatroomInfoDelta()
+  : m_baseVersion(0)
+{
+}
+
+ChatroomInfoDelta::ChatroomInfoDelta(const Block& deltaWire)
+{
+  this->wireDecode(deltaWire);
+}
+
+template<ndn::encoding::Tag T>
+size_t
+ChatroomInfoDelta::wireEncode(ndn::EncodingImpl<T>& encoder) const
+{
+  size_t totalLength = 0;
+
+  // ChatroomInfoDelta := CHATROOM-INFO-DELTA-TYPE TLV-LENGTH
+  //                        ChatroomName
+  //                        BaseVersion
+  //                        AddedParticipants
+  //                        RemovedParticipants
+  //
+  // ChatroomName := CHATROOM-NAME-TYPE TLV-LENGTH
+  //                   NameComponent
+  //
+  // BaseVersion := BASE-VERSION-TYPE TLV-LENGTH
+  //                  nonNegativeInteger
+  //
+  // AddedParticipants := ADDED-PARTICIPANTS-TYPE TLV-LENGTH
+  //                        Name*
+  //
+  // RemovedParticipants := REMOVED-PARTICIPANTS-TYPE TLV-LENGTH
+  //                          Name*
+
+  // Removed Participants
+  size_t removedLength = 0;
+  for (auto it = m_removedParticipants.rbegin(); it != m_removedParticipants.rend(); ++it) {
+    removedLength += it->wireEncode(encoder);
+  }
+  removedLength += encoder.prependVarNumber(removedLength);
+  removedLength += encoder.prependVarNumber(tlv::RemovedParticipants);
+  totalLength += removedLength;
+
+  // Added Participants
+  size_t addedLength = 0;
+  for (auto it = m_addedParticipants.rbegin(); it != m_addedParticipants.rend(); ++it) {
+    addedLength += it->wireEncode(encoder);
+  }
+  addedLength += encoder.prependVarNumber(addedLength);
+  addedLength += encoder.prependVarNumber(tlv::AddedParticipants);
+  totalLength += addedLength;
+
+  // Base Version
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::BaseVersion, m_baseVersion);
+
+  // Chatroom Name
+  size_t chatroomNameLength = m_chatroomName.wireEncode(encoder);
+  totalLength += chatroomNameLength;
+  totalLength += encoder.prependVarNumber(chatroomNameLength);
+  totalLength += encoder.prependVarNumber(tlv::ChatroomName);
+
+  // Chatroom Info Delta
+  totalLength += encoder.prependVarNumber(totalLength);
+  totalLength += encoder.prependVarNumber(tlv::ChatroomInfoDelta);
+
+  return totalLength;
+}
+
+const Block&
+ChatroomInfoDelta::wireEncode() const
+{
+  ndn::EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
+
+  ndn::EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
+
+  m_wire = buffer.block();
+  m_wire.parse();
+
+  return m_wire;
+}
+
+static void
+decodeParticipantList(const Block& block, std::list<Name>& participants)
+{
+  Block temp = block;
+  temp.parse();
+
+  Block::element_const_iterator j = temp.elements_begin();
+  while (j != temp.elements_end() && j->type() == tlv::Name) {
+    participants.push_back(Name(*j));
+    ++j;
+  }
+  if (j != temp.elements_end())
+    NDN_THROW(ChatroomInfoDelta::Error("Unexpected element"));
+}
+
+void
+ChatroomInfoDelta::wireDecode(const Block& deltaWire)
+{
+  m_wire = deltaWire;
+  m_wire.parse();
+
+  m_addedParticipants.clear();
+  m_removedParticipants.clear();
+
+  // ChatroomInfoDelta := CHATROOM-INFO-DELTA-TYPE TLV-LENGTH
+  //                        ChatroomName
+  //                        BaseVersion
+  //                        AddedParticipants
+  //                        RemovedParticipants
+
+  if (m_wire.type() != tlv::ChatroomInfoDelta)
+    NDN_THROW(Error("Unexpected TLV number when decoding chatroom delta packet"));
+
+  // Chatroom Name
+  Block::element_const_iterator i = m_wire.elements_begin();
+  if (i == m_wire.elements_end())
+    NDN_THROW(Error("Missing Chatroom Name"));
+  if (i->type() != tlv::ChatroomName)
+    NDN_THROW(Error("Expect Chatroom Name but get TLV Type " + std::to_string(i->type())));
+  m_chatroomName.wireDecode(i->blockFromValue());
+  ++i;
+
+  // Base Version
+  if (i == m_wire.elements_end())
+    NDN_THROW(Error("Missing Base Version"));
+  if (i->type() != tlv::BaseVersion)
+    NDN_THROW(Error("Expect Base Version but get TLV Type " + std::to_string(i->type())));
+  m_baseVersion = readNonNegativeInteger(*i);
+  ++i;
+
+  // Added Participants
+  if (i == m_wire.elements_end())
+    NDN_THROW(Error("Missing Added Participants"));
+  if (i->type() != tlv::AddedParticipants)
+    NDN_THROW(Error("Expect Added Participants but get TLV Type " + std::to_string(i->type())));
+  decodeParticipantList(*i, m_addedParticipants);
+  ++i;
+
+  // Removed Participants
+  if (i == m_wire.elements_end())
+    NDN_THROW(Error("Missing Removed Participants"));
+  if (i->type() != tlv::RemovedParticipants)
+    NDN_THROW(Error("Expect Removed Participants but get TLV Type " +
+                    std::to_string(i->type())));
+  decodeParticipantList(*i, m_removedParticipants);
+  ++i;
+
+  if (i != m_wire.elements_end()) {
+    NDN_THROW(Error("Unexpected element"));
+  }
+}
+
+void
+ChatroomInfoDelta::setName(const Name::Component& name)
+{
+  m_wire.reset();
+  m_chatroomName = name;
+}
+
+void
+ChatroomInfoDelta::setBaseVersion(uint64_t baseVersion)
+{
+  m_wire.reset();
+  m_baseVersion = baseVersion;
+}
+
+void
+ChatroomInfoDelta::setParticipants(const std::list<Name>& base, const std::list<Name>& current)
+{
+  m_wire.reset();
+  m_addedParticipants.clear();
+  m_removedParticipants.clear();
+
+  std::set<Name> baseSet(base.begin(), base.end());
+  std::set<Name> currentSet(current.begin(), current.end());
+
+  for (const auto& participant : current) {
+    if (baseSet.count(participant) == 0)
+      m_addedParticipants.push_back(participant);
+  }
+  for (const auto& participant : base) {
+    if (currentSet.count(participant) == 0)
+      m_removedParticipants.push_back(participant);
+  }
+}
+
+void
+ChatroomInfoDelta::apply(ChatroomInfo& info) const
+{
+  for (const auto& participant : m_removedParticipants)
+    info.removeParticipant(participant);
+  for (const auto& participant : m_addedParticipants)
+    info.addParticipant(participant);
+}
+
+} // namespace chronochat
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Qiuhan Ding <qiuhanding@cs.ucla.edu>
+ *         Yingdi Yu <yingdi@cs.ucla.edu>
+ */
+
+#ifndef CHRONOCHAT_CHATROOM_INFO_DELTA_HPP
+#define CHRONOCHAT_CHATROOM_INFO_DELTA_HPP
+
+#include "common.hpp"
+#include "tlv.hpp"
+#include "chatroom-info.hpp"
+#include <ndn-cxx/name-component.hpp>
+#include <ndn-cxx/util/concepts.hpp>
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
+#include <boost/concept_check.hpp>
+#include <list>
+
+namespace chronochat {
+
+/** \brief the participant changes of a chatroom against a full ChatroomInfo snapshot.
+
+    The base version is the sync sequence number under which the snapshot was published
+    by the same session. A delta is cumulative: it carries every change since the snapshot,
+    so a receiver that holds the snapshot can rebuild the current info from any one delta.
+ */
+class ChatroomInfoDelta
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+public:
+  ChatroomInfoDelta();
+
+  explicit
+  ChatroomInfoDelta(const Block& deltaWire);
+
+  const Block&
+  wireEncode() const;
+
+  void
+  wireDecode(const Block& deltaWire);
+
+  const Name::Component&
+  getName() const;
+
+  uint64_t
+  getBaseVersion() const;
+
+  const std::list<Name>&
+  getAddedParticipants() const;
+
+  const std::list<Name>&
+  getRemovedParticipants() const;
+
+  void
+  setName(const Name::Component& name);
+
+  void
+  setBaseVersion(uint64_t baseVersion);
+
+  /**
+   * @brief compute the participant changes from @p base to @p current
+   */
+  void
+  setParticipants(const std::list<Name>& base, const std::list<Name>& current);
+
+  /**
+   * @brief apply the participant changes to a copy of the base snapshot
+   */
+  void
+  apply(ChatroomInfo& info) const;
+
+  /**
+   * @brief the number of participant changes carried by the delta
+   */
+  size_t
+  size() const;
+
+private:
+  template<ndn::encoding::Tag T>
+  size_t
+  wireEncode(ndn::EncodingImpl<T>& encoder) const;
+
+private:
+  mutable Block m_wire;
+  Name::Component m_chatroomName;
+  uint64_t m_baseVersion;
+  std::list<Name> m_addedParticipants;
+  std::list<Name> m_removedParticipants;
+};
+
+inline const Name::Component&
+ChatroomInfoDelta::getName() const
+{
+  return m_chatroomName;
+}
+
+inline uint64_t
+ChatroomInfoDelta::getBaseVersion() const
+{
+  return m_baseVersion;
+}
+
+inline const std::list<Name>&
+ChatroomInfoDelta::getAddedParticipants() const
+{
+  return m_addedParticipants;
+}
+
+inline const std::list<Name>&
+ChatroomInfoDelta::getRemovedParticipants() const
+{
+  return m_removedParticipants;
+}
+
+inline size_t
+ChatroomInfoDelta::size() const
+{
+  return m_addedParticipants.size() + m_removedParticipants.size();
+}
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_CHATROOM_INFO_DELTA_HPP
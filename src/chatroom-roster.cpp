@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Yingdi Yu <yingdi@cs.ucla.edu>
+ *         Qiuhan Ding <qiuhanding@cs.ucla.edu>
+ */
+
+#include "chatroom-roster.hpp"
+
+namespace chronochat {
+
+// session prefix := routable identity/CHRONOCHAT-CHATDATA/<chatroom>/<session>
+static const int IDENTITY_OFFSET = -3;
+
+ChatroomRoster::ChatroomRoster(const std::string& chatroomName, QObject* parent)
+  : QObject(parent)
+  , m_chatroomName(chatroomName)
+{
+}
+
+bool
+ChatroomRoster::addSession(const Name& sessionPrefix, const std::string& nick, bool isLocal)
+{
+  Name participant;
+  QString qNick = QString::fromStdString(nick);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_sessions.find(sessionPrefix) != m_sessions.end())
+      return false;
+
+    Entry& entry = m_sessions[sessionPrefix];
+    entry.sessionPrefix = sessionPrefix;
+    entry.participant = sessionPrefix.getPrefix(IDENTITY_OFFSET);
+    entry.nick = qNick;
+    entry.isLocal = isLocal;
+    participant = entry.participant;
+  }
+
+  emit sessionAdded(sessionPrefix, qNick);
+  if (!isLocal)
+    emit participantAdded(participant, m_chatroomName);
+  return true;
+}
+
+bool
+ChatroomRoster::removeSession(const Name& sessionPrefix)
+{
+  Name participant;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_sessions.find(sessionPrefix);
+    if (it == m_sessions.end())
+      return false;
+
+    participant = it->second.participant;
+    m_sessions.erase(it);
+  }
+
+  emit sessionRemoved(sessionPrefix);
+  emit participantRemoved(participant, m_chatroomName);
+  return true;
+}
+
+bool
+ChatroomRoster::hasSession(const Name& sessionPrefix) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_sessions.find(sessionPrefix) != m_sessions.end();
+}
+
+std::string
+ChatroomRoster::getNick(const Name& sessionPrefix) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_sessions.find(sessionPrefix);
+  if (it == m_sessions.end())
+    return "";
+  return it->second.nick.toStdString();
+}
+
+std::vector<Name>
+ChatroomRoster::getParticipants() const
+{
+  std::vector<Name> participants;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  participants.reserve(m_sessions.size());
+  for (const auto& session : m_sessions)
+    participants.push_back(session.second.participant);
+  return participants;
+}
+
+QStringList
+ChatroomRoster::getNickList() const
+{
+  QStringList nickList;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (const auto& session : m_sessions)
+    nickList << "- " + session.second.nick;
+  return nickList;
+}
+
+size_t
+ChatroomRoster::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_sessions.size();
+}
+
+void
+ChatroomRoster::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_sessions.clear();
+}
+
+} // namespace chronochat
+
+#if WAF
+#include "chatroom-roster.moc"
+#endif
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Yingdi Yu <yingdi@cs.ucla.edu>
+ *         Qiuhan Ding <qiuhanding@cs.ucla.edu>
+ */
+
+#ifndef CHRONOCHAT_CHATROOM_ROSTER_HPP
+#define CHRONOCHAT_CHATROOM_ROSTER_HPP
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#ifndef Q_MOC_RUN
+#include "common.hpp"
+#include <mutex>
+#endif
+
+namespace chronochat {
+
+/**
+ * @brief The roster of a chatroom, shared by the chat backend, the chat dialog and discovery
+ *
+ * Sessions are keyed by their session prefix. The routable identity of each participant is
+ * derived once when the session joins, so that queries do not need to parse or encode names.
+ *
+ * The roster is written by the backend thread and read by the GUI thread, all the accessors
+ * are thread-safe. Changes are published through Qt signals.
+ */
+class ChatroomRoster : public QObject
+{
+  Q_OBJECT
+
+public:
+  class Entry
+  {
+  public:
+    Name sessionPrefix;
+    Name participant;
+    QString nick;
+    bool isLocal;
+  };
+
+  explicit
+  ChatroomRoster(const std::string& chatroomName, QObject* parent = nullptr);
+
+  /**
+   * @brief add a session to the roster
+   *
+   * @param sessionPrefix the session prefix of the participant
+   * @param nick the nick of the participant
+   * @param isLocal whether the session is the user's own session
+   * @return true if the session is new
+   */
+  bool
+  addSession(const Name& sessionPrefix, const std::string& nick, bool isLocal = false);
+
+  /**
+   * @brief remove a session from the roster
+   *
+   * @return true if the session was in the roster
+   */
+  bool
+  removeSession(const Name& sessionPrefix);
+
+  bool
+  hasSession(const Name& sessionPrefix) const;
+
+  std::string
+  getNick(const Name& sessionPrefix) const;
+
+  /**
+   * @brief get the routable identities of all participants
+   */
+  std::vector<Name>
+  getParticipants() const;
+
+  /**
+   * @brief get the nick list in the format displayed by the chat dialog
+   */
+  QStringList
+  getNickList() const;
+
+  size_t
+  size() const;
+
+  /**
+   * @brief remove all sessions without notification
+   *
+   * This is used when the backend is reset, the chat dialog is reset at the same time.
+   */
+  void
+  clear();
+
+signals:
+  /**
+   * @brief a session joins the roster
+   *
+   * @param sessionPrefix the session prefix
+   * @param nick the nick of the participant
+   */
+  void
+  sessionAdded(ndn::Name sessionPrefix, QString nick);
+
+  /**
+   * @brief a session leaves the roster
+   *
+   * @param sessionPrefix the session prefix
+   */
+  void
+  sessionRemoved(ndn::Name sessionPrefix);
+
+  /**
+   * @brief a remote participant joins the chatroom
+   *
+   * The local session is announced to discovery through the chatroom join instead.
+   *
+   * @param participant the routable identity of the participant
+   * @param chatroomName the name of the chatroom
+   */
+  void
+  participantAdded(ndn::Name participant, ndn::Name::Component chatroomName);
+
+  /**
+   * @brief a participant leaves the chatroom
+   *
+   * @param participant the routable identity of the participant
+   * @param chatroomName the name of the chatroom
+   */
+  void
+  participantRemoved(ndn::Name participant, ndn::Name::Component chatroomName);
+
+private:
+  typedef std::map<Name, Entry> Sessions;
+
+  Name::Component m_chatroomName;
+  Sessions m_sessions;
+
+  mutable std::mutex m_mutex;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_CHATROOM_ROSTER_HPP
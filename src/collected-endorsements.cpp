@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "collected-endorsements.hpp"
+
+#include <ndn-cxx/util/sha256.hpp>
+
+namespace chronochat {
+
+CollectedEndorsements::CollectedEndorsements()
+  : m_digest(ndn::util::Sha256::DIGEST_SIZE, '\0')
+  , m_isPublished(false)
+  , m_isWireStale(true)
+{
+}
+
+bool
+CollectedEndorsements::set(const Name& endorser, const Name& certName, const std::string& hash)
+{
+  auto it = m_entries.find(endorser);
+  if (it != m_entries.end()) {
+    if (it->second.certName == certName && it->second.hash == hash)
+      return false;
+    toggle(endorser, it->second);
+  }
+
+  EndorseCollection::CollectionEntry& entry = m_entries[endorser];
+  entry.certName = certName;
+  entry.hash = hash;
+  toggle(endorser, entry);
+
+  m_isWireStale = true;
+  return true;
+}
+
+void
+CollectedEndorsements::clear()
+{
+  m_entries.clear();
+  m_digest.assign(ndn::util::Sha256::DIGEST_SIZE, '\0');
+  m_isPublished = false;
+  m_isWireStale = true;
+}
+
+const Block&
+CollectedEndorsements::wireEncode() const
+{
+  if (m_isWireStale) {
+    EndorseCollection collection;
+    for (const auto& entry : m_entries)
+      collection.addCollectionEntry(entry.second.certName, entry.second.hash);
+    m_wire = collection.wireEncode();
+    m_isWireStale = false;
+  }
+  return m_wire;
+}
+
+void
+CollectedEndorsements::markPublished()
+{
+  m_publishedDigest = m_digest;
+  m_isPublished = true;
+}
+
+std::string
+CollectedEndorsements::computeHash(const Block& endorseCertificate)
+{
+  ndn::util::Sha256 digest;
+  digest.update(endorseCertificate.wire(), endorseCertificate.size());
+  ndn::ConstBufferPtr result = digest.computeDigest();
+  return std::string(reinterpret_cast<const char*>(result->data()), result->size());
+}
+
+void
+CollectedEndorsements::toggle(const Name& endorser,
+                              const EndorseCollection::CollectionEntry& entry)
+{
+  // XOR is its own inverse, and it does not depend on the order of the entries
+  ndn::util::Sha256 digest;
+  digest << endorser.wireEncode() << entry.certName.wireEncode() << entry.hash;
+  ndn::ConstBufferPtr result = digest.computeDigest();
+
+  for (size_t i = 0; i < m_digest.size(); i++)
+    m_digest[i] ^= static_cast<char>((*result)[i]);
+}
+
+} // namespace chronochat
@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_COLLECTED_ENDORSEMENTS_HPP
+#define CHRONOCHAT_COLLECTED_ENDORSEMENTS_HPP
+
+#include "common.hpp"
+#include "endorse-collection.hpp"
+
+namespace chronochat {
+
+/**
+ * @brief the endorsements collected from the contacts, as they are published
+ *
+ * There is one entry per endorser. The encoded collection is kept and only re-encoded after a
+ * change. A digest of the entries is updated with every change, in a time independent of the
+ * number of entries, so that a collection is published again only when its content differs
+ * from the one published last, even after changes that cancel each other.
+ */
+class CollectedEndorsements
+{
+public:
+  CollectedEndorsements();
+
+  /**
+   * @brief set the entry of @p endorser
+   *
+   * @return whether the entry changed
+   */
+  bool
+  set(const Name& endorser, const Name& certName, const std::string& hash);
+
+  void
+  clear();
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+  /**
+   * @brief get the encoded EndorseCollection, which is re-encoded only after a change
+   */
+  const Block&
+  wireEncode() const;
+
+  /**
+   * @brief whether the content differs from the one marked as published
+   */
+  bool
+  needsPublishing() const
+  {
+    return !m_isPublished || m_digest != m_publishedDigest;
+  }
+
+  void
+  markPublished();
+
+  /**
+   * @brief get the hash of an endorse certificate, as carried by a collection entry
+   */
+  static std::string
+  computeHash(const Block& endorseCertificate);
+
+private:
+  /**
+   * @brief fold the digest of an entry into the running digest, which adds or removes it
+   */
+  void
+  toggle(const Name& endorser, const EndorseCollection::CollectionEntry& entry);
+
+private:
+  std::map<Name, EndorseCollection::CollectionEntry> m_entries;
+  std::string m_digest;
+  std::string m_publishedDigest;
+  bool m_isPublished;
+
+  mutable Block m_wire;
+  mutable bool m_isWireStale;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_COLLECTED_ENDORSEMENTS_HPP
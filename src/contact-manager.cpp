@@ -24,6 +24,7 @@
 #include <ndn-cxx/security/validator.hpp>
 #include <ndn-cxx/security/validator-null.hpp>
 #include <ndn-cxx/security/verification-helpers.hpp>
+#include <ndn-cxx/util/random.hpp>
 
 #include <boost/asio.hpp>
 #include <boost/filesystem.hpp>
@@ -42,6 +43,13 @@ using ndn::Face;
 using ndn::OBufferStream;
 using ndn::security::Certificate;
 
+static const size_t CONTENT_STORE_CAPACITY = 1000;
+static const time::seconds CONTENT_STORE_MAX_LIFETIME(60);
+static const size_t ENDORSE_CERT_FETCH_WINDOW = 8;
+static const size_t COLLECT_ENDORSEMENT_WINDOW = 8;
+// collections larger than this are published in segments
+static const size_t ENDORSED_SEGMENT_SIZE = 4096;
+static const uint64_t MAX_ENDORSED_SEGMENTS = 256;
 
 ContactManager::ContactManager(Face& face,
                                ndn::KeyChain& keyChain,
@@ -49,6 +57,8 @@ ContactManager::ContactManager(Face& face,
   : QObject(parent)
   , m_face(face)
   , m_keyChain(keyChain)
+  , m_contentStore(CONTENT_STORE_CAPACITY, CONTENT_STORE_MAX_LIFETIME)
+  , m_scheduler(face.getIoService())
 {
   initializeSecurity();
 }
@@ -71,7 +81,6 @@ ContactManager::fetchCollectEndorse(const Name& identity)
   interestName.append("DNS").append("ENDORSED");
 
   Interest interest(interestName);
-  interest.setInterestLifetime(time::milliseconds(1000));
   interest.setCanBePrefix(true);
   interest.setMustBeFresh(true);
 
@@ -82,80 +91,104 @@ ContactManager::fetchCollectEndorse(const Name& identity)
   TimeoutNotify timeoutNotify =
     bind(&ContactManager::onDnsCollectEndorseTimeoutNotify, this, _1, identity);
 
-  sendInterest(interest, onValidated, onValidationFailed, timeoutNotify, 0);
+  sendInterest(interest, onValidated, onValidationFailed, timeoutNotify);
 }
 
 void
-ContactManager::fetchEndorseCertificateInternal(const Name& identity, size_t certIndex)
+ContactManager::fetchEndorseCertificates(const Name& identity)
 {
-  auto endorseCollection = m_bufferedContacts[identity].m_endorseCollection;
+  FetchedInfo& info = m_bufferedContacts[identity];
+  auto pipeline = std::make_shared<FetchPipeline>(ENDORSE_CERT_FETCH_WINDOW);
+  FetchPipeline* current = pipeline.get();
+  info.m_endorseCertPipeline = pipeline;
 
-  if (certIndex >= endorseCollection->getCollectionEntries().size())
-    return prepareEndorseInfo(identity);
-
-  Name interestName(endorseCollection->getCollectionEntries()[certIndex].certName);
-
-  Interest interest(interestName);
-  interest.setInterestLifetime(time::milliseconds(1000));
-  interest.setCanBePrefix(true);
-  interest.setMustBeFresh(false);
+  for (const auto& entry : info.m_endorseCollection->getCollectionEntries()) {
+    Interest interest(entry.certName);
+    interest.setCanBePrefix(true);
+    interest.setMustBeFresh(false);
+    string hash = entry.hash;
+
+    pipeline->add([=] (const function<void()>& done) {
+      expressInterest(interest,
+                      [=] (const Interest&, const Data& data) {
+                        onEndorseCertificateInternal(interest, data, identity, current, hash);
+                        done();
+                      },
+                      [=] (const Interest&) { done(); },
+                      1);
+    });
+  }
 
-  m_face.expressInterest(interest,
-                         bind(&ContactManager::onEndorseCertificateInternal,
-                              this, _1, _2, identity, certIndex,
-                              endorseCollection->getCollectionEntries()[certIndex].hash),
-                         bind(&ContactManager::onEndorseCertificateInternalTimeout,
-                              this, _1, identity, certIndex),
-                         bind(&ContactManager::onEndorseCertificateInternalTimeout,
-                              this, _1, identity, certIndex));
+  // the certificates are tallied as they arrive, the info is prepared once all are in
+  pipeline->start([=] {
+    auto it = m_bufferedContacts.find(identity);
+    if (it == m_bufferedContacts.end() || it->second.m_endorseCertPipeline.get() != current)
+      return;
+    it->second.m_endorseCertPipeline.reset();
+    prepareEndorseInfo(identity);
+  });
 }
 
 void
 ContactManager::prepareEndorseInfo(const Name& identity)
 {
-  const Profile& profile = m_bufferedContacts[identity].m_selfEndorseCert->getProfile();
+  tallyEndorseCertificates(identity);
+
+  FetchedInfo& info = m_bufferedContacts[identity];
+  const Profile& profile = info.m_selfEndorseCert->getProfile();
 
   auto endorseInfo = std::make_shared<EndorseInfo>();
-  m_bufferedContacts[identity].m_endorseInfo = endorseInfo;
+  info.m_endorseInfo = endorseInfo;
 
-  map<string, size_t> endorseCount;
-  for (auto pIt = profile.begin(); pIt != profile.end(); pIt++)
-    endorseCount[pIt->first] = 0;
+  for (auto pIt = profile.begin(); pIt != profile.end(); pIt++) {
+    std::stringstream ss;
+    ss << info.m_endorseCount[pIt->first] << "/" << info.m_endorseCertList.size();
+    endorseInfo->addEndorsement(pIt->first, pIt->second, ss.str());
+  }
 
-  size_t endorseCertCount = 0;
+  emit contactEndorseInfoReady (*endorseInfo);
+}
 
-  auto cIt = m_bufferedContacts[identity].m_endorseCertList.cbegin();
-  auto cEnd = m_bufferedContacts[identity].m_endorseCertList.cend();
+void
+ContactManager::tallyEndorseCertificates(const Name& identity)
+{
+  FetchedInfo& info = m_bufferedContacts[identity];
+  const Profile& profile = info.m_selfEndorseCert->getProfile();
 
-  for (; cIt != cEnd; cIt++, endorseCertCount++) {
-    shared_ptr<Contact> contact = getContact((*cIt)->getSigner());
-    if (!static_cast<bool>(contact))
-      continue;
+  if (info.m_nTalliedCerts == 0) {
+    info.m_endorseCount.clear();
+    for (auto pIt = profile.begin(); pIt != profile.end(); pIt++)
+      info.m_endorseCount[pIt->first] = 0;
+  }
 
-    if (!contact->isIntroducer() ||
-        !contact->canBeTrustedFor(profile.getIdentityName()))
-      continue;
+  auto findContact = [this] (const Name& signer) { return getContact(signer); };
 
-    if (!(*cIt)->isValid())
-      continue;
+  // only the certificates that arrived since the last tally are verified
+  for (; info.m_nTalliedCerts < info.m_endorseCertList.size(); info.m_nTalliedCerts++) {
+    const EndorseCertificate& cert = *info.m_endorseCertList[info.m_nTalliedCerts];
 
-    if (!ndn::security::verifySignature(**cIt, contact->getPublicKey().data(), contact->getPublicKey().size()))
+    if (!m_endorseVerificationCache.verify(cert, profile.getIdentityName(), findContact,
+                                           m_trustScopeIndex))
       continue;
 
-    const Profile& tmpProfile = (*cIt)->getProfile();
-    const auto& endorseList = (*cIt)->getEndorseList();
+    const Profile& tmpProfile = cert.getProfile();
+    const auto& endorseList = cert.getEndorseList();
     for (auto eIt = endorseList.begin(); eIt != endorseList.end(); eIt++)
       if (tmpProfile.get(*eIt) == profile.get(*eIt))
-        endorseCount[*eIt] += 1;
-  }
-
-  for (auto pIt = profile.begin(); pIt != profile.end(); pIt++) {
-    std::stringstream ss;
-    ss << endorseCount[pIt->first] << "/" << endorseCertCount;
-    endorseInfo->addEndorsement(pIt->first, pIt->second, ss.str());
+        info.m_endorseCount[*eIt] += 1;
   }
+}
 
-  emit contactEndorseInfoReady (*endorseInfo);
+void
+ContactManager::invalidateEndorseVerification()
+{
+  // the verdicts depend on the contacts, recount the endorsements from scratch
+  m_endorseVerificationCache.clear();
+  m_trustScopeIndex.clear();
+  for (const auto& contact : m_contactList)
+    m_trustScopeIndex.addContact(*contact);
+  for (auto& buffered : m_bufferedContacts)
+    buffered.second.m_nTalliedCerts = 0;
 }
 
 void
@@ -208,16 +241,98 @@ void
 ContactManager::onDnsCollectEndorseValidated(const Data& data,
                                              const Name& identity)
 {
+  // the contact was added or the identity changed while the collection was requested
+  if (m_bufferedContacts.find(identity) == m_bufferedContacts.end())
+    return;
+
+  const Name& dataName = data.getName();
+  if (!dataName.empty() && dataName.get(-1).isSegment() &&
+      data.getFinalBlock() && data.getFinalBlock()->isSegment()) {
+    fetchCollectEndorseSegments(data, identity);
+    return;
+  }
+
   try {
-    auto endorseCollection = std::make_shared<EndorseCollection>(data.getContent().blockFromValue());
-    m_bufferedContacts[identity].m_endorseCollection = endorseCollection;
-    fetchEndorseCertificateInternal(identity, 0);
+    onEndorseCollection(data.getContent().blockFromValue(), identity);
   }
   catch (const std::runtime_error&) {
     prepareEndorseInfo(identity);
   }
 }
 
+void
+ContactManager::fetchCollectEndorseSegments(const Data& segment, const Name& identity)
+{
+  Name prefix = segment.getName().getPrefix(-1);
+  uint64_t nSegments = segment.getFinalBlock()->toSegment() + 1;
+  uint64_t received = segment.getName().get(-1).toSegment();
+  if (nSegments > MAX_ENDORSED_SEGMENTS || received >= nSegments) {
+    prepareEndorseInfo(identity);
+    return;
+  }
+
+  auto segments = std::make_shared<std::vector<Block>>(nSegments);
+  (*segments)[received] = segment.getContent();
+
+  auto pipeline = std::make_shared<FetchPipeline>(COLLECT_ENDORSEMENT_WINDOW);
+  FetchPipeline* current = pipeline.get();
+  m_bufferedContacts[identity].m_collectEndorsePipeline = pipeline;
+  for (uint64_t i = 0; i < nSegments; i++) {
+    if (i == received)
+      continue;
+
+    Interest interest(Name(prefix).appendSegment(i));
+    interest.setCanBePrefix(false);
+
+    pipeline->add([=] (const function<void()>& done) {
+      ndn::security::DataValidationSuccessCallback onValidated =
+        [=] (const Data& data) {
+          (*segments)[i] = data.getContent();
+          done();
+        };
+      ndn::security::DataValidationFailureCallback onValidationFailed =
+        [=] (const Data&, const ndn::security::ValidationError&) { done(); };
+      TimeoutNotify timeoutNotify = [=] (const Interest&) { done(); };
+
+      sendInterest(interest, onValidated, onValidationFailed, timeoutNotify);
+    });
+  }
+
+  pipeline->start([=] {
+    // the contact info was fetched again, or dropped, while the segments were in flight
+    auto it = m_bufferedContacts.find(identity);
+    if (it == m_bufferedContacts.end() || it->second.m_collectEndorsePipeline.get() != current)
+      return;
+    it->second.m_collectEndorsePipeline.reset();
+
+    auto buffer = std::make_shared<ndn::Buffer>();
+    for (const Block& content : *segments) {
+      if (!content.hasWire()) {
+        prepareEndorseInfo(identity);
+        return;
+      }
+      buffer->insert(buffer->end(), content.value_begin(), content.value_end());
+    }
+
+    try {
+      onEndorseCollection(Block(buffer), identity);
+    }
+    catch (const std::runtime_error&) {
+      prepareEndorseInfo(identity);
+    }
+  });
+}
+
+void
+ContactManager::onEndorseCollection(const Block& collectionWire, const Name& identity)
+{
+  auto endorseCollection = std::make_shared<EndorseCollection>(collectionWire);
+  m_bufferedContacts[identity].m_endorseCollection = endorseCollection;
+  m_bufferedContacts[identity].m_endorseCertList.clear();
+  m_bufferedContacts[identity].m_nTalliedCerts = 0;
+  fetchEndorseCertificates(identity);
+}
+
 void
 ContactManager::onDnsCollectEndorseValidationFailed(const Data& data,
                                                     const ndn::security::ValidationError& error,
@@ -234,8 +349,14 @@ ContactManager::onDnsCollectEndorseTimeoutNotify(const Interest& interest, const
 
 void
 ContactManager::onEndorseCertificateInternal(const Interest&, const Data& data,
-                                             const Name& identity, size_t certIndex, string hash)
+                                             const Name& identity, const FetchPipeline* pipeline,
+                                             const string& hash)
 {
+  // the contact info was fetched again, or dropped, since this certificate was requested
+  auto it = m_bufferedContacts.find(identity);
+  if (it == m_bufferedContacts.end() || it->second.m_endorseCertPipeline.get() != pipeline)
+    return;
+
   std::ostringstream ss;
   {
     using namespace ndn::security::transform;
@@ -244,107 +365,130 @@ ContactManager::onEndorseCertificateInternal(const Interest&, const Data& data,
         >> streamSink(ss);
   }
 
-  if (ss.str() == hash) {
+  if (ss.str() != hash)
+    return;
+
+  try {
     auto endorseCertificate = std::make_shared<EndorseCertificate>(data);
     m_bufferedContacts[identity].m_endorseCertList.push_back(std::move(endorseCertificate));
+    tallyEndorseCertificates(identity);
+  }
+  catch (const std::runtime_error&) {
   }
-
-  fetchEndorseCertificateInternal(identity, certIndex+1);
-}
-
-void
-ContactManager::onEndorseCertificateInternalTimeout(const Interest& interest,
-                                                    const Name& identity,
-                                                    size_t certIndex)
-{
-  fetchEndorseCertificateInternal(identity, certIndex+1);
 }
 
 void
 ContactManager::collectEndorsement()
 {
-  {
-    boost::recursive_mutex::scoped_lock lock(m_collectCountMutex);
-    m_collectCount = m_contactList.size();
+  m_collectPipeline.reset();
+  if (m_contactList.empty())
+    return;
 
-    for (auto it = m_contactList.begin(); it != m_contactList.end(); it++) {
-      Name interestName = (*it)->getNameSpace();
-      interestName.append("DNS").append(m_identity.wireEncode()).append("ENDORSEE");
+  auto pipeline = std::make_shared<FetchPipeline>(COLLECT_ENDORSEMENT_WINDOW);
+  FetchPipeline* current = pipeline.get();
+  m_collectPipeline = pipeline;
 
-      Interest interest(interestName);
-      interest.setMustBeFresh(true);
-      interest.setCanBePrefix(true);
-      interest.setInterestLifetime(time::milliseconds(1000));
+  for (auto it = m_contactList.begin(); it != m_contactList.end(); it++) {
+    Name interestName = (*it)->getNameSpace();
+    interestName.append("DNS").append(m_identity.wireEncode()).append("ENDORSEE");
 
+    Interest interest(interestName);
+    interest.setMustBeFresh(true);
+    interest.setCanBePrefix(true);
+
+    pipeline->add([=] (const function<void()>& done) {
       ndn::security::DataValidationSuccessCallback onValidated =
-        bind(&ContactManager::onDnsEndorseeValidated, this, _1);
+        [=] (const Data& data) {
+          onDnsEndorseeValidated(data);
+          done();
+        };
       ndn::security::DataValidationFailureCallback onValidationFailed =
-        bind(&ContactManager::onDnsEndorseeValidationFailed, this, _1, _2);
-      TimeoutNotify timeoutNotify = bind(&ContactManager::onDnsEndorseeTimeoutNotify, this, _1);
+        [=] (const Data&, const ndn::security::ValidationError&) { done(); };
+      TimeoutNotify timeoutNotify = [=] (const Interest&) { done(); };
 
-      sendInterest(interest, onValidated, onValidationFailed, timeoutNotify, 0);
-    }
+      sendInterest(interest, onValidated, onValidationFailed, timeoutNotify);
+    });
   }
-}
-
-void
-ContactManager::onDnsEndorseeValidated(const Data& data)
-{
-  Data endorseData;
-  endorseData.wireDecode(data.getContent().blockFromValue());
-
-  EndorseCertificate endorseCertificate(endorseData);
-  m_contactStorage->updateCollectEndorse(endorseCertificate);
 
-  decreaseCollectStatus();
+  // the collection is published once every contact answered or timed out
+  pipeline->start([=] {
+    if (m_collectPipeline.get() != current)
+      return;
+    m_collectPipeline.reset();
+    publishCollectEndorsedDataInDNS();
+  });
 }
 
 void
-ContactManager::onDnsEndorseeValidationFailed(const Data& data,
-                                              const ndn::security::ValidationError& error)
+ContactManager::onDnsEndorseeValidated(const Data& data)
 {
-  decreaseCollectStatus();
-}
+  try {
+    Data endorseData;
+    endorseData.wireDecode(data.getContent().blockFromValue());
 
-void
-ContactManager::onDnsEndorseeTimeoutNotify(const Interest& interest)
-{
-  decreaseCollectStatus();
-}
+    EndorseCertificate endorseCertificate(endorseData);
+    std::string hash = CollectedEndorsements::computeHash(endorseCertificate.wireEncode());
+    if (!m_collectedEndorsements.set(endorseCertificate.getSigner(), endorseCertificate.getName(),
+                                     hash))
+      return;
 
-void
-ContactManager::decreaseCollectStatus()
-{
-  size_t count;
-  {
-    boost::recursive_mutex::scoped_lock lock(m_collectCountMutex);
-    m_collectCount--;
-    count = m_collectCount;
+    m_contactStorage->updateCollectEndorse(endorseCertificate);
+    invalidateCertificates();
+  }
+  catch (const std::runtime_error&) {
   }
-
-  if(count == 0)
-    publishCollectEndorsedDataInDNS();
 }
 
 void
 ContactManager::publishCollectEndorsedDataInDNS()
 {
+  // the collection is signed again only when an endorsement changed since it was published
+  if (!m_collectedEndorsements.needsPublishing())
+    return;
+
   Name dnsName = m_identity;
   dnsName.append("DNS").append("ENDORSED").appendVersion();
 
-  auto data = std::make_shared<Data>();
-  data->setName(dnsName);
-  data->setFreshnessPeriod(time::milliseconds(1000));
-
-  EndorseCollection endorseCollection;
-  m_contactStorage->getCollectEndorse(endorseCollection);
+  const Block& collection = m_collectedEndorsements.wireEncode();
+  std::map<Name, shared_ptr<Data>> segments;
+  shared_ptr<Data> first;
 
-  data->setContent(endorseCollection.wireEncode());
+  if (collection.size() <= ENDORSED_SEGMENT_SIZE) {
+    first = std::make_shared<Data>();
+    first->setName(dnsName);
+    first->setFreshnessPeriod(time::milliseconds(1000));
+    first->setContent(collection);
+    m_keyChain.sign(*first, ndn::security::signingByIdentity(m_identity));
+  }
+  else {
+    // the segments carry consecutive slices of the encoded collection
+    uint64_t nSegments = (collection.size() + ENDORSED_SEGMENT_SIZE - 1) / ENDORSED_SEGMENT_SIZE;
+    for (uint64_t i = 0; i < nSegments; i++) {
+      size_t offset = i * ENDORSED_SEGMENT_SIZE;
+      size_t length = std::min(ENDORSED_SEGMENT_SIZE, collection.size() - offset);
+
+      auto data = std::make_shared<Data>();
+      data->setName(Name(dnsName).appendSegment(i));
+      data->setFreshnessPeriod(time::milliseconds(1000));
+      data->setFinalBlock(ndn::name::Component::fromSegment(nSegments - 1));
+      data->setContent(collection.wire() + offset, length);
+      m_keyChain.sign(*data, ndn::security::signingByIdentity(m_identity));
+
+      segments[data->getName()] = data;
+      if (i == 0)
+        first = data;
+    }
+  }
 
-  m_keyChain.sign(*data, ndn::security::signingByIdentity(m_identity));
+  {
+    std::lock_guard<std::mutex> lock(m_endorsedSegmentsMutex);
+    m_endorsedSegments.swap(segments);
+  }
 
-  m_contactStorage->updateDnsOthersEndorse(*data);
-  m_face.put(*data);
+  m_contactStorage->updateDnsOthersEndorse(*first);
+  m_contentStore.erase(Name(m_identity).append("DNS"));
+  m_collectedEndorsements.markPublished();
+  m_face.put(*first);
 }
 
 void
@@ -425,6 +569,7 @@ ContactManager::publishSelfEndorseCertificateInDNS(const EndorseCertificate& sel
   m_keyChain.sign(*data, ndn::security::signingByIdentity(m_identity));
 
   m_contactStorage->updateDnsSelfProfileData(*data);
+  m_contentStore.erase(Name(m_identity).append("DNS"));
   m_face.put(*data);
 }
 
@@ -477,6 +622,7 @@ ContactManager::publishEndorseCertificateInDNS(const EndorseCertificate& endorse
   m_keyChain.sign(*data, ndn::security::signingByIdentity(m_identity));
 
   m_contactStorage->updateDnsEndorseOthers(*data, dnsName.get(-3).toUri());
+  m_contentStore.erase(Name(m_identity).append("DNS"));
   m_face.put(*data);
 }
 
@@ -487,13 +633,70 @@ ContactManager::sendInterest(const Interest& interest,
                              const TimeoutNotify& timeoutNotify,
                              int retry /* = 1 */)
 {
-  m_face.expressInterest(interest,
-                         bind(&ContactManager::onTargetData,
-                              this, _1, _2, onValidated, onValidationFailed),
-                         bind(&ContactManager::onTargetTimeout,
-                              this, _1, retry, onValidated, onValidationFailed, timeoutNotify),
-                         bind(&ContactManager::onTargetTimeout,
-                              this, _1, retry, onValidated, onValidationFailed, timeoutNotify));
+  // the panels, the dialogs and the endorsement collection may ask for the same Data at once
+  m_interestCoalescer.request(interest, onValidated, onValidationFailed, timeoutNotify,
+    [this, retry] (const Interest& toSend,
+                   const ndn::security::DataValidationSuccessCallback& fanOutValidated,
+                   const ndn::security::DataValidationFailureCallback& fanOutFailed,
+                   const TimeoutNotify& fanOutTimeout) {
+      expressInterest(toSend,
+                      bind(&ContactManager::onTargetData,
+                           this, _1, _2, fanOutValidated, fanOutFailed),
+                      fanOutTimeout,
+                      retry);
+    });
+}
+
+void
+ContactManager::expressInterest(const Interest& interest,
+                                const ndn::DataCallback& onData,
+                                const TimeoutNotify& onFailure,
+                                int retry,
+                                int nRetransmissions /* = 0 */)
+{
+  Name destination = getDestination(interest.getName());
+
+  // do not wait for the timeouts of a destination that stopped answering
+  if (nRetransmissions == 0 && m_rttTable.isDead(destination)) {
+    m_scheduler.schedule(time::milliseconds(0), [=] { onFailure(interest); });
+    return;
+  }
+
+  time::milliseconds timeout = m_rttTable.getTimeout(destination, nRetransmissions);
+  Interest toSend(interest);
+  toSend.setInterestLifetime(timeout);
+  if (nRetransmissions > 0)
+    toSend.refreshNonce();
+
+  time::steady_clock::TimePoint sendTime = time::steady_clock::now();
+
+  auto onDataReceived = [=] (const Interest&, const Data& data) {
+    // the RTT of a retransmitted Interest is ambiguous, only the first transmission is measured
+    if (nRetransmissions == 0)
+      m_rttTable.addMeasurement(destination, time::steady_clock::now() - sendTime);
+    m_rttTable.addSuccess(destination);
+    onData(interest, data);
+  };
+
+  auto onNoData = [=] {
+    if (retry > 0 && !m_rttTable.isDead(destination)) {
+      // spread the retransmissions of Interests that timed out together
+      std::uniform_int_distribution<time::milliseconds::rep> dist(0, timeout.count() / 4);
+      time::milliseconds jitter(dist(ndn::random::getRandomNumberEngine()));
+      m_scheduler.schedule(jitter, [=] {
+        expressInterest(interest, onData, onFailure, retry - 1, nRetransmissions + 1);
+      });
+    }
+    else {
+      m_rttTable.addFailure(destination);
+      onFailure(interest);
+    }
+  };
+
+  m_face.expressInterest(toSend,
+                         onDataReceived,
+                         [=] (const Interest&, const ndn::lp::Nack&) { onNoData(); },
+                         [=] (const Interest&) { onNoData(); });
 }
 
 void
@@ -505,17 +708,17 @@ ContactManager::onTargetData(const Interest& interest,
   m_validator->validate(data, onValidated, onValidationFailed);
 }
 
-void
-ContactManager::onTargetTimeout(const Interest& interest,
-                                int retry,
-                                const ndn::security::DataValidationSuccessCallback& onValidated,
-                                const ndn::security::DataValidationFailureCallback& onValidationFailed,
-                                const TimeoutNotify& timeoutNotify)
+Name
+ContactManager::getDestination(const Name& interestName)
 {
-  if (retry > 0)
-    sendInterest(interest, onValidated, onValidationFailed, timeoutNotify, retry-1);
-  else
-    timeoutNotify(interest);
+  for (size_t i = 0; i < interestName.size(); i++) {
+    const ndn::name::Component& component = interestName.get(i);
+    if (component == ndn::name::Component("DNS") ||
+        component == ndn::name::Component("KEY") ||
+        component == ndn::name::Component("PROFILE-CERT"))
+      return interestName.getPrefix(i);
+  }
+  return interestName.getPrefix(-1);
 }
 
 void
@@ -527,19 +730,31 @@ ContactManager::onDnsInterest(const Name& prefix, const Interest& interest)
   if (interestName.size() <= prefix.size())
     return;
 
-  if (interestName.size() == (prefix.size()+1)) {
-    data = m_contactStorage->getDnsData("N/A", interestName.get(prefix.size()).toUri());
-    if (static_cast<bool>(data))
-      m_face.put(*data);
-    return;
+  {
+    std::lock_guard<std::mutex> lock(m_endorsedSegmentsMutex);
+    auto it = m_endorsedSegments.find(interestName);
+    if (it != m_endorsedSegments.end())
+      data = it->second;
   }
+  if (static_cast<bool>(data))
+    return m_face.put(*data);
+
+  if (interestName.size() > (prefix.size()+2))
+    return;
 
-  if (interestName.size() == (prefix.size()+2)) {
+  shared_ptr<const Data> cached = m_contentStore.find(interestName);
+  if (static_cast<bool>(cached))
+    return m_face.put(*cached);
+
+  if (interestName.size() == (prefix.size()+1))
+    data = m_contactStorage->getDnsData("N/A", interestName.get(prefix.size()).toUri());
+  else
     data = m_contactStorage->getDnsData(interestName.get(prefix.size()).toUri(),
                                         interestName.get(prefix.size()+1).toUri());
-    if (static_cast<bool>(data))
-      m_face.put(*data);
-    return;
+
+  if (static_cast<bool>(data)) {
+    m_contentStore.insert(interestName, data);
+    m_face.put(*data);
   }
 }
 
@@ -555,22 +770,40 @@ ContactManager::onKeyInterest(const Name& prefix, const Interest& interest)
   const Name& interestName = interest.getName();
   shared_ptr<Certificate> data;
 
+  shared_ptr<const Data> cached = m_contentStore.find(interestName);
+  if (static_cast<bool>(cached))
+    return m_face.put(*cached);
+
   try {
     ndn::security::Certificate cert = m_keyChain.getPib()
                                                 .getIdentity(m_identity)
                                                 .getDefaultKey()
                                                 .getDefaultCertificate();
-    if (cert.getKeyName() == interestName)
+    // by key name, or by the full name compact invitations refer to
+    if (cert.getKeyName() == interestName || cert.getFullName() == interestName) {
+      m_contentStore.insert(interestName, std::make_shared<Certificate>(cert));
       return m_face.put(cert);
+    }
   } catch (const ndn::security::Pib::Error&) {}
 
   data = m_contactStorage->getSelfEndorseCertificate();
-  if (static_cast<bool>(data) && data->getKeyName().equals(interestName))
+  if (static_cast<bool>(data) && data->getKeyName().equals(interestName)) {
+    m_contentStore.insert(interestName, data);
     return m_face.put(*data);
+  }
 
   data = m_contactStorage->getCollectEndorseByName(interestName);
-  if (static_cast<bool>(data))
+  if (static_cast<bool>(data)) {
+    m_contentStore.insert(interestName, data);
     return m_face.put(*data);
+  }
+}
+
+void
+ContactManager::invalidateCertificates()
+{
+  m_contentStore.erase(Name(m_identity).append("KEY"));
+  m_contentStore.erase(Name(m_identity).append("PROFILE-CERT"));
 }
 
 // public slots
@@ -580,6 +813,22 @@ ContactManager::onIdentityUpdated(const QString& identity)
   m_identity = Name(identity.toStdString());
 
   m_contactStorage = std::make_shared<ContactStorage>(m_identity);
+  m_contactStorage->setOnWriteFailed([this] (const std::vector<Contact>& contacts,
+                                             const std::string& error) {
+    // called on the writer thread
+    QString msg = QString("Failure: %1 contacts could not be saved (%2)")
+                    .arg(contacts.size()).arg(QString::fromStdString(error));
+    QMetaObject::invokeMethod(this, "onContactsWriteFailed", Qt::QueuedConnection,
+                              Q_ARG(QString, msg));
+  });
+  m_contentStore.clear();
+
+  m_collectedEndorsements.clear();
+  m_contactStorage->getCollectEndorse(m_collectedEndorsements);
+  {
+    std::lock_guard<std::mutex> lock(m_endorsedSegmentsMutex);
+    m_endorsedSegments.clear();
+  }
 
   m_dnsListenerHandle = m_face.setInterestFilter(
     Name(m_identity).append("DNS"),
@@ -598,10 +847,16 @@ ContactManager::onIdentityUpdated(const QString& identity)
 
   m_contactList.clear();
   m_contactStorage->getAllContacts(m_contactList);
+  invalidateEndorseVerification();
 
   m_bufferedContacts.clear();
   onWaitForContactList();
 
+  // only the first segment of the collection is stored, the others are signed again from the
+  // stored endorsements so that the stored first segment does not point to missing ones
+  if (m_collectedEndorsements.size() > 0)
+    publishCollectEndorsedDataInDNS();
+
   collectEndorsement();
 }
 
@@ -614,7 +869,6 @@ ContactManager::onFetchContactInfo(const QString& identity)
   interestName.append(identityName).append("DNS").append("PROFILE");
 
   Interest interest(interestName);
-  interest.setInterestLifetime(time::milliseconds(1000));
   interest.setCanBePrefix(true);
   interest.setMustBeFresh(true);
 
@@ -625,7 +879,7 @@ ContactManager::onFetchContactInfo(const QString& identity)
   TimeoutNotify timeoutNotify =
     bind(&ContactManager::onDnsSelfEndorseCertTimeoutNotify, this, _1, identityName);
 
-  sendInterest(interest, onValidated, onValidationFailed, timeoutNotify, 0);
+  sendInterest(interest, onValidated, onValidationFailed, timeoutNotify);
 }
 
 void
@@ -638,11 +892,12 @@ ContactManager::onAddFetchedContact(const QString& identity)
     Contact contact(*(it->second.m_selfEndorseCert));
 
     try {
-      m_contactStorage->addContact(contact);
+      // the contact is written in the background, the list is updated without reloading it
+      m_contactStorage->queueContact(contact);
       m_bufferedContacts.erase(identityName);
 
-      m_contactList.clear();
-      m_contactStorage->getAllContacts(m_contactList);
+      m_contactList.push_back(std::make_shared<Contact>(contact));
+      invalidateEndorseVerification();
 
       onWaitForContactList();
     }
@@ -666,6 +921,7 @@ ContactManager::onUpdateProfile()
     getSignedSelfEndorseCertificate(*newProfile);
 
   m_contactStorage->addSelfEndorseCertificate(*newEndorseCertificate);
+  invalidateCertificates();
 
   publishSelfEndorseCertificateInDNS(*newEndorseCertificate);
 }
@@ -782,11 +1038,11 @@ ContactManager::onAddFetchedContactIdCert(const QString& qCertName)
   if (it != m_bufferedIdCerts.end()) {
     Contact contact(*it->second);
     try {
-      m_contactStorage->addContact(contact);
+      m_contactStorage->queueContact(contact);
       m_bufferedIdCerts.erase(certName);
 
-      m_contactList.clear();
-      m_contactStorage->getAllContacts(m_contactList);
+      m_contactList.push_back(std::make_shared<Contact>(contact));
+      invalidateEndorseVerification();
 
       onWaitForContactList();
     }
@@ -830,6 +1086,7 @@ ContactManager::onRemoveContact(const QString& identity)
   m_contactStorage->removeContact(Name(identity.toStdString()));
   m_contactList.clear();
   m_contactStorage->getAllContacts(m_contactList);
+  invalidateEndorseVerification();
 
   onWaitForContactList();
 }
@@ -848,6 +1105,10 @@ void
 ContactManager::onUpdateIsIntroducer(const QString& identity, bool isIntroducer)
 {
   m_contactStorage->updateIsIntroducer(Name(identity.toStdString()), isIntroducer);
+  // the trust scopes are loaded for introducers only
+  m_contactList.clear();
+  m_contactStorage->getAllContacts(m_contactList);
+  invalidateEndorseVerification();
 }
 
 void
@@ -864,6 +1125,29 @@ ContactManager::onUpdateEndorseCertificate(const QString& identity)
   publishEndorseCertificateInDNS(*newEndorseCertificate);
 }
 
+void
+ContactManager::onTrustScopeChanged(const QString& identity)
+{
+  // the scopes were written by the contact panel, the contacts and the trust scope index
+  // are rebuilt from the database
+  m_contactList.clear();
+  m_contactStorage->getAllContacts(m_contactList);
+  invalidateEndorseVerification();
+}
+
+// private slots
+void
+ContactManager::onContactsWriteFailed(const QString& msg)
+{
+  // the contacts that were not saved are not pending anymore
+  m_contactList.clear();
+  m_contactStorage->getAllContacts(m_contactList);
+  invalidateEndorseVerification();
+  onWaitForContactList();
+
+  emit warning(msg);
+}
+
 } // namespace chronochat
 
 
@@ -17,15 +17,23 @@
 #ifndef Q_MOC_RUN
 #include "common.hpp"
 #include "contact-storage.hpp"
+#include "collected-endorsements.hpp"
+#include "content-store.hpp"
 #include "endorse-certificate.hpp"
 #include "profile.hpp"
 #include "endorse-info.hpp"
 #include "endorse-collection.hpp"
+#include "endorse-verification-cache.hpp"
+#include "fetch-pipeline.hpp"
+#include "interest-coalescer.hpp"
+#include "rtt-table.hpp"
 #include <ndn-cxx/security/key-chain.hpp>
 #include <ndn-cxx/security/validator-config.hpp>
 #include <ndn-cxx/face.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/recursive_mutex.hpp>
+#include <mutex>
 #endif
 
 namespace chronochat {
@@ -54,6 +62,16 @@ public:
     contactList.clear();
     contactList.insert(contactList.end(), m_contactList.begin(), m_contactList.end());
   }
+
+  /**
+   * @brief get the cache in front of the DNS and key Interest handlers, e.g. for its hit rate
+   */
+  const ContentStore&
+  getContentStore() const
+  {
+    return m_contentStore;
+  }
+
 private:
   void
   initializeSecurity();
@@ -62,11 +80,17 @@ private:
   fetchCollectEndorse(const Name& identity);
 
   void
-  fetchEndorseCertificateInternal(const Name& identity, size_t certIndex);
+  fetchEndorseCertificates(const Name& identity);
 
   void
   prepareEndorseInfo(const Name& identity);
 
+  void
+  tallyEndorseCertificates(const Name& identity);
+
+  void
+  invalidateEndorseVerification();
+
   // PROFILE: self-endorse-certificate
   void
   onDnsSelfEndorseCertValidated(const Data& selfEndorseCertificate,
@@ -93,16 +117,22 @@ private:
   onDnsCollectEndorseTimeoutNotify(const Interest& interest,
                                    const Name& identity);
 
-  // PROFILE-CERT: endorse-certificate
+  /**
+   * @brief fetch the other segments of a collection published in several segments
+   *
+   * @param segment the segment received first
+   */
   void
-  onEndorseCertificateInternal(const Interest& interest, const Data& data,
-                               const Name& identity, size_t certIndex,
-                               std::string hash);
+  fetchCollectEndorseSegments(const Data& segment, const Name& identity);
+
+  void
+  onEndorseCollection(const Block& collectionWire, const Name& identity);
 
+  // PROFILE-CERT: endorse-certificate
   void
-  onEndorseCertificateInternalTimeout(const Interest& interest,
-                                      const Name& identity,
-                                      size_t certIndex);
+  onEndorseCertificateInternal(const Interest& interest, const Data& data,
+                               const Name& identity, const FetchPipeline* pipeline,
+                               const std::string& hash);
 
   // Collect endorsement
   void
@@ -111,16 +141,6 @@ private:
   void
   onDnsEndorseeValidated(const Data& data);
 
-  void
-  onDnsEndorseeValidationFailed(const Data& data,
-                                const ndn::security::ValidationError& error);
-
-  void
-  onDnsEndorseeTimeoutNotify(const Interest& interest);
-
-  void
-  decreaseCollectStatus();
-
   void
   publishCollectEndorsedDataInDNS();
 
@@ -160,18 +180,31 @@ private:
                const TimeoutNotify& timeoutNotify,
                int retry = 1);
 
+  /**
+   * @brief express @p interest with a lifetime adapted to the RTT of its destination
+   *
+   * The Interest is retransmitted up to @p retry times with an exponential backoff and some
+   * jitter. @p onFailure is called with the original Interest once all the transmissions timed
+   * out or were nacked, or right away if the destination is considered dead.
+   */
+  void
+  expressInterest(const Interest& interest,
+                  const ndn::DataCallback& onData,
+                  const TimeoutNotify& onFailure,
+                  int retry,
+                  int nRetransmissions = 0);
+
   void
   onTargetData(const Interest& interest,
                const Data& data,
                const ndn::security::DataValidationSuccessCallback& onValidated,
                const ndn::security::DataValidationFailureCallback& onValidationFailed);
 
-  void
-  onTargetTimeout(const Interest& interest,
-                  int retry,
-                  const ndn::security::DataValidationSuccessCallback& onValidated,
-                  const ndn::security::DataValidationFailureCallback& onValidationFailed,
-                  const TimeoutNotify& timeoutNotify);
+  /**
+   * @brief get the destination of an Interest, that is the identity it is sent to
+   */
+  static Name
+  getDestination(const Name& interestName);
 
   // DNS listener
   void
@@ -183,6 +216,9 @@ private:
   void
   onKeyInterest(const Name& prefix, const Interest& interest);
 
+  void
+  invalidateCertificates();
+
 signals:
   void
   contactEndorseInfoReady(const EndorseInfo& endorseInfo);
@@ -254,6 +290,13 @@ public slots:
   void
   onUpdateEndorseCertificate(const QString& identity);
 
+  void
+  onTrustScopeChanged(const QString& identity);
+
+private slots:
+  void
+  onContactsWriteFailed(const QString& msg);
+
 private:
 
   class FetchedInfo
@@ -263,6 +306,13 @@ private:
     shared_ptr<EndorseCollection> m_endorseCollection;
     std::vector<shared_ptr<EndorseCertificate> > m_endorseCertList;
     shared_ptr<EndorseInfo> m_endorseInfo;
+    // the endorsements of each profile entry among the first m_nTalliedCerts certificates
+    std::map<std::string, size_t> m_endorseCount;
+    size_t m_nTalliedCerts = 0;
+    // the fetch of the segments of the endorse collection in progress
+    shared_ptr<FetchPipeline> m_collectEndorsePipeline;
+    // the fetch of the endorse certificates in progress
+    shared_ptr<FetchPipeline> m_endorseCertPipeline;
   };
 
   typedef std::map<Name, FetchedInfo> BufferedContacts;
@@ -287,9 +337,24 @@ private:
   ndn::ScopedRegisteredPrefixHandle m_dnsListenerHandle;
   ndn::ScopedRegisteredPrefixHandle m_keyListenerHandle;
   ndn::ScopedRegisteredPrefixHandle m_profileCertListenerHandle;
-
-  RecLock m_collectCountMutex;
-  size_t m_collectCount;
+  // Data served by the DNS and key listeners
+  ContentStore m_contentStore;
+  EndorseVerificationCache m_endorseVerificationCache;
+  // the trust scopes of the introducers among the contacts
+  TrustScopeIndex m_trustScopeIndex;
+
+  // the collection of the endorsements in progress
+  shared_ptr<FetchPipeline> m_collectPipeline;
+  // the endorsements collected, and the segments of their collection when it needs several
+  CollectedEndorsements m_collectedEndorsements;
+  std::map<Name, shared_ptr<Data>> m_endorsedSegments;
+  std::mutex m_endorsedSegmentsMutex;
+
+  // the validated requests in flight, identical ones share a single Interest
+  InterestCoalescer m_interestCoalescer;
+  // RTT estimates of the identities Interests are sent to, and the retransmissions pending
+  RttTable m_rttTable;
+  ndn::Scheduler m_scheduler;
 
   RecLock m_idCertCountMutex;
   size_t m_idCertCount;
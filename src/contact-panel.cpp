@@ -304,13 +304,16 @@ ContactPanel::onDeleteScopeClicked()
   for (int i = indexList.size() - 1; i >= 0; i--)
     m_trustScopeModel->removeRow(indexList[i].row());
 
-  m_trustScopeModel->submitAll();
+  if (m_trustScopeModel->submitAll())
+    emit trustScopeChanged(m_currentSelectedContact);
 }
 
 void
 ContactPanel::onSaveScopeClicked()
 {
-  m_trustScopeModel->submitAll();
+  // the added scopes are written here only, the model is submitted manually
+  if (m_trustScopeModel->submitAll())
+    emit trustScopeChanged(m_currentSelectedContact);
 }
 
 void
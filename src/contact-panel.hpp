@@ -62,6 +62,12 @@ signals:
   void
   updateEndorseCertificate(const QString& identity);
 
+  /**
+   * @brief emitted when the trust scopes of @p identity were written to the database
+   */
+  void
+  trustScopeChanged(const QString& identity);
+
   void
   warning(const QString& msg);
 
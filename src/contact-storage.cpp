@@ -18,6 +18,8 @@
 
 #include <boost/filesystem.hpp>
 
+#include <chrono>
+
 namespace chronochat {
 
 namespace fs = boost::filesystem;
@@ -25,6 +27,10 @@ namespace fs = boost::filesystem;
 using std::string;
 using std::vector;
 
+// a batch of queued contacts is tried this many times, waiting 100 ms, 200 ms, ... in between
+static const size_t MAX_WRITE_ATTEMPTS = 4;
+static const std::chrono::milliseconds WRITE_RETRY_DELAY(100);
+
 // user's own profile;
 const string INIT_SP_TABLE =
   "CREATE TABLE IF NOT EXISTS                          "
@@ -162,8 +168,66 @@ sqlite3_column_block(sqlite3_stmt* statement, int column)
 }
 
 
+
+ContactStorage::Statement::Statement(const ContactStorage& storage, const char* sql)
+  : m_lock(storage.m_mutex)
+  , m_stmt(nullptr)
+  , m_inUse(nullptr)
+{
+  if (storage.m_isStatementCacheEnabled) {
+    CachedStatement& cached = storage.m_statements[sql];
+    if (cached.stmt == nullptr)
+      sqlite3_prepare_v2(storage.m_db, sql, -1, &cached.stmt, nullptr);
+
+    if (cached.stmt != nullptr && !cached.inUse) {
+      cached.inUse = true;
+      m_inUse = &cached.inUse;
+      m_stmt = cached.stmt;
+      return;
+    }
+  }
+
+  sqlite3_prepare_v2(storage.m_db, sql, -1, &m_stmt, nullptr);
+}
+
+ContactStorage::Statement::~Statement()
+{
+  if (m_inUse != nullptr) {
+    sqlite3_reset(m_stmt);
+    sqlite3_clear_bindings(m_stmt);
+    *m_inUse = false;
+  }
+  else
+    sqlite3_finalize(m_stmt);
+}
+
+ContactStorage::Transaction::Transaction(const ContactStorage& storage)
+  : m_lock(storage.m_mutex)
+  , m_db(storage.m_db)
+  , m_isCommitted(false)
+{
+  if (sqlite3_exec(m_db, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) != SQLITE_OK)
+    NDN_THROW(Error("Cannot begin transaction"));
+}
+
+ContactStorage::Transaction::~Transaction()
+{
+  if (!m_isCommitted)
+    sqlite3_exec(m_db, "ROLLBACK", nullptr, nullptr, nullptr);
+}
+
+void
+ContactStorage::Transaction::commit()
+{
+  if (sqlite3_exec(m_db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK)
+    NDN_THROW(Error("Cannot commit transaction"));
+  m_isCommitted = true;
+}
+
 ContactStorage::ContactStorage(const Name& identity)
   : m_identity(identity)
+  , m_isStatementCacheEnabled(true)
+  , m_isWriterStopped(false)
 {
   fs::path chronosDir = fs::path(getenv("HOME")) / ".chronos";
   fs::create_directories(chronosDir);
@@ -172,6 +236,11 @@ ContactStorage::ContactStorage(const Name& identity)
   if (res != SQLITE_OK)
     NDN_THROW(Error("chronochat DB cannot be open/created"));
 
+  // With a write-ahead log, a transaction only needs to sync the log when it is checkpointed,
+  // and readers are not blocked by the writer.
+  sqlite3_exec(m_db, "PRAGMA journal_mode=WAL", nullptr, nullptr, nullptr);
+  sqlite3_exec(m_db, "PRAGMA synchronous=NORMAL", nullptr, nullptr, nullptr);
+
   initializeTable("SelfProfile", INIT_SP_TABLE);
   initializeTable("SelfEndorse", INIT_SE_TABLE);
   initializeTable("Contact", INIT_CONTACT_TABLE);
@@ -181,6 +250,22 @@ ContactStorage::ContactStorage(const Name& identity)
   initializeTable("CollectEndorse", INIT_CE_TABLE);
   initializeTable("DnsData", INIT_DD_TABLE);
 
+  m_writer = std::thread(&ContactStorage::runWriter, this);
+}
+
+ContactStorage::~ContactStorage()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    m_isWriterStopped = true;
+  }
+  m_queueCondition.notify_one();
+  m_writer.join();
+
+  for (auto& statement : m_statements)
+    sqlite3_finalize(statement.second.stmt);
+
+  sqlite3_close(m_db);
 }
 
 string
@@ -204,21 +289,17 @@ ContactStorage::getDBName()
 void
 ContactStorage::initializeTable(const string& tableName, const string& sqlCreateStmt)
 {
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db,
-                     "SELECT name FROM sqlite_master WHERE type='table' And name=?",
-                     -1, &stmt, nullptr);
-  sqlite3_bind_string(stmt, 1, tableName, SQLITE_TRANSIENT);
-  int res = sqlite3_step(stmt);
-
   bool tableExist = false;
-  if (res == SQLITE_ROW)
-    tableExist = true;
-  sqlite3_finalize(stmt);
+  {
+    Statement stmt(*this, "SELECT name FROM sqlite_master WHERE type='table' And name=?");
+    sqlite3_bind_string(stmt, 1, tableName, SQLITE_TRANSIENT);
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+      tableExist = true;
+  }
 
   if (!tableExist) {
     char *errmsg = nullptr;
-    res = sqlite3_exec(m_db, sqlCreateStmt.c_str (), nullptr, nullptr, &errmsg);
+    int res = sqlite3_exec(m_db, sqlCreateStmt.c_str (), nullptr, nullptr, &errmsg);
     if (res != SQLITE_OK && errmsg != nullptr)
       NDN_THROW(Error("Init \"error\" in " + tableName));
   }
@@ -228,16 +309,13 @@ shared_ptr<Profile>
 ContactStorage::getSelfProfile()
 {
   auto profile = std::make_shared<Profile>(m_identity);
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db, "SELECT profile_type, profile_value FROM SelfProfile",
-                     -1, &stmt, nullptr);
+  Statement stmt(*this, "SELECT profile_type, profile_value FROM SelfProfile");
 
   while (sqlite3_step(stmt) == SQLITE_ROW) {
     string profileType = sqlite3_column_string(stmt, 0);
     string profileValue = sqlite3_column_string (stmt, 1);
     (*profile)[profileType] = profileValue;
   }
-  sqlite3_finalize(stmt);
 
   return profile;
 }
@@ -245,15 +323,11 @@ ContactStorage::getSelfProfile()
 void
 ContactStorage::addSelfEndorseCertificate(const EndorseCertificate& newEndorseCertificate)
 {
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db,
-                     "INSERT OR REPLACE INTO SelfEndorse (identity, endorse_data) values (?, ?)",
-                     -1, &stmt, nullptr);
+  Statement stmt(*this,
+                 "INSERT OR REPLACE INTO SelfEndorse (identity, endorse_data) values (?, ?)");
   sqlite3_bind_string(stmt, 1, m_identity.toUri(), SQLITE_TRANSIENT);
   sqlite3_bind_block(stmt, 2, newEndorseCertificate.wireEncode(), SQLITE_TRANSIENT);
   sqlite3_step(stmt);
-
-  sqlite3_finalize(stmt);
 }
 
 shared_ptr<EndorseCertificate>
@@ -261,10 +335,7 @@ ContactStorage::getSelfEndorseCertificate()
 {
   shared_ptr<EndorseCertificate> cert;
 
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db,
-                     "SELECT endorse_data FROM SelfEndorse where identity=?",
-                      -1, &stmt, nullptr);
+  Statement stmt(*this, "SELECT endorse_data FROM SelfEndorse where identity=?");
   sqlite3_bind_string(stmt, 1, m_identity.toUri(), SQLITE_TRANSIENT);
 
   if (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -272,8 +343,6 @@ ContactStorage::getSelfEndorseCertificate()
     cert->wireDecode(sqlite3_column_block(stmt, 0));
   }
 
-  sqlite3_finalize(stmt);
-
   return cert;
 }
 
@@ -281,16 +350,12 @@ void
 ContactStorage::addEndorseCertificate(const EndorseCertificate& endorseCertificate,
                                       const Name& identity)
 {
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db,
-                     "INSERT OR REPLACE INTO ProfileEndorse \
-                      (identity, endorse_data) values (?, ?)",
-                     -1, &stmt, nullptr);
+  Statement stmt(*this,
+                 "INSERT OR REPLACE INTO ProfileEndorse \
+                  (identity, endorse_data) values (?, ?)");
   sqlite3_bind_string(stmt, 1, identity.toUri(), SQLITE_TRANSIENT);
   sqlite3_bind_block(stmt, 2, endorseCertificate.wireEncode(), SQLITE_TRANSIENT);
   sqlite3_step(stmt);
-
-  sqlite3_finalize(stmt);
 }
 
 void
@@ -299,40 +364,28 @@ ContactStorage::updateCollectEndorse(const EndorseCertificate& endorseCertificat
   Name endorserName = endorseCertificate.getSigner();
   Name certName = endorseCertificate.getName();
 
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db,
-                     "INSERT OR REPLACE INTO CollectEndorse \
-                      (endorser, endorse_name, endorse_data) \
-                      VALUES (?, ?, ?)",
-                     -1, &stmt, nullptr);
+  Statement stmt(*this,
+                 "INSERT OR REPLACE INTO CollectEndorse \
+                  (endorser, endorse_name, endorse_data) \
+                  VALUES (?, ?, ?)");
   sqlite3_bind_string(stmt, 1, endorserName.toUri(), SQLITE_TRANSIENT);
   sqlite3_bind_string(stmt, 2, certName.toUri(), SQLITE_TRANSIENT);
   sqlite3_bind_block(stmt, 3, endorseCertificate.wireEncode(), SQLITE_TRANSIENT);
   sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
   return;
 }
 
 void
-ContactStorage::getCollectEndorse(EndorseCollection& endorseCollection)
+ContactStorage::getCollectEndorse(CollectedEndorsements& collectedEndorsements)
 {
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db, "SELECT endorse_name, endorse_data FROM CollectEndorse",
-                     -1, &stmt, nullptr);
+  Statement stmt(*this, "SELECT endorser, endorse_name, endorse_data FROM CollectEndorse");
 
   while (sqlite3_step(stmt) == SQLITE_ROW) {
-    string certName = sqlite3_column_string(stmt, 0);
-    std::ostringstream ss;
-    {
-      using namespace ndn::security::transform;
-      bufferSource(sqlite3_column_text(stmt, 1), sqlite3_column_bytes(stmt, 1))
-          >> digestFilter(ndn::DigestAlgorithm::SHA256)
-          >> streamSink(ss);
-    }
-    endorseCollection.addCollectionEntry(Name(certName), ss.str());
+    string endorser = sqlite3_column_string(stmt, 0);
+    string certName = sqlite3_column_string(stmt, 1);
+    collectedEndorsements.set(Name(endorser), Name(certName),
+                              CollectedEndorsements::computeHash(sqlite3_column_block(stmt, 2)));
   }
-
-  sqlite3_finalize(stmt);
 }
 
 shared_ptr<EndorseCertificate>
@@ -340,10 +393,8 @@ ContactStorage::getCollectEndorseByName(const Name& name)
 {
   shared_ptr<EndorseCertificate> cert;
 
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db,
-                     "SELECT endorse_name, endorse_data FROM CollectEndorse where endorse_name=?",
-                      -1, &stmt, nullptr);
+  Statement stmt(*this,
+                 "SELECT endorse_name, endorse_data FROM CollectEndorse where endorse_name=?");
   sqlite3_bind_string(stmt, 1, name.toUri(), SQLITE_TRANSIENT);
 
   if (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -351,93 +402,206 @@ ContactStorage::getCollectEndorseByName(const Name& name)
     cert->wireDecode(sqlite3_column_block(stmt, 1));
   }
 
-  sqlite3_finalize(stmt);
-
   return cert;
 }
 
 void
 ContactStorage::getEndorseList(const Name& identity, vector<string>& endorseList)
 {
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db,
-                     "SELECT profile_type FROM ContactProfile \
-                      WHERE profile_identity=? AND endorse=1 ORDER BY profile_type",
-                     -1, &stmt, nullptr);
+  Statement stmt(*this,
+                 "SELECT profile_type FROM ContactProfile \
+                  WHERE profile_identity=? AND endorse=1 ORDER BY profile_type");
   sqlite3_bind_string(stmt, 1, identity.toUri(), SQLITE_TRANSIENT);
 
   while (sqlite3_step(stmt) == SQLITE_ROW) {
     string profileType = sqlite3_column_string(stmt, 0);
     endorseList.push_back(profileType);
   }
-  sqlite3_finalize(stmt);
 }
 
 
 void
 ContactStorage::removeContact(const Name& identityName)
 {
+  flush();
+
   string identity = identityName.toUri();
+  Transaction transaction(*this);
 
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db, "DELETE FROM Contact WHERE contact_namespace=?", -1, &stmt, nullptr);
-  sqlite3_bind_string(stmt, 1, identity, SQLITE_TRANSIENT);
-  sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  {
+    Statement stmt(*this, "DELETE FROM Contact WHERE contact_namespace=?");
+    sqlite3_bind_string(stmt, 1, identity, SQLITE_TRANSIENT);
+    sqlite3_step(stmt);
+  }
 
-  sqlite3_prepare_v2(m_db, "DELETE FROM ContactProfile WHERE profile_identity=?", -1, &stmt, nullptr);
-  sqlite3_bind_string(stmt, 1, identity, SQLITE_TRANSIENT);
-  sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  {
+    Statement stmt(*this, "DELETE FROM ContactProfile WHERE profile_identity=?");
+    sqlite3_bind_string(stmt, 1, identity, SQLITE_TRANSIENT);
+    sqlite3_step(stmt);
+  }
 
-  sqlite3_prepare_v2(m_db, "DELETE FROM TrustScope WHERE contact_namespace=?", -1, &stmt, nullptr);
-  sqlite3_bind_string(stmt, 1, identity, SQLITE_TRANSIENT);
-  sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  {
+    Statement stmt(*this, "DELETE FROM TrustScope WHERE contact_namespace=?");
+    sqlite3_bind_string(stmt, 1, identity, SQLITE_TRANSIENT);
+    sqlite3_step(stmt);
+  }
+
+  transaction.commit();
 }
 
 void
 ContactStorage::addContact(const Contact& contact)
 {
+  {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    if (m_pendingContacts.count(contact.getNameSpace()) > 0)
+      NDN_THROW(Error("Normal Contact has already existed"));
+  }
+
+  Transaction transaction(*this);
   if (doesContactExist(contact.getNameSpace()))
     NDN_THROW(Error("Normal Contact has already existed"));
 
+  insertContact(contact);
+  transaction.commit();
+}
+
+size_t
+ContactStorage::addContacts(const vector<Contact>& contacts)
+{
+  size_t nAdded = 0;
+
+  Transaction transaction(*this);
+  for (const auto& contact : contacts) {
+    if (doesContactExist(contact.getNameSpace()))
+      continue;
+
+    insertContact(contact);
+    nAdded++;
+  }
+  transaction.commit();
+
+  return nAdded;
+}
+
+void
+ContactStorage::queueContact(const Contact& contact)
+{
+  if (doesContactExist(contact.getNameSpace()))
+    NDN_THROW(Error("Normal Contact has already existed"));
+
+  {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    if (m_pendingContacts.count(contact.getNameSpace()) > 0)
+      NDN_THROW(Error("Normal Contact has already existed"));
+
+    m_pendingContacts[contact.getNameSpace()] = std::make_shared<Contact>(contact);
+    m_queue.push_back(contact);
+  }
+  m_queueCondition.notify_one();
+}
+
+void
+ContactStorage::flush()
+{
+  std::unique_lock<std::mutex> lock(m_queueMutex);
+  m_flushCondition.wait(lock, [this] { return m_pendingContacts.empty(); });
+}
+
+void
+ContactStorage::setOnWriteFailed(const function<void(const vector<Contact>&,
+                                                     const string&)>& onWriteFailed)
+{
+  std::lock_guard<std::mutex> lock(m_queueMutex);
+  m_onWriteFailed = onWriteFailed;
+}
+
+void
+ContactStorage::runWriter()
+{
+  std::unique_lock<std::mutex> lock(m_queueMutex);
+  while (true) {
+    m_queueCondition.wait(lock, [this] { return m_isWriterStopped || !m_queue.empty(); });
+    if (m_queue.empty())
+      return;
+
+    vector<Contact> batch;
+    batch.swap(m_queue);
+
+    // the contacts stay pending until they are committed, so that they remain visible
+    string error;
+    std::chrono::milliseconds delay = WRITE_RETRY_DELAY;
+    for (size_t nAttempts = 1; ; nAttempts++) {
+      lock.unlock();
+      try {
+        addContacts(batch);
+        error.clear();
+      }
+      catch (const Error& e) {
+        error = e.what();
+      }
+      lock.lock();
+
+      if (error.empty() || nAttempts == MAX_WRITE_ATTEMPTS || m_isWriterStopped)
+        break;
+
+      // the database may be locked by another process for a while
+      m_queueCondition.wait_for(lock, delay, [this] { return m_isWriterStopped; });
+      delay *= 2;
+    }
+
+    for (const auto& contact : batch)
+      m_pendingContacts.erase(contact.getNameSpace());
+    m_flushCondition.notify_all();
+
+    if (!error.empty()) {
+      auto onWriteFailed = m_onWriteFailed;
+      if (onWriteFailed) {
+        lock.unlock();
+        onWriteFailed(batch, error);
+        lock.lock();
+      }
+    }
+  }
+}
+
+void
+ContactStorage::insertContact(const Contact& contact)
+{
   string identity = contact.getNameSpace().toUri();
   bool isIntroducer = contact.isIntroducer();
 
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db,
-                     "INSERT INTO Contact (contact_namespace, contact_alias, contact_keyName, \
-                      contact_key, notBefore, notAfter, is_introducer) \
-                      values (?, ?, ?, ?, ?, ?, ?)",
-                     -1, &stmt, nullptr);
-
-  sqlite3_bind_string(stmt, 1, identity, SQLITE_TRANSIENT);
-  sqlite3_bind_string(stmt, 2, contact.getAlias(), SQLITE_TRANSIENT);
-  sqlite3_bind_string(stmt, 3, contact.getPublicKeyName().toUri(), SQLITE_TRANSIENT);
-  sqlite3_bind_text(stmt, 4,
-                    reinterpret_cast<const char*>(contact.getPublicKey().data()),
-                    contact.getPublicKey().size(), SQLITE_TRANSIENT);
-  sqlite3_bind_int64(stmt, 5, time::toUnixTimestamp(contact.getNotBefore()).count());
-  sqlite3_bind_int64(stmt, 6, time::toUnixTimestamp(contact.getNotAfter()).count());
-  sqlite3_bind_int(stmt, 7, (isIntroducer ? 1 : 0));
-
-  sqlite3_step(stmt);
+  {
+    Statement stmt(*this,
+                   "INSERT INTO Contact (contact_namespace, contact_alias, contact_keyName, \
+                    contact_key, notBefore, notAfter, is_introducer) \
+                    values (?, ?, ?, ?, ?, ?, ?)");
 
-  sqlite3_finalize(stmt);
+    sqlite3_bind_string(stmt, 1, identity, SQLITE_TRANSIENT);
+    sqlite3_bind_string(stmt, 2, contact.getAlias(), SQLITE_TRANSIENT);
+    sqlite3_bind_string(stmt, 3, contact.getPublicKeyName().toUri(), SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 4,
+                      reinterpret_cast<const char*>(contact.getPublicKey().data()),
+                      contact.getPublicKey().size(), SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 5, time::toUnixTimestamp(contact.getNotBefore()).count());
+    sqlite3_bind_int64(stmt, 6, time::toUnixTimestamp(contact.getNotAfter()).count());
+    sqlite3_bind_int(stmt, 7, (isIntroducer ? 1 : 0));
+
+    if (sqlite3_step(stmt) != SQLITE_DONE)
+      NDN_THROW(Error("Cannot insert contact " + identity));
+  }
 
   const Profile& profile = contact.getProfile();
   for (auto it = profile.begin(); it != profile.end(); it++) {
-    sqlite3_prepare_v2(m_db,
-                       "INSERT INTO ContactProfile \
-                        (profile_identity, profile_type, profile_value, endorse) \
-                        values (?, ?, ?, 0)",
-                       -1, &stmt, nullptr);
+    Statement stmt(*this,
+                   "INSERT INTO ContactProfile \
+                    (profile_identity, profile_type, profile_value, endorse) \
+                    values (?, ?, ?, 0)");
     sqlite3_bind_string(stmt, 1, identity, SQLITE_TRANSIENT);
     sqlite3_bind_string(stmt, 2, it->first, SQLITE_TRANSIENT);
     sqlite3_bind_string(stmt, 3, it->second, SQLITE_TRANSIENT);
-    sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    if (sqlite3_step(stmt) != SQLITE_DONE)
+      NDN_THROW(Error("Cannot insert the profile of " + identity));
   }
 
   if (isIntroducer) {
@@ -445,13 +609,12 @@ ContactStorage::addContact(const Contact& contact)
     auto end = contact.trustScopeEnd();
 
     while (it != end) {
-      sqlite3_prepare_v2(m_db,
-                         "INSERT INTO TrustScope (contact_namespace, trust_scope) values (?, ?)",
-                         -1, &stmt, nullptr);
+      Statement stmt(*this,
+                     "INSERT INTO TrustScope (contact_namespace, trust_scope) values (?, ?)");
       sqlite3_bind_string(stmt, 1, identity, SQLITE_TRANSIENT);
       sqlite3_bind_string(stmt, 2, it->first.toUri(), SQLITE_TRANSIENT);
-      sqlite3_step(stmt);
-      sqlite3_finalize(stmt);
+      if (sqlite3_step(stmt) != SQLITE_DONE)
+        NDN_THROW(Error("Cannot insert the trust scope of " + identity));
       it++;
     }
   }
@@ -461,59 +624,62 @@ ContactStorage::addContact(const Contact& contact)
 shared_ptr<Contact>
 ContactStorage::getContact(const Name& identity) const
 {
+  {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    auto it = m_pendingContacts.find(identity);
+    if (it != m_pendingContacts.end())
+      return std::make_shared<Contact>(*it->second);
+  }
+
   shared_ptr<Contact> contact;
   Profile profile;
 
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db,
-                     "SELECT contact_alias, contact_keyName, contact_key, notBefore, notAfter, \
-                      is_introducer FROM Contact where contact_namespace=?",
-                      -1, &stmt, nullptr);
-  sqlite3_bind_string(stmt, 1, identity.toUri(), SQLITE_TRANSIENT);
-
-  if (sqlite3_step(stmt) == SQLITE_ROW) {
-    string alias = sqlite3_column_string(stmt, 0);
-    string keyName = sqlite3_column_string(stmt, 1);
-    ndn::Buffer key(sqlite3_column_text(stmt, 2), sqlite3_column_bytes (stmt, 2));
-    time::system_clock::TimePoint notBefore =
-      time::fromUnixTimestamp(time::milliseconds(sqlite3_column_int64 (stmt, 3)));
-    time::system_clock::TimePoint notAfter =
-      time::fromUnixTimestamp(time::milliseconds(sqlite3_column_int64 (stmt, 4)));
-    int isIntroducer = sqlite3_column_int (stmt, 5);
+  {
+    Statement stmt(*this,
+                   "SELECT contact_alias, contact_keyName, contact_key, notBefore, notAfter, \
+                    is_introducer FROM Contact where contact_namespace=?");
+    sqlite3_bind_string(stmt, 1, identity.toUri(), SQLITE_TRANSIENT);
 
-    contact = std::make_shared<Contact>(identity, alias, Name(keyName),
-                                        notBefore, notAfter, key, isIntroducer);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      string alias = sqlite3_column_string(stmt, 0);
+      string keyName = sqlite3_column_string(stmt, 1);
+      ndn::Buffer key(sqlite3_column_text(stmt, 2), sqlite3_column_bytes (stmt, 2));
+      time::system_clock::TimePoint notBefore =
+        time::fromUnixTimestamp(time::milliseconds(sqlite3_column_int64 (stmt, 3)));
+      time::system_clock::TimePoint notAfter =
+        time::fromUnixTimestamp(time::milliseconds(sqlite3_column_int64 (stmt, 4)));
+      int isIntroducer = sqlite3_column_int (stmt, 5);
+
+      contact = std::make_shared<Contact>(identity, alias, Name(keyName),
+                                          notBefore, notAfter, key, isIntroducer);
+    }
   }
-  sqlite3_finalize(stmt);
 
   if (!static_cast<bool>(contact))
     return contact;
 
-  sqlite3_prepare_v2(m_db,
-                     "SELECT profile_type, profile_value FROM ContactProfile \
-                      where profile_identity=?",
-                     -1, &stmt, nullptr);
-  sqlite3_bind_string(stmt, 1, identity.toUri(), SQLITE_TRANSIENT);
+  {
+    Statement stmt(*this,
+                   "SELECT profile_type, profile_value FROM ContactProfile \
+                    where profile_identity=?");
+    sqlite3_bind_string(stmt, 1, identity.toUri(), SQLITE_TRANSIENT);
 
-  while (sqlite3_step(stmt) == SQLITE_ROW) {
-    string type = sqlite3_column_string(stmt, 0);
-    string value = sqlite3_column_string(stmt, 1);
-    profile[type] = value;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      string type = sqlite3_column_string(stmt, 0);
+      string value = sqlite3_column_string(stmt, 1);
+      profile[type] = value;
+    }
   }
-  sqlite3_finalize(stmt);
   contact->setProfile(profile);
 
   if (contact->isIntroducer()) {
-    sqlite3_prepare_v2(m_db,
-                       "SELECT trust_scope FROM TrustScope WHERE contact_namespace=?",
-                       -1, &stmt, nullptr);
+    Statement stmt(*this, "SELECT trust_scope FROM TrustScope WHERE contact_namespace=?");
     sqlite3_bind_string(stmt, 1, identity.toUri(), SQLITE_TRANSIENT);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
       Name scope(sqlite3_column_string(stmt, 0));
       contact->addTrustScope(scope);
     }
-    sqlite3_finalize(stmt);
   }
 
   return contact;
@@ -523,26 +689,24 @@ ContactStorage::getContact(const Name& identity) const
 void
 ContactStorage::updateIsIntroducer(const Name& identity, bool isIntroducer)
 {
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db, "UPDATE Contact SET is_introducer=? WHERE contact_namespace=?",
-                     -1, &stmt, nullptr);
+  flush();
+
+  Statement stmt(*this, "UPDATE Contact SET is_introducer=? WHERE contact_namespace=?");
   sqlite3_bind_int(stmt, 1, (isIntroducer ? 1 : 0));
   sqlite3_bind_string(stmt, 2, identity.toUri(), SQLITE_TRANSIENT);
   sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
   return;
 }
 
 void
 ContactStorage::updateAlias(const Name& identity, const string& alias)
 {
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db, "UPDATE Contact SET contact_alias=? WHERE contact_namespace=?",
-                     -1, &stmt, nullptr);
+  flush();
+
+  Statement stmt(*this, "UPDATE Contact SET contact_alias=? WHERE contact_namespace=?");
   sqlite3_bind_string(stmt, 1, alias, SQLITE_TRANSIENT);
   sqlite3_bind_string(stmt, 2, identity.toUri(), SQLITE_TRANSIENT);
   sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
   return;
 }
 
@@ -551,9 +715,7 @@ ContactStorage::doesContactExist(const Name& name)
 {
   bool result = false;
 
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db, "SELECT count(*) FROM Contact WHERE contact_namespace=?",
-                     -1, &stmt, nullptr);
+  Statement stmt(*this, "SELECT count(*) FROM Contact WHERE contact_namespace=?");
   sqlite3_bind_string(stmt, 1, name.toUri(), SQLITE_TRANSIENT);
 
   int res = sqlite3_step(stmt);
@@ -564,27 +726,84 @@ ContactStorage::doesContactExist(const Name& name)
       result = true;
   }
 
-  sqlite3_finalize(stmt);
   return result;
 }
 
 void
 ContactStorage::getAllContacts(vector<shared_ptr<Contact> >& contacts) const
 {
-  vector<Name> contactNames;
+  // The queued contacts are taken before the scan: a contact committed in between is then
+  // found at least once.
+  vector<shared_ptr<Contact>> pendingContacts;
+  {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    for (const auto& pending : m_pendingContacts)
+      pendingContacts.push_back(std::make_shared<Contact>(*pending.second));
+  }
 
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db, "SELECT contact_namespace FROM Contact", -1, &stmt, nullptr);
+  // Instead of three queries per contact, each table is scanned once and the rows are
+  // attached to their contact through an index on the contact namespace.
+  std::lock_guard<std::recursive_mutex> lock(m_mutex);
 
-  while (sqlite3_step(stmt) == SQLITE_ROW) {
-    string identity = sqlite3_column_string(stmt, 0);
-    contactNames.push_back(Name(identity));
+  size_t offset = contacts.size();
+  std::unordered_map<string, size_t> index;
+  vector<Profile> profiles;
+
+  {
+    Statement stmt(*this,
+                   "SELECT contact_namespace, contact_alias, contact_keyName, contact_key, \
+                    notBefore, notAfter, is_introducer FROM Contact");
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      string identity = sqlite3_column_string(stmt, 0);
+      string alias = sqlite3_column_string(stmt, 1);
+      string keyName = sqlite3_column_string(stmt, 2);
+      ndn::Buffer key(sqlite3_column_text(stmt, 3), sqlite3_column_bytes (stmt, 3));
+      time::system_clock::TimePoint notBefore =
+        time::fromUnixTimestamp(time::milliseconds(sqlite3_column_int64 (stmt, 4)));
+      time::system_clock::TimePoint notAfter =
+        time::fromUnixTimestamp(time::milliseconds(sqlite3_column_int64 (stmt, 5)));
+      int isIntroducer = sqlite3_column_int (stmt, 6);
+
+      index[identity] = contacts.size();
+      contacts.push_back(std::make_shared<Contact>(Name(identity), alias, Name(keyName),
+                                                   notBefore, notAfter, key, isIntroducer));
+    }
+  }
+  profiles.resize(contacts.size() - offset);
+
+  {
+    Statement stmt(*this,
+                   "SELECT profile_identity, profile_type, profile_value FROM ContactProfile");
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      auto it = index.find(sqlite3_column_string(stmt, 0));
+      if (it == index.end())
+        continue;
+
+      string type = sqlite3_column_string(stmt, 1);
+      string value = sqlite3_column_string(stmt, 2);
+      profiles[it->second - offset][type] = value;
+    }
   }
-  sqlite3_finalize(stmt);
 
-  for (auto it = contactNames.begin(); it != contactNames.end(); it++) {
-    shared_ptr<Contact> contact = getContact(*it);
-    if (static_cast<bool>(contact))
+  for (size_t i = offset; i < contacts.size(); i++)
+    contacts[i]->setProfile(profiles[i - offset]);
+
+  {
+    Statement stmt(*this, "SELECT contact_namespace, trust_scope FROM TrustScope");
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      auto it = index.find(sqlite3_column_string(stmt, 0));
+      if (it == index.end() || !contacts[it->second]->isIntroducer())
+        continue;
+
+      contacts[it->second]->addTrustScope(Name(sqlite3_column_string(stmt, 1)));
+    }
+  }
+
+  for (const auto& contact : pendingContacts) {
+    if (index.count(contact->getNameSpace().toUri()) == 0)
       contacts.push_back(contact);
   }
 }
@@ -593,18 +812,14 @@ void
 ContactStorage::updateDnsData(const Block& data, const string& name,
                               const string& type, const string& dataName)
 {
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db,
-                     "INSERT OR REPLACE INTO DnsData (dns_name, dns_type, dns_value, data_name) \
-                      VALUES (?, ?, ?, ?)",
-                     -1, &stmt, nullptr);
+  Statement stmt(*this,
+                 "INSERT OR REPLACE INTO DnsData (dns_name, dns_type, dns_value, data_name) \
+                  VALUES (?, ?, ?, ?)");
   sqlite3_bind_string(stmt, 1, name, SQLITE_TRANSIENT);
   sqlite3_bind_string(stmt, 2, type, SQLITE_TRANSIENT);
   sqlite3_bind_block(stmt, 3, data, SQLITE_TRANSIENT);
   sqlite3_bind_string(stmt, 4, dataName, SQLITE_TRANSIENT);
   sqlite3_step(stmt);
-
-  sqlite3_finalize(stmt);
 }
 
 shared_ptr<Data>
@@ -612,15 +827,13 @@ ContactStorage::getDnsData(const Name& dataName)
 {
   shared_ptr<Data> data;
 
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db, "SELECT dns_value FROM DnsData where data_name=?", -1, &stmt, nullptr);
+  Statement stmt(*this, "SELECT dns_value FROM DnsData where data_name=?");
   sqlite3_bind_string(stmt, 1, dataName.toUri(), SQLITE_TRANSIENT);
 
   if (sqlite3_step(stmt) == SQLITE_ROW) {
     data = std::make_shared<Data>();
     data->wireDecode(sqlite3_column_block(stmt, 0));
   }
-  sqlite3_finalize(stmt);
 
   return data;
 }
@@ -630,9 +843,7 @@ ContactStorage::getDnsData(const string& name, const string& type)
 {
   shared_ptr<Data> data;
 
-  sqlite3_stmt *stmt;
-  sqlite3_prepare_v2(m_db, "SELECT dns_value FROM DnsData where dns_name=? and dns_type=?",
-                     -1, &stmt, nullptr);
+  Statement stmt(*this, "SELECT dns_value FROM DnsData where dns_name=? and dns_type=?");
   sqlite3_bind_string(stmt, 1, name, SQLITE_TRANSIENT);
   sqlite3_bind_string(stmt, 2, type, SQLITE_TRANSIENT);
 
@@ -640,7 +851,6 @@ ContactStorage::getDnsData(const string& name, const string& type)
     data = std::make_shared<Data>();
     data->wireDecode(sqlite3_column_block(stmt, 0));
   }
-  sqlite3_finalize(stmt);
 
   return data;
 }
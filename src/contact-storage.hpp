@@ -12,9 +12,14 @@
 #ifndef CHRONOCHAT_CONTACT_STORAGE_HPP
 #define CHRONOCHAT_CONTACT_STORAGE_HPP
 
+#include "collected-endorsements.hpp"
 #include "contact.hpp"
 #include "endorse-collection.hpp"
 #include <sqlite3.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace chronochat {
 
@@ -33,10 +38,7 @@ public:
 
   ContactStorage(const Name& identity);
 
-  ~ContactStorage()
-  {
-    sqlite3_close(m_db);
-  }
+  ~ContactStorage();
 
   shared_ptr<Profile>
   getSelfProfile();
@@ -54,7 +56,7 @@ public:
   updateCollectEndorse(const EndorseCertificate& endorseCertificate);
 
   void
-  getCollectEndorse(EndorseCollection& endorseCollection);
+  getCollectEndorse(CollectedEndorsements& collectedEndorsements);
 
   shared_ptr<EndorseCertificate>
   getCollectEndorseByName(const Name& name);
@@ -65,9 +67,52 @@ public:
   void
   removeContact(const Name& identity);
 
+  /**
+   * @brief add a contact
+   *
+   * @throw Error if the contact already exists
+   */
   void
   addContact(const Contact& contact);
 
+  /**
+   * @brief add contacts in a single transaction, skipping the ones that already exist
+   *
+   * @return the number of added contacts
+   */
+  size_t
+  addContacts(const std::vector<Contact>& contacts);
+
+  /**
+   * @brief queue a contact to be added by the background writer
+   *
+   * The call does not wait for the disk: the contact is visible to getContact() and
+   * getAllContacts() right away, and is written with the other queued contacts in one
+   * transaction.
+   *
+   * @throw Error if the contact already exists
+   */
+  void
+  queueContact(const Contact& contact);
+
+  /**
+   * @brief wait until the queued contacts are written
+   */
+  void
+  flush();
+
+  /**
+   * @brief set the function called when the background writer gives up on queued contacts
+   *
+   * A batch that cannot be written, e.g. because another process holds the database lock, is
+   * kept queued and retried a few times with a growing delay. After the last attempt its
+   * contacts are no longer pending, and @p onWriteFailed is called on the writer thread with
+   * them and the error.
+   */
+  void
+  setOnWriteFailed(const function<void(const std::vector<Contact>&,
+                                       const std::string&)>& onWriteFailed);
+
   shared_ptr<Contact>
   getContact(const Name& identity) const;
 
@@ -105,8 +150,72 @@ public:
   getDnsData(const std::string& name, const std::string& type);
 
 private:
-  std::string
-  getDBName();
+  /**
+   * @brief a prepared statement borrowed from the statement cache
+   *
+   * Each query is prepared once and kept by the storage; when the statement goes out of scope
+   * it is reset and its bindings are cleared, so that the next user only has to bind and step.
+   * The storage mutex is held as long as the statement is alive, which serializes the access
+   * to the database connection. A query that is already borrowed, e.g. by a method calling
+   * another one, gets a transient statement that is finalized instead.
+   */
+  class Statement
+  {
+  public:
+    Statement(const ContactStorage& storage, const char* sql);
+
+    ~Statement();
+
+    Statement(const Statement&) = delete;
+
+    Statement&
+    operator=(const Statement&) = delete;
+
+    operator sqlite3_stmt*() const
+    {
+      return m_stmt;
+    }
+
+  private:
+    std::unique_lock<std::recursive_mutex> m_lock;
+    sqlite3_stmt* m_stmt;
+    // the in-use flag of the cached statement, nullptr if the statement is transient
+    bool* m_inUse;
+  };
+
+  /**
+   * @brief an immediate transaction, rolled back unless committed
+   *
+   * The storage mutex is held for the whole transaction.
+   */
+  class Transaction
+  {
+  public:
+    explicit
+    Transaction(const ContactStorage& storage);
+
+    ~Transaction();
+
+    Transaction(const Transaction&) = delete;
+
+    Transaction&
+    operator=(const Transaction&) = delete;
+
+    void
+    commit();
+
+  private:
+    std::unique_lock<std::recursive_mutex> m_lock;
+    sqlite3* m_db;
+    bool m_isCommitted;
+  };
+
+  class CachedStatement
+  {
+  public:
+    sqlite3_stmt* stmt = nullptr;
+    bool inUse = false;
+  };
 
   void
   initializeTable(const std::string& tableName, const std::string& sqlCreateStmt);
@@ -114,6 +223,12 @@ private:
   bool
   doesContactExist(const Name& name);
 
+  void
+  insertContact(const Contact& contact);
+
+  void
+  runWriter();
+
   void
   updateDnsData(const Block& data,
                 const std::string& name,
@@ -124,6 +239,29 @@ private:
   Name m_identity;
 
   sqlite3 *m_db;
+
+  mutable std::recursive_mutex m_mutex;
+  // prepared statements indexed by their SQL text
+  mutable std::unordered_map<std::string, CachedStatement> m_statements;
+
+CHRONOCHAT_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  std::string
+  getDBName();
+
+  // when disabled, every query is prepared and finalized as before
+  bool m_isStatementCacheEnabled;
+
+private:
+  // the write-behind queue, guarded by m_queueMutex
+  mutable std::mutex m_queueMutex;
+  std::condition_variable m_queueCondition;
+  std::condition_variable m_flushCondition;
+  std::vector<Contact> m_queue;
+  // the queued contacts that are not written yet, indexed by their namespace
+  std::map<Name, shared_ptr<Contact>> m_pendingContacts;
+  bool m_isWriterStopped;
+  function<void(const std::vector<Contact>&, const std::string&)> m_onWriteFailed;
+  std::thread m_writer;
 };
 
 } // namespace chronochat
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "content-store.hpp"
+
+namespace chronochat {
+
+ContentStore::ContentStore(size_t capacity, time::nanoseconds maxLifetime)
+  : m_capacity(capacity)
+  , m_maxLifetime(maxLifetime)
+  , m_nHits(0)
+  , m_nMisses(0)
+{
+}
+
+shared_ptr<const Data>
+ContentStore::find(const Name& name)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_index.find(name);
+  if (it == m_index.end()) {
+    m_nMisses++;
+    return nullptr;
+  }
+
+  if (it->second->expiry <= time::steady_clock::now()) {
+    m_queue.erase(it->second);
+    m_index.erase(it);
+    m_nMisses++;
+    return nullptr;
+  }
+
+  m_queue.splice(m_queue.begin(), m_queue, it->second);
+  m_nHits++;
+  return it->second->data;
+}
+
+void
+ContentStore::insert(const Name& name, shared_ptr<const Data> data)
+{
+  time::nanoseconds lifetime = m_maxLifetime;
+  if (data->getFreshnessPeriod() > time::milliseconds::zero())
+    lifetime = std::min<time::nanoseconds>(lifetime, data->getFreshnessPeriod());
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (m_capacity == 0)
+    return;
+
+  auto it = m_index.find(name);
+  if (it != m_index.end()) {
+    m_queue.erase(it->second);
+    m_index.erase(it);
+  }
+
+  m_queue.push_front(Entry{name, std::move(data), time::steady_clock::now() + lifetime});
+  m_index[name] = m_queue.begin();
+
+  if (m_queue.size() > m_capacity) {
+    m_index.erase(m_queue.back().name);
+    m_queue.pop_back();
+  }
+}
+
+void
+ContentStore::erase(const Name& prefix)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_index.lower_bound(prefix);
+  while (it != m_index.end() && prefix.isPrefixOf(it->first)) {
+    m_queue.erase(it->second);
+    it = m_index.erase(it);
+  }
+}
+
+void
+ContentStore::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_queue.clear();
+  m_index.clear();
+}
+
+size_t
+ContentStore::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_queue.size();
+}
+
+uint64_t
+ContentStore::getNHits() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nHits;
+}
+
+uint64_t
+ContentStore::getNMisses() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nMisses;
+}
+
+double
+ContentStore::getHitRate() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  uint64_t nLookups = m_nHits + m_nMisses;
+  if (nLookups == 0)
+    return 0.0;
+  return static_cast<double>(m_nHits) / nLookups;
+}
+
+} // namespace chronochat
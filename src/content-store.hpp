@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_CONTENT_STORE_HPP
+#define CHRONOCHAT_CONTENT_STORE_HPP
+
+#include "common.hpp"
+#include <mutex>
+
+namespace chronochat {
+
+/**
+ * @brief an in-memory LRU cache of the data served by the producer handlers
+ *
+ * Entries are indexed by the name of the Interest they answered. An entry is served until its
+ * FreshnessPeriod runs out, bounded by a maximum lifetime, after which the handler goes back to
+ * the storage; writes to the storage are expected to erase the entries they affect.
+ *
+ * The store is safe to use from several threads.
+ */
+class ContentStore
+{
+public:
+  /**
+   * @param capacity the maximum number of entries, the least recently used one is evicted first
+   * @param maxLifetime the longest time an entry is served, also used for data without
+   *                    FreshnessPeriod
+   */
+  ContentStore(size_t capacity, time::nanoseconds maxLifetime);
+
+  /**
+   * @brief find the data that answered @p name, nullptr if none or if it is no longer fresh
+   */
+  shared_ptr<const Data>
+  find(const Name& name);
+
+  void
+  insert(const Name& name, shared_ptr<const Data> data);
+
+  /**
+   * @brief erase the entries under @p prefix
+   */
+  void
+  erase(const Name& prefix);
+
+  void
+  clear();
+
+  size_t
+  size() const;
+
+  uint64_t
+  getNHits() const;
+
+  uint64_t
+  getNMisses() const;
+
+  /**
+   * @return the ratio of the lookups that were served from the store
+   */
+  double
+  getHitRate() const;
+
+private:
+  class Entry
+  {
+  public:
+    Name name;
+    shared_ptr<const Data> data;
+    time::steady_clock::TimePoint expiry;
+  };
+
+  typedef std::list<Entry> Queue;
+
+  size_t m_capacity;
+  time::nanoseconds m_maxLifetime;
+
+  // most recently used first
+  Queue m_queue;
+  std::map<Name, Queue::iterator> m_index;
+
+  uint64_t m_nHits;
+  uint64_t m_nMisses;
+
+  mutable std::mutex m_mutex;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_CONTENT_STORE_HPP
@@ -18,6 +18,7 @@
 #include <ndn-cxx/util/segment-fetcher.hpp>
 #include <ndn-cxx/security/signing-helpers.hpp>
 #include <ndn-cxx/security/certificate-fetcher-offline.hpp>
+#include <ndn-cxx/security/verification-helpers.hpp>
 
 #include "invitation.hpp"
 #endif
@@ -31,13 +32,14 @@ using ndn::Face;
 static const ndn::Name::Component ROUTING_HINT_SEPARATOR =
   ndn::name::Component::fromEscapedString("%F0%2E");
 static const int MAXIMUM_REQUEST = 3;
-static const int CONNECTION_RETRY_TIMER = 3;
-
 ControllerBackend::ControllerBackend(QObject* parent)
   : QThread(parent)
+  , m_isNfdConnected(true)
   , m_shouldResume(false)
   , m_face(nullptr, m_keyChain)
   , m_contactManager(m_face, m_keyChain)
+  , m_chatroomCredentials(m_keyChain)
+  , m_invitationSender(m_face, m_keyChain, getInvitationRoutingPrefix())
 {
   // connection to contact manager
   connect(this, SIGNAL(identityUpdated(const QString&)),
@@ -45,8 +47,6 @@ ControllerBackend::ControllerBackend(QObject* parent)
 
   connect(&m_contactManager, SIGNAL(contactIdListReady(const QStringList&)),
           this, SLOT(onContactIdListReady(const QStringList&)));
-
-  m_validator = std::make_shared<ndn::security::ValidatorNull>();
 }
 
 ControllerBackend::~ControllerBackend() = default;
@@ -70,18 +70,10 @@ ControllerBackend::run()
         std::lock_guard<std::mutex>lock(m_resumeMutex);
         m_shouldResume = true;
       }
-#ifdef BOOST_THREAD_USES_CHRONO
-      time::seconds reconnectTimer = time::seconds(CONNECTION_RETRY_TIMER);
-#else
-      boost::posix_time::time_duration reconnectTimer;
-      reconnectTimer = boost::posix_time::seconds(CONNECTION_RETRY_TIMER);
-#endif
-      while (!m_isNfdConnected) {
-#ifdef BOOST_THREAD_USES_CHRONO
-        boost::this_thread::sleep_for(reconnectTimer);
-#else
-        boost::this_thread::sleep(reconnectTimer);
-#endif
+      {
+        // woken up by onNfdReconnect, as soon as the forwarder is back
+        std::unique_lock<std::mutex> lock(m_nfdConnectionMutex);
+        m_nfdConnectionCondition.wait(lock, [this] { return m_isNfdConnected; });
       }
     }
     {
@@ -128,15 +120,18 @@ ControllerBackend::setInvitationListener()
 
   Name invitationPrefix;
   Name requestPrefix;
+  Name groupKeyPrefix;
   Name routingPrefix = getInvitationRoutingPrefix();
   size_t offset = 0;
   if (!routingPrefix.isPrefixOf(m_identity)) {
     invitationPrefix.append(routingPrefix).append(ROUTING_HINT_SEPARATOR);
     requestPrefix.append(routingPrefix).append(ROUTING_HINT_SEPARATOR);
+    groupKeyPrefix.append(routingPrefix).append(ROUTING_HINT_SEPARATOR);
     offset = routingPrefix.size() + 1;
   }
   invitationPrefix.append(m_identity).append("CHRONOCHAT-INVITATION");
   requestPrefix.append(m_identity).append("CHRONOCHAT-INVITATION-REQUEST");
+  groupKeyPrefix.append(m_identity).append("CHRONOCHAT-GROUP-KEY");
 
   m_invitationListenerHandle = m_face.setInterestFilter(invitationPrefix,
     bind(&ControllerBackend::onInvitationInterest, this, _1, _2, offset),
@@ -145,6 +140,21 @@ ControllerBackend::setInvitationListener()
   m_requestListenerHandle = m_face.setInterestFilter(requestPrefix,
     bind(&ControllerBackend::onInvitationRequestInterest, this, _1, _2, offset),
     [] (const Name& prefix, const std::string& failInfo) {});
+
+  m_groupKeyListenerHandle = m_face.setInterestFilter(groupKeyPrefix,
+    bind(&ControllerBackend::onGroupKeyInterest, this, _1, _2),
+    [] (const Name& prefix, const std::string& failInfo) {});
+
+  // without the routing prefix, the contact manager answers for the certificate
+  if (offset > 0) {
+    Name certificatePrefix(routingPrefix);
+    certificatePrefix.append(ROUTING_HINT_SEPARATOR).append(m_identity).append("KEY");
+    m_certificateListenerHandle = m_face.setInterestFilter(certificatePrefix,
+      bind(&ControllerBackend::onCertificateInterest, this, _1, _2, offset),
+      [] (const Name& prefix, const std::string& failInfo) {});
+  }
+  else
+    m_certificateListenerHandle.cancel();
 }
 
 ndn::Name
@@ -162,9 +172,14 @@ ControllerBackend::onInvitationInterest(const ndn::Name& prefix,
   auto invitationInterest = std::make_shared<Interest>(interest.getName().getSubName(routingPrefixOffset));
 
   // check if the chatroom already exists;
+  shared_ptr<Invitation> invitation;
   try {
-      Invitation invitation(invitationInterest->getName());
-      if (m_chatDialogList.contains(QString::fromStdString(invitation.getChatroom())))
+      invitation = std::make_shared<Invitation>(invitationInterest->getName());
+      if (m_chatDialogList.contains(QString::fromStdString(invitation->getChatroom())))
+        return;
+      // retransmissions, replays and floods are dropped before the validation
+      if (m_invitationReplays.check(invitationInterest->getName(), *invitation) !=
+          InvitationReplayCache::PROCESS)
         return;
   }
   catch (const Invitation::Error& e) {
@@ -172,10 +187,127 @@ ControllerBackend::onInvitationInterest(const ndn::Name& prefix,
     return;
   }
 
-  m_validator->validate(
+  // a compact invitation only refers to the certificate of the inviter
+  if (!invitation->hasInviterCertificate()) {
+    Name certificateName = invitation->getInviterCertificateName();
+    shared_ptr<const Data> certificate = m_inviterCertificates.find(Interest(certificateName));
+    if (certificate == nullptr) {
+      fetchInviterCertificate(invitationInterest, certificateName, 0);
+      return;
+    }
+    invitation->setInviterCertificate(ndn::security::Certificate(*certificate));
+  }
+
+  validateInvitation(invitationInterest, *invitation);
+}
+
+void
+ControllerBackend::fetchInviterCertificate(const shared_ptr<Interest>& invitationInterest,
+                                           const Name& certificateName, int resendTimes)
+{
+  // <routing_prefix>/%F0./<certificate_name>, answered with the certificate wrapped
+  Name routingPrefix = getInvitationRoutingPrefix();
+  Name interestName;
+  if (!routingPrefix.isPrefixOf(certificateName))
+    interestName.append(routingPrefix).append(ROUTING_HINT_SEPARATOR);
+  interestName.append(certificateName);
+
+  bool isWrapped = interestName != certificateName;
+
+  Interest interest(interestName);
+  interest.setCanBePrefix(false);
+  interest.setInterestLifetime(time::milliseconds(4000));
+
+  m_face.expressInterest(interest,
+    [this, invitationInterest, isWrapped] (const Interest&, const Data& data) {
+      Invitation invitation(invitationInterest->getName());
+      try {
+        if (isWrapped)
+          invitation.setInviterCertificate(
+            ndn::security::Certificate(data.getContent().blockFromValue()));
+        else
+          invitation.setInviterCertificate(ndn::security::Certificate(data));
+      }
+      catch (const tlv::Error&) {
+        m_invitationReplays.setVerdict(invitationInterest->getName(), invitation, false);
+        return;
+      }
+      catch (const Invitation::Error&) {
+        m_invitationReplays.setVerdict(invitationInterest->getName(), invitation, false);
+        return;
+      }
+      m_inviterCertificates.insert(invitation.getInviterCertificate());
+      validateInvitation(invitationInterest, invitation);
+    },
+    [this, invitationInterest] (const Interest&, const ndn::lp::Nack&) {
+      onInviterCertificateUnavailable(*invitationInterest);
+    },
+    [this, invitationInterest, certificateName, resendTimes] (const Interest&) {
+      if (resendTimes < MAXIMUM_REQUEST)
+        fetchInviterCertificate(invitationInterest, certificateName, resendTimes + 1);
+      else
+        onInviterCertificateUnavailable(*invitationInterest);
+    });
+}
+
+void
+ControllerBackend::onInviterCertificateUnavailable(const Interest& invitationInterest)
+{
+  // a retransmission of the invitation tries again
+  m_invitationReplays.erase(invitationInterest.getName());
+
+  Invitation invitation(invitationInterest.getName());
+  emit warning(QString::fromStdString("Cannot get the certificate " +
+                                      invitation.getInviterCertificateName().toUri() +
+                                      " of the invitation to " + invitation.getChatroom() +
+                                      ", the invitation is ignored until it is sent again"));
+}
+
+void
+ControllerBackend::validateInvitation(const shared_ptr<Interest>& invitationInterest,
+                                      const Invitation& invitation)
+{
+  // the invitation must be signed with the certificate it carries or refers to
+  const ndn::security::Certificate& certificate = invitation.getInviterCertificate();
+  if (!certificate.isValid()) {
+    onInvitationValidationFailed(*invitationInterest,
+                                 {ndn::security::ValidationError::EXPIRED_CERT,
+                                  certificate.getName().toUri()});
+    return;
+  }
+
+  shared_ptr<ndn::security::Validator> validator =
+    AnchorValidationPolicy::makeValidator(certificate);
+  validator->validate(
     *invitationInterest,
-    bind(&ControllerBackend::onInvitationValidated, this, _1),
-    bind(&ControllerBackend::onInvitationValidationFailed, this, _1, _2));
+    [this, validator] (const Interest& interest) { onInvitationValidated(interest); },
+    [this, validator] (const Interest& interest, const ndn::security::ValidationError& error) {
+      onInvitationValidationFailed(interest, error);
+    });
+}
+
+void
+ControllerBackend::onCertificateInterest(const ndn::Name& prefix, const ndn::Interest& interest,
+                                         size_t routingPrefixOffset)
+{
+  Name certificateName = interest.getName().getSubName(routingPrefixOffset);
+  ndn::security::Certificate certificate;
+  try {
+    certificate = m_keyChain.getPib().getIdentity(m_identity).getDefaultKey()
+                                                          .getDefaultCertificate();
+  }
+  catch (const ndn::security::Pib::Error&) {
+    return;
+  }
+  if (certificate.getFullName() != certificateName && certificate.getName() != certificateName)
+    return;
+
+  Data wrappedData(interest.getName());
+  wrappedData.setContent(certificate.wireEncode());
+  wrappedData.setFreshnessPeriod(time::milliseconds(1000));
+  // the certificate inside is signed already, a digest is enough for the wrapper
+  m_keyChain.sign(wrappedData, ndn::security::signingWithSha256());
+  m_face.put(wrappedData);
 }
 
 void
@@ -211,8 +343,19 @@ void
 ControllerBackend::onInvitationValidated(const Interest& interest)
 {
   Invitation invitation(interest.getName());
+  bool isWithinRate = m_invitationReplays.setVerdict(interest.getName(), invitation, true);
+
+  // later compact invitations of the inviter find the certificate carried by this one
+  if (!invitation.isCompact())
+    m_inviterCertificates.insert(invitation.getInviterCertificate());
+
+  // the inviter sends more invitations than are shown
+  if (!isWithinRate)
+    return;
+
   // Should be obtained via a method of ContactManager.
-  string alias = invitation.getInviterCertificate().getKeyName().getPrefix(-1).toUri();
+  string alias = ndn::security::extractKeyNameFromCertName(
+    invitation.getInviterCertificateName().getPrefix(-1)).getPrefix(-1).toUri();
 
   emit invitationValidated(QString::fromStdString(alias),
                            QString::fromStdString(invitation.getChatroom()),
@@ -223,6 +366,8 @@ void
 ControllerBackend::onInvitationValidationFailed(const Interest& interest,
                                                 const ndn::security::ValidationError& failureInfo)
 {
+  // the retransmissions of the invitation fail without being validated again
+  m_invitationReplays.setVerdict(interest.getName(), Invitation(interest.getName()), false);
 }
 
 void
@@ -290,6 +435,7 @@ ControllerBackend::onRequestResponse(const Interest& interest, const Data& data)
     return;
 
   // if data is true,
+  // the group key is not handed out on a request, the requester is not authenticated
   if (res == 1)
     emit startChatroom(QString::fromStdString(chatroomName.toUri()), false);
   else
@@ -308,6 +454,143 @@ ControllerBackend::onRequestTimeout(const Interest& interest, int& resendTimes)
     emit invitationRequestResult("Invitation request times out.");
 }
 
+void
+ControllerBackend::grantGroupKey(const std::string& chatroom, const Name& identity,
+                                 const ndn::Buffer& publicKey)
+{
+  std::lock_guard<std::mutex> lock(m_groupKeyGrantsMutex);
+  m_groupKeyGrants[{chatroom, identity}] = publicKey;
+}
+
+void
+ControllerBackend::onGroupKeyInterest(const ndn::Name& prefix, const ndn::Interest& interest)
+{
+  // /<routing_prefix>/%F0./<identity>/CHRONOCHAT-GROUP-KEY/<chatroom>/<requester_identity>/
+  //   <transport_key>/<signature_info>/<signature_value>
+  Name interestName = interest.getName();
+  size_t i;
+  for (i = 0; i < interestName.size(); i++)
+    if (interestName.at(i) == Name::Component("CHRONOCHAT-GROUP-KEY"))
+      break;
+  if (i + 5 >= interestName.size())
+    return;
+
+  string chatroom = interestName.at(i+1).toUri();
+  Name requester = interestName.getSubName(i+2).getPrefix(-3);
+  const Name::Component& transportKey = interestName.at(-3);
+  ndn::Buffer requesterKey;
+  {
+    std::lock_guard<std::mutex> lock(m_groupKeyGrantsMutex);
+    auto grant = m_groupKeyGrants.find({chatroom, requester});
+    if (grant == m_groupKeyGrants.end())
+      return;
+    requesterKey = grant->second;
+  }
+
+  // the signature binds the transport key to the member we let in
+  if (!ndn::security::verifySignature(interest, requesterKey.data(), requesterKey.size()))
+    return;
+
+  shared_ptr<const GroupKey> key = m_groupKeys.find(chatroom);
+  if (key == nullptr)
+    return;
+
+  Data response(interestName);
+  try {
+    response.setContent(key->wireEncodeEncrypted(transportKey.value(),
+                                                 transportKey.value_size()));
+  }
+  catch (const GroupKey::Error& e) {
+    emit warning(QString::fromStdString("Cannot hand out the group key of " + chatroom + ": " +
+                                        e.what()));
+    return;
+  }
+  response.setFreshnessPeriod(time::milliseconds(1000));
+  m_keyChain.sign(response, m_chatroomCredentials.get(chatroom, m_identity)->signingInfo);
+  m_face.put(response);
+}
+
+void
+ControllerBackend::fetchGroupKey(const std::string& chatroom,
+                                 const ndn::security::Certificate& memberCertificate)
+{
+  // the identity keys may not encrypt, the secret is encrypted to a key used for this request
+  shared_ptr<ndn::security::transform::PrivateKey> transportKey =
+    ndn::security::transform::generatePrivateKey(ndn::RsaKeyParams());
+
+  Name memberIdentity = ndn::security::extractIdentityFromCertName(memberCertificate.getName());
+  Name interestName = getInvitationRoutingPrefix();
+  interestName.append(ROUTING_HINT_SEPARATOR).append(memberIdentity);
+  interestName.append("CHRONOCHAT-GROUP-KEY");
+  interestName.append(Name::Component::fromEscapedString(chatroom));
+  interestName.append(m_identity);
+  interestName.append(Name::Component(*transportKey->derivePublicKey()));
+  Interest interest(interestName);
+  interest.setInterestLifetime(time::milliseconds(10000));
+  interest.setMustBeFresh(true);
+  m_keyChain.sign(interest, m_chatroomCredentials.get(chatroom, m_identity)->signingInfo);
+
+  m_face.expressInterest(interest,
+                         bind(&ControllerBackend::onGroupKeyData, this, _2, chatroom,
+                              memberCertificate, transportKey),
+                         bind(&ControllerBackend::onGroupKeyTimeout, this, _1, chatroom,
+                              memberCertificate, transportKey, 0),
+                         bind(&ControllerBackend::onGroupKeyTimeout, this, _1, chatroom,
+                              memberCertificate, transportKey, 0));
+}
+
+void
+ControllerBackend::onGroupKeyData(const Data& data, const std::string& chatroom,
+                                  const ndn::security::Certificate& memberCertificate,
+                                  const shared_ptr<ndn::security::transform::PrivateKey>&
+                                    transportKey)
+{
+  // only the member who let us in may hand us the key
+  shared_ptr<ndn::security::Validator> validator =
+    AnchorValidationPolicy::makeValidator(memberCertificate);
+  validator->validate(data,
+    [this, validator, chatroom, transportKey] (const Data& validated) {
+      try {
+        m_groupKeys.insert(chatroom,
+                           std::make_shared<GroupKey>(validated.getContent().blockFromValue(),
+                                                      *transportKey));
+      }
+      catch (const tlv::Error&) {
+        return;
+      }
+      catch (const GroupKey::Error&) {
+        return;
+      }
+      emit groupKeyReceived(QString::fromStdString(chatroom));
+    },
+    [this, validator, chatroom] (const Data& failed,
+                                 const ndn::security::ValidationError& error) {
+      emit warning(QString::fromStdString("The group key of " + chatroom + " is rejected: " +
+                                          error.getInfo()));
+    });
+}
+
+void
+ControllerBackend::onGroupKeyTimeout(const Interest& interest, const std::string& chatroom,
+                                     const ndn::security::Certificate& memberCertificate,
+                                     const shared_ptr<ndn::security::transform::PrivateKey>&
+                                       transportKey,
+                                     int resendTimes)
+{
+  // without the key, the chat data signed with it are shown as unverified
+  if (resendTimes < MAXIMUM_REQUEST) {
+    Interest retransmission(interest);
+    retransmission.refreshNonce();
+    m_face.expressInterest(retransmission,
+                           bind(&ControllerBackend::onGroupKeyData, this, _2, chatroom,
+                                memberCertificate, transportKey),
+                           bind(&ControllerBackend::onGroupKeyTimeout, this, _1, chatroom,
+                                memberCertificate, transportKey, resendTimes + 1),
+                           bind(&ControllerBackend::onGroupKeyTimeout, this, _1, chatroom,
+                                memberCertificate, transportKey, resendTimes + 1));
+  }
+}
+
 // public slots:
 void
 ControllerBackend::shutdown()
@@ -321,6 +604,7 @@ ControllerBackend::shutdown()
     std::lock_guard<std::mutex>lock(m_nfdConnectionMutex);
     m_isNfdConnected = true;
   }
+  m_nfdConnectionCondition.notify_all();
   m_face.getIoService().stop();
 }
 
@@ -354,23 +638,59 @@ void
 ControllerBackend::onIdentityChanged(const QString& identity)
 {
   m_chatDialogList.clear();
+  m_groupKeys.clear();
+
+  Name identityName(identity.toStdString());
 
-  m_identity = Name(identity.toStdString());
+  std::cerr << "ControllerBackend::onIdentityChanged: " << identityName << std::endl;
 
-  std::cerr << "ControllerBackend::onIdentityChanged: " << m_identity << std::endl;
+  bool isNfdConnected;
+  {
+    std::lock_guard<std::mutex>lock(m_nfdConnectionMutex);
+    isNfdConnected = m_isNfdConnected;
+  }
+  // the identity and the KeyChain are used on the thread of the face only; without NFD, the
+  // face thread is waiting for the reconnection, which is signaled from this thread
+  if (isNfdConnected)
+    m_face.getIoService().post([this, identityName, identity] {
+      updateIdentity(identityName, identity);
+    });
+  else
+    updateIdentity(identityName, identity);
+}
+
+void
+ControllerBackend::updateIdentity(const Name& identity, const QString& identityUri)
+{
+  m_chatroomCredentials.clear();
+  {
+    std::lock_guard<std::mutex> lock(m_groupKeyGrantsMutex);
+    m_groupKeyGrants.clear();
+  }
 
+  m_identity = identity;
   m_keyChain.createIdentity(m_identity);
 
   setInvitationListener();
 
-  emit identityUpdated(identity);
+  emit identityUpdated(identityUri);
 }
 
 void
 ControllerBackend::onInvitationResponded(const ndn::Name& invitationName, bool accepted)
 {
+  m_face.getIoService().post([this, invitationName, accepted] {
+    respondToInvitation(invitationName, accepted);
+  });
+}
+
+void
+ControllerBackend::respondToInvitation(const Name& invitationName, bool accepted)
+{
+  Invitation invitation(invitationName);
   auto response = std::make_shared<Data>();
-  shared_ptr<ndn::security::Certificate> chatroomCert;
+  shared_ptr<const ChatroomCredentials::Credential> credential =
+    m_chatroomCredentials.get(invitation.getChatroom(), m_identity);
 
   // generate reply;
   if (accepted) {
@@ -378,13 +698,7 @@ ControllerBackend::onInvitationResponded(const ndn::Name& invitationName, bool a
     responseName.append(m_localPrefix.wireEncode());
 
     response->setName(responseName);
-
-    // We should create a particular certificate for this chatroom,
-    //but let's use default one for now.
-    chatroomCert = std::make_shared<ndn::security::Certificate>(
-      m_keyChain.createIdentity(m_identity).getDefaultKey().getDefaultCertificate());
-
-    response->setContent(chatroomCert->wireEncode());
+    response->setContent(credential->certificateWire);
     response->setFreshnessPeriod(time::milliseconds(1000));
   }
   else {
@@ -392,7 +706,7 @@ ControllerBackend::onInvitationResponded(const ndn::Name& invitationName, bool a
     response->setFreshnessPeriod(time::milliseconds(1000));
   }
 
-  m_keyChain.sign(*response, ndn::security::signingByIdentity(m_identity));
+  m_keyChain.sign(*response, credential->signingInfo);
 
   // Check if we need a wrapper
   Name invitationRoutingPrefix = getInvitationRoutingPrefix();
@@ -408,17 +722,36 @@ ControllerBackend::onInvitationResponded(const ndn::Name& invitationName, bool a
     wrappedData->setContent(response->wireEncode());
     wrappedData->setFreshnessPeriod(time::milliseconds(1000));
 
-    m_keyChain.sign(*wrappedData, ndn::security::signingByIdentity(m_identity));
+    // the response inside is signed already, a digest is enough for the wrapper
+    m_keyChain.sign(*wrappedData, ndn::security::signingWithSha256());
     m_face.put(*wrappedData);
   }
 
-  Invitation invitation(invitationName);
   emit startChatroomOnInvitation(invitation, true);
+
+  if (!accepted)
+    return;
+  if (!invitation.isCompact()) {
+    fetchGroupKey(invitation.getChatroom(), invitation.getInviterCertificate());
+    return;
+  }
+  shared_ptr<const Data> certificate =
+    m_inviterCertificates.find(Interest(invitation.getInviterCertificateName()));
+  if (certificate != nullptr)
+    fetchGroupKey(invitation.getChatroom(), ndn::security::Certificate(*certificate));
 }
 
 void
 ControllerBackend::onInvitationRequestResponded(const ndn::Name& invitationResponseName,
                                                 bool accepted)
+{
+  m_face.getIoService().post([this, invitationResponseName, accepted] {
+    respondToInvitationRequest(invitationResponseName, accepted);
+  });
+}
+
+void
+ControllerBackend::respondToInvitationRequest(const Name& invitationResponseName, bool accepted)
 {
   auto response = std::make_shared<Data>(invitationResponseName);
   if (accepted)
@@ -437,10 +770,21 @@ ControllerBackend::onSendInvitationRequest(const QString& chatroomName, const QS
 {
   if (prefix.length() == 0)
     return;
+  std::string chatroom = chatroomName.toStdString();
+  std::string memberPrefix = prefix.toStdString();
+  m_face.getIoService().post([this, chatroom, memberPrefix] {
+    sendInvitationRequest(chatroom, memberPrefix);
+  });
+}
+
+void
+ControllerBackend::sendInvitationRequest(const std::string& chatroom,
+                                         const std::string& memberPrefix)
+{
   Name interestName = getInvitationRoutingPrefix();
-  interestName.append(ROUTING_HINT_SEPARATOR).append(prefix.toStdString());
+  interestName.append(ROUTING_HINT_SEPARATOR).append(memberPrefix);
   interestName.append("CHRONOCHAT-INVITATION-REQUEST");
-  interestName.append(chatroomName.toStdString());
+  interestName.append(chatroom);
   interestName.append(m_identity);
   interestName.appendTimestamp();
   Interest interest(interestName);
@@ -454,6 +798,68 @@ ControllerBackend::onSendInvitationRequest(const QString& chatroomName, const QS
                          bind(&ControllerBackend::onRequestTimeout, this, _1, 0));
 }
 
+void
+ControllerBackend::onSendInvitations(const QString& chatroomName, const QStringList& identities)
+{
+  // the responses and the key requests of an invitee are signed with the key of its contact
+  std::vector<Name> invitees;
+  std::vector<ndn::Buffer> inviteeKeys;
+  QStringList unknownIdentities;
+  for (const QString& identity : identities) {
+    Name invitee(identity.toStdString());
+    shared_ptr<Contact> contact = m_contactManager.getContact(invitee);
+    if (contact == nullptr) {
+      unknownIdentities.append(identity);
+      continue;
+    }
+    invitees.push_back(invitee);
+    inviteeKeys.push_back(contact->getPublicKey());
+  }
+  if (!unknownIdentities.empty())
+    emit warning("Cannot invite " + unknownIdentities.join(", ") + " to " + chatroomName +
+                 ": not in the contacts");
+  // nobody is left to invite, the batch is over already
+  if (invitees.empty()) {
+    emit invitationProgress(chatroomName, 0, 0, 0, 0);
+    return;
+  }
+
+  m_face.getIoService().post([this, chatroomName, invitees, inviteeKeys] {
+    sendInvitations(chatroomName, invitees, inviteeKeys);
+  });
+}
+
+void
+ControllerBackend::sendInvitations(const QString& chatroomName, const std::vector<Name>& invitees,
+                                   const std::vector<ndn::Buffer>& inviteeKeys)
+{
+  std::string chatroom = chatroomName.toStdString();
+  shared_ptr<const ChatroomCredentials::Credential> credential =
+    m_chatroomCredentials.get(chatroom, m_identity);
+
+  std::vector<Invitation> invitations;
+  for (const Name& invitee : invitees)
+    invitations.push_back(Invitation(invitee, chatroom, m_localPrefix, credential->certificate));
+
+  m_invitationSender.send(invitations, inviteeKeys, credential->signingInfo,
+    [this, invitations, inviteeKeys] (const Invitation& invitation,
+                                      InvitationSender::Outcome outcome) {
+      // an unsecured chatroom has no group key to grant
+      if (outcome != InvitationSender::ACCEPTED ||
+          m_groupKeys.find(invitation.getChatroom()) == nullptr)
+        return;
+      // the acceptance is verified with the key of the invitee, which is granted the group key
+      for (size_t i = 0; i < invitations.size(); i++)
+        if (invitations[i].getInviteeNameSpace() == invitation.getInviteeNameSpace())
+          grantGroupKey(invitation.getChatroom(), invitation.getInviteeNameSpace(),
+                        inviteeKeys[i]);
+    },
+    [this, chatroomName] (const InvitationSender::Progress& progress) {
+      emit invitationProgress(chatroomName, progress.nAccepted, progress.nRejected,
+                              progress.nFailed, progress.nInvitations);
+    });
+}
+
 void
 ControllerBackend::onContactIdListReady(const QStringList& list)
 {
@@ -469,8 +875,11 @@ ControllerBackend::onContactIdListReady(const QStringList& list)
 void
 ControllerBackend::onNfdReconnect()
 {
-  std::lock_guard<std::mutex>lock(m_nfdConnectionMutex);
-  m_isNfdConnected = true;
+  {
+    std::lock_guard<std::mutex>lock(m_nfdConnectionMutex);
+    m_isNfdConnected = true;
+  }
+  m_nfdConnectionCondition.notify_all();
 }
 
 } // namespace chronochat
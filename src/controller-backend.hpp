@@ -18,13 +18,21 @@
 
 #ifndef Q_MOC_RUN
 #include "common.hpp"
+#include "anchor-validation-policy.hpp"
+#include "chatroom-credentials.hpp"
 #include "contact-manager.hpp"
+#include "group-key.hpp"
 #include "invitation.hpp"
+#include "invitation-replay-cache.hpp"
+#include "invitation-sender.hpp"
+#include <ndn-cxx/security/certificate-cache.hpp>
 #include <ndn-cxx/security/key-chain.hpp>
 #include <ndn-cxx/ims/in-memory-storage-persistent.hpp>
 #include <ndn-cxx/security/validator-null.hpp>
 #include <ndn-cxx/face.hpp>
 #include <boost/thread.hpp>
+#include <condition_variable>
+#include <map>
 #include <mutex>
 #endif
 
@@ -45,6 +53,15 @@ public:
     return &m_contactManager;
   }
 
+  /**
+   * @brief get the group keys of the chatrooms, the ones created here and the ones received
+   */
+  GroupKeyStore&
+  getGroupKeys()
+  {
+    return m_groupKeys;
+  }
+
 protected:
   void
   run();
@@ -53,6 +70,16 @@ private:
   void
   setInvitationListener();
 
+  /**
+   * @brief switch to @p identity, make sure its key exists, and listen to its invitations
+   *
+   * Called on the thread of the face, which owns the identity and the KeyChain.
+   *
+   * @param identityUri the identity as it is reported back with identityUpdated
+   */
+  void
+  updateIdentity(const Name& identity, const QString& identityUri);
+
   ndn::Name
   getInvitationRoutingPrefix();
 
@@ -60,6 +87,37 @@ private:
   onInvitationInterest(const ndn::Name& prefix, const ndn::Interest& interest,
                        size_t routingPrefixOffset);
 
+  /**
+   * @brief fetch the certificate a compact invitation refers to, then validate the invitation
+   *
+   * The certificate is fetched through the routing prefix, like the invitation came.
+   */
+  void
+  fetchInviterCertificate(const shared_ptr<Interest>& invitationInterest,
+                          const Name& certificateName, int resendTimes);
+
+  /**
+   * @brief give up an invitation whose certificate cannot be fetched, and warn about it
+   */
+  void
+  onInviterCertificateUnavailable(const Interest& invitationInterest);
+
+  /**
+   * @brief validate an invitation against the certificate of the inviter it carries
+   *
+   * @param invitation the parsed @p invitationInterest, with the certificate of the inviter
+   */
+  void
+  validateInvitation(const shared_ptr<Interest>& invitationInterest,
+                     const Invitation& invitation);
+
+  /**
+   * @brief answer the Interests for our certificate which come through the routing prefix
+   */
+  void
+  onCertificateInterest(const ndn::Name& prefix, const ndn::Interest& interest,
+                        size_t routingPrefixOffset);
+
   void
   onInvitationRequestInterest(const ndn::Name& prefix, const ndn::Interest& interest,
                               size_t routingPrefixOffset);
@@ -89,6 +147,56 @@ private:
   void
   onRequestTimeout(const Interest& interest, int& resendTimes);
 
+  /**
+   * @brief allow @p identity to fetch the group key of @p chatroom
+   *
+   * @param publicKey the key the requests of @p identity must be signed with
+   */
+  void
+  grantGroupKey(const std::string& chatroom, const Name& identity, const ndn::Buffer& publicKey);
+
+  void
+  onGroupKeyInterest(const ndn::Name& prefix, const ndn::Interest& interest);
+
+  /**
+   * @brief fetch the group key of @p chatroom from the member who let us in
+   *
+   * The request is signed with our certificate and carries a transport key created for it,
+   * the member encrypts the key to the transport key. The reply must be signed with
+   * @p memberCertificate.
+   */
+  void
+  fetchGroupKey(const std::string& chatroom, const ndn::security::Certificate& memberCertificate);
+
+  void
+  onGroupKeyData(const Data& data, const std::string& chatroom,
+                 const ndn::security::Certificate& memberCertificate,
+                 const shared_ptr<ndn::security::transform::PrivateKey>& transportKey);
+
+  void
+  onGroupKeyTimeout(const Interest& interest, const std::string& chatroom,
+                    const ndn::security::Certificate& memberCertificate,
+                    const shared_ptr<ndn::security::transform::PrivateKey>& transportKey,
+                    int resendTimes);
+
+  void
+  respondToInvitation(const Name& invitationName, bool accepted);
+
+  void
+  respondToInvitationRequest(const Name& invitationResponseName, bool accepted);
+
+  void
+  sendInvitationRequest(const std::string& chatroom, const std::string& memberPrefix);
+
+  /**
+   * @brief invite @p invitees to @p chatroomName with the credential of the chatroom
+   *
+   * @param inviteeKeys the keys of the contacts of @p invitees, in the same order
+   */
+  void
+  sendInvitations(const QString& chatroomName, const std::vector<Name>& invitees,
+                  const std::vector<ndn::Buffer>& inviteeKeys);
+
 signals:
   void
   identityUpdated(const QString& identity);
@@ -111,9 +219,19 @@ signals:
   void
   invitationRequestResult(const std::string& msg);
 
+  void
+  groupKeyReceived(QString chatroom);
+
+  void
+  invitationProgress(QString chatroom, int nAccepted, int nRejected, int nFailed,
+                     int nInvitations);
+
   void
   nfdError();
 
+  void
+  warning(const QString& msg);
+
 public slots:
   void
   shutdown();
@@ -139,6 +257,12 @@ public slots:
   void
   onSendInvitationRequest(const QString& chatroomName, const QString& prefix);
 
+  /**
+   * @brief invite @p identities to @p chatroomName, in one batch
+   */
+  void
+  onSendInvitations(const QString& chatroomName, const QStringList& identities);
+
   void
   onNfdReconnect();
 
@@ -150,6 +274,7 @@ private:
   bool m_isNfdConnected;
   bool m_shouldResume;
 
+  // the identity and the KeyChain are used on the thread of the face only
   Name m_identity;  //TODO: set/get
 
   Name m_localPrefix;
@@ -160,12 +285,13 @@ private:
   // Contact Manager
   ContactManager m_contactManager;
 
-  shared_ptr<ndn::security::Validator> m_validator;
   ndn::security::ValidatorNull m_nullValidator;
 
   // RegisteredPrefixId
   ndn::ScopedRegisteredPrefixHandle m_invitationListenerHandle;
   ndn::ScopedRegisteredPrefixHandle m_requestListenerHandle;
+  ndn::ScopedRegisteredPrefixHandle m_groupKeyListenerHandle;
+  ndn::ScopedRegisteredPrefixHandle m_certificateListenerHandle;
 
   // ChatRoomList
   QStringList m_chatDialogList;
@@ -173,8 +299,23 @@ private:
   QMutex m_mutex;
   std::mutex m_resumeMutex;
   std::mutex m_nfdConnectionMutex;
+  std::condition_variable m_nfdConnectionCondition;
 
   ndn::InMemoryStoragePersistent m_ims;
+
+  GroupKeyStore m_groupKeys;
+  // the public keys of the members let in by us, by chatroom and identity
+  std::map<std::pair<std::string, Name>, ndn::Buffer> m_groupKeyGrants;
+  std::mutex m_groupKeyGrantsMutex;
+
+  ChatroomCredentials m_chatroomCredentials;
+
+  // the certificates of the inviters, which compact invitations refer to
+  ndn::security::CertificateCache m_inviterCertificates;
+  // the invitations received lately, used on the thread of the face
+  InvitationReplayCache m_invitationReplays;
+
+  InvitationSender m_invitationSender;
 };
 
 } // namespace chronochat
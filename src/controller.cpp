@@ -26,6 +26,8 @@
 
 #include <boost/filesystem.hpp>
 
+#include <iostream>
+
 Q_DECLARE_METATYPE(ndn::Name)
 Q_DECLARE_METATYPE(ndn::security::Certificate)
 Q_DECLARE_METATYPE(chronochat::EndorseInfo)
@@ -47,13 +49,16 @@ Controller::Controller(QWidget* parent)
   , m_isInConnectionDetection(false)
   , m_settingDialog(new SettingDialog(this))
   , m_startChatDialog(new StartChatDialog(this))
-  , m_profileEditor(new ProfileEditor(this))
+  , m_profileEditor(nullptr)
   , m_invitationDialog(new InvitationDialog(this))
   , m_invitationRequestDialog(new InvitationRequestDialog(this))
+  , m_inviteListDialog(new InviteListDialog(this))
   , m_contactPanel(new ContactPanel(this))
-  , m_browseContactDialog(new BrowseContactDialog(this))
-  , m_addContactPanel(new AddContactPanel(this))
+  , m_browseContactDialog(nullptr)
+  , m_addContactPanel(nullptr)
   , m_discoveryPanel(new DiscoveryPanel(this))
+  , m_chatroomDiscoveryBackend(nullptr)
+  , m_nfdConnectionChecker(nullptr)
 {
   qRegisterMetaType<ndn::Name>("ndn.Name");
   qRegisterMetaType<ndn::security::Certificate>("ndn.security.v2.Certificate");
@@ -65,6 +70,7 @@ Controller::Controller(QWidget* parent)
   qRegisterMetaType<std::string>("std.string");
   qRegisterMetaType<ndn::Name::Component>("ndn.Component");
 
+  m_startupTimer.mark("dialogs");
 
   // Connection to ContactManager
   connect(m_backend.getContactManager(), SIGNAL(warning(const QString&)),
@@ -84,14 +90,6 @@ Controller::Controller(QWidget* parent)
   connect(m_settingDialog, SIGNAL(prefixUpdated(const QString&)),
           this, SLOT(onLocalPrefixConfigured(const QString&)));
 
-  // Connection to ProfileEditor
-  connect(this, SIGNAL(closeDBModule()),
-          m_profileEditor, SLOT(onCloseDBModule()));
-  connect(this, SIGNAL(identityUpdated(const QString&)),
-          m_profileEditor, SLOT(onIdentityUpdated(const QString&)));
-  connect(m_profileEditor, SIGNAL(updateProfile()),
-          m_backend.getContactManager(), SLOT(onUpdateProfile()));
-
   // Connection to StartChatDialog
   connect(m_startChatDialog, SIGNAL(startChatroom(const QString&, bool)),
           this, SLOT(onStartChatroom(const QString&, bool)));
@@ -104,29 +102,15 @@ Controller::Controller(QWidget* parent)
   connect(m_invitationRequestDialog, SIGNAL(invitationRequestResponded(const ndn::Name&, bool)),
           &m_backend, SLOT(onInvitationRequestResponded(const ndn::Name&, bool)));
 
-  // Connection to AddContactPanel
-  connect(m_addContactPanel, SIGNAL(fetchInfo(const QString&)),
-          m_backend.getContactManager(), SLOT(onFetchContactInfo(const QString&)));
-  connect(m_addContactPanel, SIGNAL(addContact(const QString&)),
-          m_backend.getContactManager(), SLOT(onAddFetchedContact(const QString&)));
-  connect(m_backend.getContactManager(),
-          SIGNAL(contactEndorseInfoReady(const EndorseInfo&)),
-          m_addContactPanel,
-          SLOT(onContactEndorseInfoReady(const EndorseInfo&)));
-
-  // Connection to BrowseContactDialog
-  connect(m_browseContactDialog, SIGNAL(directAddClicked()),
-          this, SLOT(onDirectAdd()));
-  connect(m_browseContactDialog, SIGNAL(fetchIdCert(const QString&)),
-          m_backend.getContactManager(), SLOT(onFetchIdCert(const QString&)));
-  connect(m_browseContactDialog, SIGNAL(addContact(const QString&)),
-          m_backend.getContactManager(), SLOT(onAddFetchedContactIdCert(const QString&)));
-  connect(m_backend.getContactManager(), SIGNAL(idCertNameListReady(const QStringList&)),
-          m_browseContactDialog, SLOT(onIdCertNameListReady(const QStringList&)));
-  connect(m_backend.getContactManager(), SIGNAL(nameListReady(const QStringList&)),
-          m_browseContactDialog, SLOT(onNameListReady(const QStringList&)));
-  connect(m_backend.getContactManager(), SIGNAL(idCertReady(const ndn::security::Certificate&)),
-          m_browseContactDialog, SLOT(onIdCertReady(const ndn::security::Certificate&)));
+  // Connection to InviteListDialog
+  connect(m_backend.getContactManager(), SIGNAL(contactAliasListReady(const QStringList&)),
+          m_inviteListDialog, SLOT(onContactAliasListReady(const QStringList&)));
+  connect(m_backend.getContactManager(), SIGNAL(contactIdListReady(const QStringList&)),
+          m_inviteListDialog, SLOT(onContactIdListReady(const QStringList&)));
+  connect(m_inviteListDialog, SIGNAL(sendInvitations(const QString&, const QStringList&)),
+          &m_backend, SLOT(onSendInvitations(const QString&, const QStringList&)));
+  connect(&m_backend, SIGNAL(invitationProgress(QString, int, int, int, int)),
+          m_inviteListDialog, SLOT(onInvitationProgress(QString, int, int, int, int)));
 
   // Connection to ContactPanel
   connect(m_contactPanel, SIGNAL(waitForContactList()),
@@ -141,6 +125,8 @@ Controller::Controller(QWidget* parent)
           m_backend.getContactManager(), SLOT(onUpdateIsIntroducer(const QString&, bool)));
   connect(m_contactPanel, SIGNAL(updateEndorseCertificate(const QString&)),
           m_backend.getContactManager(), SLOT(onUpdateEndorseCertificate(const QString&)));
+  connect(m_contactPanel, SIGNAL(trustScopeChanged(const QString&)),
+          m_backend.getContactManager(), SLOT(onTrustScopeChanged(const QString&)));
   connect(m_contactPanel, SIGNAL(warning(const QString&)),
           this, SLOT(onWarning(const QString&)));
   connect(this, SIGNAL(closeDBModule()),
@@ -184,6 +170,8 @@ Controller::Controller(QWidget* parent)
           m_invitationDialog, SLOT(onInvitationReceived(QString, QString, ndn::Name)));
   connect(&m_backend, SIGNAL(startChatroom(const QString&, bool)),
           this, SLOT(onStartChatroom(const QString&, bool)));
+  connect(&m_backend, SIGNAL(warning(const QString&)),
+          this, SLOT(onWarning(const QString&)));
 
   // on invitation request received
   connect(&m_backend, SIGNAL(invitationRequestReceived(QString, QString, ndn::Name)),
@@ -193,10 +181,14 @@ Controller::Controller(QWidget* parent)
   // on invitation accepted:
   connect(&m_backend, SIGNAL(startChatroomOnInvitation(chronochat::Invitation, bool)),
           this, SLOT(onStartChatroom2(chronochat::Invitation, bool)));
+  connect(&m_backend, SIGNAL(groupKeyReceived(QString)),
+          this, SLOT(onGroupKeyReceived(QString)));
+
+  m_startupTimer.mark("connections");
 
   m_backend.start();
 
-  initialize();
+  loadConf();
 
   m_chatroomDiscoveryBackend
     = new ChatroomDiscoveryBackend(m_localPrefix,
@@ -230,8 +222,12 @@ Controller::Controller(QWidget* parent)
           m_discoveryPanel, SLOT(onIdentityUpdated(const QString&)));
   connect(m_chatroomDiscoveryBackend, SIGNAL(chatroomListReady(const QStringList&)),
           m_discoveryPanel, SLOT(onChatroomListReady(const QStringList&)));
-  connect(m_chatroomDiscoveryBackend, SIGNAL(chatroomInfoReady(const ChatroomInfo&, bool)),
-          m_discoveryPanel, SLOT(onChatroomInfoReady(const ChatroomInfo&, bool)));
+  connect(m_chatroomDiscoveryBackend,
+          SIGNAL(chatroomListChanged(const QStringList&, const QStringList&)),
+          m_discoveryPanel, SLOT(onChatroomListChanged(const QStringList&, const QStringList&)));
+  connect(m_chatroomDiscoveryBackend,
+          SIGNAL(chatroomInfoReady(const ChatroomInfo&, bool, bool)),
+          m_discoveryPanel, SLOT(onChatroomInfoReady(const ChatroomInfo&, bool, bool)));
   connect(m_discoveryPanel, SIGNAL(startChatroom(const QString&, bool)),
           this, SLOT(onStartChatroom(const QString&, bool)));
   connect(m_discoveryPanel, SIGNAL(sendInvitationRequest(const QString&, const QString&)),
@@ -239,11 +235,13 @@ Controller::Controller(QWidget* parent)
   connect(&m_backend, SIGNAL(invitationRequestResult(const std::string&)),
           m_discoveryPanel, SLOT(onInvitationRequestResult(const std::string&)));
 
-  m_chatroomDiscoveryBackend->start();
+  m_startupTimer.mark("configuration");
 
   createTrayIcon();
+  m_startupTimer.mark("tray");
 
-  emit updateLocalPrefix();
+  // the database and the discovery wait for the tray to be shown
+  QTimer::singleShot(0, this, SLOT(onStartupContinued()));
 }
 
 Controller::~Controller()
@@ -251,6 +249,31 @@ Controller::~Controller()
   saveConf();
 }
 
+void
+Controller::onStartupContinued()
+{
+  initialize();
+  m_startupTimer.mark("identity");
+
+  m_nfdConnectionChecker = new NfdConnectionChecker(this);
+  connect(m_nfdConnectionChecker, SIGNAL(nfdConnected()),
+          this, SLOT(onNfdReconnect()));
+  connect(this, SIGNAL(recheckNfd()),
+          m_nfdConnectionChecker, SLOT(recheck()));
+  connect(this, SIGNAL(shutdownNfdChecker()),
+          m_nfdConnectionChecker, SLOT(shutdown()));
+  m_nfdConnectionChecker->start();
+
+  m_chatroomDiscoveryBackend->start();
+  m_startupTimer.mark("discovery");
+
+  emit updateLocalPrefix();
+
+  // the phases are printed on request only, e.g. to compare startups
+  if (getenv("CHRONOCHAT_STARTUP_TIMES") != nullptr)
+    std::cerr << m_startupTimer << std::endl;
+}
+
 static string
 getRandomString()
 {
@@ -302,13 +325,69 @@ Controller::openDB()
 void
 Controller::initialize()
 {
-  loadConf();
-
   openDB();
 
   emit identityUpdated(QString(m_identity.toUri().c_str()));
 }
 
+ProfileEditor*
+Controller::getProfileEditor()
+{
+  if (m_profileEditor != nullptr)
+    return m_profileEditor;
+
+  m_profileEditor = new ProfileEditor(this);
+  connect(this, SIGNAL(closeDBModule()),
+          m_profileEditor, SLOT(onCloseDBModule()));
+  connect(this, SIGNAL(identityUpdated(const QString&)),
+          m_profileEditor, SLOT(onIdentityUpdated(const QString&)));
+  connect(m_profileEditor, SIGNAL(updateProfile()),
+          m_backend.getContactManager(), SLOT(onUpdateProfile()));
+
+  m_profileEditor->onIdentityUpdated(QString(m_identity.toUri().c_str()));
+  return m_profileEditor;
+}
+
+BrowseContactDialog*
+Controller::getBrowseContactDialog()
+{
+  if (m_browseContactDialog != nullptr)
+    return m_browseContactDialog;
+
+  m_browseContactDialog = new BrowseContactDialog(this);
+  connect(m_browseContactDialog, SIGNAL(directAddClicked()),
+          this, SLOT(onDirectAdd()));
+  connect(m_browseContactDialog, SIGNAL(fetchIdCert(const QString&)),
+          m_backend.getContactManager(), SLOT(onFetchIdCert(const QString&)));
+  connect(m_browseContactDialog, SIGNAL(addContact(const QString&)),
+          m_backend.getContactManager(), SLOT(onAddFetchedContactIdCert(const QString&)));
+  connect(m_backend.getContactManager(), SIGNAL(idCertNameListReady(const QStringList&)),
+          m_browseContactDialog, SLOT(onIdCertNameListReady(const QStringList&)));
+  connect(m_backend.getContactManager(), SIGNAL(nameListReady(const QStringList&)),
+          m_browseContactDialog, SLOT(onNameListReady(const QStringList&)));
+  connect(m_backend.getContactManager(), SIGNAL(idCertReady(const ndn::security::Certificate&)),
+          m_browseContactDialog, SLOT(onIdCertReady(const ndn::security::Certificate&)));
+  return m_browseContactDialog;
+}
+
+AddContactPanel*
+Controller::getAddContactPanel()
+{
+  if (m_addContactPanel != nullptr)
+    return m_addContactPanel;
+
+  m_addContactPanel = new AddContactPanel(this);
+  connect(m_addContactPanel, SIGNAL(fetchInfo(const QString&)),
+          m_backend.getContactManager(), SLOT(onFetchContactInfo(const QString&)));
+  connect(m_addContactPanel, SIGNAL(addContact(const QString&)),
+          m_backend.getContactManager(), SLOT(onAddFetchedContact(const QString&)));
+  connect(m_backend.getContactManager(),
+          SIGNAL(contactEndorseInfoReady(const EndorseInfo&)),
+          m_addContactPanel,
+          SLOT(onContactEndorseInfoReady(const EndorseInfo&)));
+  return m_addContactPanel;
+}
+
 void
 Controller::loadConf()
 {
@@ -480,6 +559,8 @@ Controller::addChatDialog(const QString& chatroomName, ChatDialog* chatDialog)
           this, SLOT(onShowChatMessage(const QString&, const QString&, const QString&)));
   connect(chatDialog, SIGNAL(resetIcon()),
           this, SLOT(onResetIcon()));
+  connect(chatDialog, SIGNAL(inviteRequested(const QString&)),
+          this, SLOT(onInviteRequested(const QString&)));
   connect(&m_backend, SIGNAL(localPrefixUpdated(const QString&)),
           chatDialog->getBackend(), SLOT(updateRoutingPrefix(const QString&)));
   connect(this, SIGNAL(localPrefixConfigured(const QString&)),
@@ -492,9 +573,11 @@ Controller::addChatDialog(const QString& chatroomName, ChatDialog* chatDialog)
           this, SLOT(onNfdError()));
   connect(chatDialog->getBackend(), SIGNAL(newChatroomForDiscovery(ndn::Name::Component)),
           m_chatroomDiscoveryBackend, SLOT(onNewChatroomForDiscovery(ndn::Name::Component)));
-  connect(chatDialog->getBackend(), SIGNAL(addInRoster(ndn::Name, ndn::Name::Component)),
+  connect(chatDialog->getBackend()->getRoster(),
+          SIGNAL(participantAdded(ndn::Name, ndn::Name::Component)),
           m_chatroomDiscoveryBackend, SLOT(onAddInRoster(ndn::Name, ndn::Name::Component)));
-  connect(chatDialog->getBackend(), SIGNAL(eraseInRoster(ndn::Name, ndn::Name::Component)),
+  connect(chatDialog->getBackend()->getRoster(),
+          SIGNAL(participantRemoved(ndn::Name, ndn::Name::Component)),
           m_chatroomDiscoveryBackend, SLOT(onEraseInRoster(ndn::Name, ndn::Name::Component)));
 
 
@@ -511,6 +594,53 @@ Controller::addChatDialog(const QString& chatroomName, ChatDialog* chatDialog)
   updateMenu();
 }
 
+void
+Controller::openChatroom(const QString& chatroomName, bool secured, bool createGroupKey)
+{
+  Name chatroomPrefix;
+  chatroomPrefix.append("ndn")
+    .append("broadcast")
+    .append("ChronoChat")
+    .append("Chatroom")
+    .append(chatroomName.toStdString());
+
+  // check if the chatroom exists
+  if (m_chatDialogList.find(chatroomName.toStdString()) != m_chatDialogList.end()) {
+    QMessageBox::information(this, tr("ChronoChat"),
+                             tr("You are creating an existing chatroom."
+                                "You can check it in the context memu."));
+    return;
+  }
+
+  Name chatPrefix;
+  chatPrefix.append(m_identity).append("CHRONOCHAT-CHATDATA").append(chatroomName.toStdString());
+
+  ChatDialog* chatDialog
+    = new ChatDialog(chatroomPrefix,
+                     chatPrefix,
+                     m_localPrefix,
+                     chatroomName.toStdString(),
+                     m_nick,
+                     true,
+                     m_identity,
+                     this);
+
+  // the chat data of a secured chatroom are signed with its group key, which is created with
+  // the chatroom or received from the member who let us in
+  shared_ptr<const GroupKey> groupKey;
+  if (secured)
+    groupKey = m_backend.getGroupKeys().find(chatroomName.toStdString());
+  if (groupKey == nullptr && createGroupKey)
+    groupKey = m_backend.getGroupKeys().create(chatroomName.toStdString(), chatroomPrefix);
+  if (groupKey != nullptr)
+    chatDialog->getBackend()->setGroupKey(groupKey);
+
+  addChatDialog(chatroomName, chatDialog);
+  chatDialog->show();
+
+  emit addChatroom(chatroomName);
+}
+
 void
 Controller::updateDiscoveryList(const ChatroomInfo& info, bool isAdd)
 {
@@ -594,17 +724,19 @@ Controller::onSettingsAction()
 void
 Controller::onProfileEditorAction()
 {
-  m_profileEditor->resetPanel();
-  m_profileEditor->show();
-  m_profileEditor->raise();
+  ProfileEditor* profileEditor = getProfileEditor();
+  profileEditor->resetPanel();
+  profileEditor->show();
+  profileEditor->raise();
 }
 
 void
 Controller::onAddContactAction()
 {
+  BrowseContactDialog* browseContactDialog = getBrowseContactDialog();
   emit refreshBrowseContact();
-  m_browseContactDialog->show();
-  m_browseContactDialog->raise();
+  browseContactDialog->show();
+  browseContactDialog->raise();
 }
 
 void
@@ -624,8 +756,9 @@ Controller::onChatroomDiscoveryAction()
 void
 Controller::onDirectAdd()
 {
-  m_addContactPanel->show();
-  m_addContactPanel->raise();
+  AddContactPanel* addContactPanel = getAddContactPanel();
+  addContactPanel->show();
+  addContactPanel->raise();
 }
 
 void
@@ -633,9 +766,11 @@ Controller::onMinimizeAction()
 {
   m_settingDialog->hide();
   m_startChatDialog->hide();
-  m_profileEditor->hide();
+  if (m_profileEditor != nullptr)
+    m_profileEditor->hide();
   m_invitationDialog->hide();
-  m_addContactPanel->hide();
+  if (m_addContactPanel != nullptr)
+    m_addContactPanel->hide();
   m_discoveryPanel->hide();
 
   auto it = m_chatDialogList.begin();
@@ -656,10 +791,11 @@ Controller::onQuitAction()
   delete m_startChatDialog;
   delete m_profileEditor;
   delete m_invitationDialog;
+  delete m_inviteListDialog;
   delete m_browseContactDialog;
   delete m_addContactPanel;
   delete m_discoveryPanel;
-  if (m_chatroomDiscoveryBackend->isRunning()) {
+  if (m_chatroomDiscoveryBackend != nullptr && m_chatroomDiscoveryBackend->isRunning()) {
     emit shutdownDiscoveryBackend();
     m_chatroomDiscoveryBackend->wait();
   }
@@ -681,54 +817,38 @@ Controller::onQuitAction()
 void
 Controller::onStartChatroom(const QString& chatroomName, bool secured)
 {
-  Name chatroomPrefix;
-  chatroomPrefix.append("ndn")
-    .append("broadcast")
-    .append("ChronoChat")
-    .append("Chatroom")
-    .append(chatroomName.toStdString());
-
-  // check if the chatroom exists
-  if (m_chatDialogList.find(chatroomName.toStdString()) != m_chatDialogList.end()) {
-    QMessageBox::information(this, tr("ChronoChat"),
-                             tr("You are creating an existing chatroom."
-                                "You can check it in the context memu."));
-    return;
-  }
-
-  // TODO: We should create a chatroom specific key/cert
-  //(which should be created in the first half of this method
-  //, but let's use the default one for now.
-  Name chatPrefix;
-  chatPrefix.append(m_identity).append("CHRONOCHAT-CHATDATA").append(chatroomName.toStdString());
-
-  ChatDialog* chatDialog
-    = new ChatDialog(chatroomPrefix,
-                     chatPrefix,
-                     m_localPrefix,
-                     chatroomName.toStdString(),
-                     m_nick,
-                     true,
-                     m_identity,
-                     this);
-
-  addChatDialog(chatroomName, chatDialog);
-  chatDialog->show();
-
-  emit addChatroom(chatroomName);
+  // the creator of a secured chatroom creates its group key
+  openChatroom(chatroomName, secured, secured);
 }
 
 void
 Controller::onStartChatroom2(chronochat::Invitation invitation, bool secured)
 {
   QString chatroomName = QString::fromStdString(invitation.getChatroom());
-  onStartChatroom(chatroomName, secured);
+  // the group key of a secured chatroom comes from the inviter
+  openChatroom(chatroomName, secured, false);
 
   auto it = m_chatDialogList.find(chatroomName.toStdString());
   BOOST_ASSERT(it != m_chatDialogList.end());
   it->second->addSyncAnchor(invitation);
 }
 
+void
+Controller::onGroupKeyReceived(QString chatroomName)
+{
+  auto it = m_chatDialogList.find(chatroomName.toStdString());
+  if (it != m_chatDialogList.end())
+    it->second->getBackend()->setGroupKey(
+      m_backend.getGroupKeys().find(chatroomName.toStdString()));
+}
+
+void
+Controller::onInviteRequested(const QString& chatroomName)
+{
+  m_inviteListDialog->setChatroom(chatroomName);
+  m_inviteListDialog->show();
+  m_inviteListDialog->raise();
+}
 
 void
 Controller::onShowChatMessage(const QString& chatroomName, const QString& from, const QString& data)
@@ -783,28 +903,16 @@ Controller::onNfdError()
 {
   if (m_isInConnectionDetection)
     return;
-  // begin a thread
 
   m_isInConnectionDetection = true;
-  m_nfdConnectionChecker = new NfdConnectionChecker(this);
-
-  connect(m_nfdConnectionChecker, SIGNAL(nfdConnected()),
-          this, SLOT(onNfdReconnect()));
-  connect(this, SIGNAL(shutdownNfdChecker()),
-          m_nfdConnectionChecker, SLOT(shutdown()));
-
-  m_nfdConnectionChecker->start();
+  // the backends wait for the checker to see the forwarder again
+  emit recheckNfd();
   QMessageBox::information(this, tr("ChronoChat"), "Nfd is not running");
 }
 
 void
 Controller::onNfdReconnect()
 {
-  if (m_nfdConnectionChecker != nullptr && m_nfdConnectionChecker->isRunning()) {
-    m_nfdConnectionChecker->wait();
-  }
-  delete m_nfdConnectionChecker;
-  m_nfdConnectionChecker = nullptr;
   m_isInConnectionDetection = false;
   emit nfdReconnect();
 }
@@ -22,6 +22,7 @@
 #include "profile-editor.hpp"
 #include "invitation-dialog.hpp"
 #include "invitation-request-dialog.hpp"
+#include "invite-list-dialog.hpp"
 #include "contact-panel.hpp"
 #include "browse-contact-dialog.hpp"
 #include "add-contact-panel.hpp"
@@ -29,6 +30,7 @@
 #include "chatroom-discovery-backend.hpp"
 #include "discovery-panel.hpp"
 #include "nfd-connection-checker.hpp"
+#include "startup-timer.hpp"
 
 #ifndef Q_MOC_RUN
 #include "common.hpp"
@@ -48,6 +50,15 @@ public: // public methods
   virtual
   ~Controller();
 
+  /**
+   * @brief get the duration of each phase of the startup
+   */
+  const StartupTimer&
+  getStartupTimer() const
+  {
+    return m_startupTimer;
+  }
+
 private: // private methods
   std::string
   getDBName();
@@ -58,6 +69,18 @@ private: // private methods
   void
   initialize();
 
+  /**
+   * @brief get the profile editor, which is created and connected when first used
+   */
+  ProfileEditor*
+  getProfileEditor();
+
+  BrowseContactDialog*
+  getBrowseContactDialog();
+
+  AddContactPanel*
+  getAddContactPanel();
+
   void
   loadConf();
 
@@ -76,6 +99,15 @@ private: // private methods
   void
   addChatDialog(const QString& chatroomName, ChatDialog* chatDialog);
 
+  /**
+   * @brief open the dialog of a chatroom
+   *
+   * @param secured whether the chat data are signed with the group key of the chatroom
+   * @param createGroupKey whether the key is created here, instead of received from a member
+   */
+  void
+  openChatroom(const QString& chatroomName, bool secured, bool createGroupKey);
+
   void
   updateDiscoveryList(const chronochat::ChatroomInfo& chatroomName, bool isAdd);
 
@@ -126,7 +158,16 @@ signals:
   void
   shutdownNfdChecker();
 
+  void
+  recheckNfd();
+
 private slots:
+  /**
+   * @brief open the database and start the discovery, once the tray is shown
+   */
+  void
+  onStartupContinued();
+
   void
   onIdentityUpdated(const QString& identity);
 
@@ -175,6 +216,12 @@ private slots:
   void
   onStartChatroom2(chronochat::Invitation invitation, bool secured);
 
+  void
+  onGroupKeyReceived(QString chatroomName);
+
+  void
+  onInviteRequested(const QString& chatroomName);
+
   void
   onShowChatMessage(const QString& chatroomName, const QString& from, const QString& data);
 
@@ -200,6 +247,9 @@ private: // private member
   typedef std::map<std::string, QAction*> ChatActionList;
   typedef std::map<std::string, ChatDialog*> ChatDialogList;
 
+  // Startup
+  StartupTimer m_startupTimer;
+
   // Communication
   Name m_localPrefix;
   bool m_localPrefixDetected;
@@ -228,6 +278,7 @@ private: // private member
   ProfileEditor*            m_profileEditor;
   InvitationDialog*         m_invitationDialog;
   InvitationRequestDialog*  m_invitationRequestDialog;
+  InviteListDialog*         m_inviteListDialog;
   ContactPanel*             m_contactPanel;
   BrowseContactDialog*      m_browseContactDialog;
   AddContactPanel*          m_addContactPanel;
@@ -117,36 +117,6 @@ DigestTreeScene::removeNode(const QString sessionPrefix)
   plot(m_rootDigest);
 }
 
-QStringList
-DigestTreeScene::getRosterList()
-{
-  QStringList rosterList;
-  RosterIterator it(m_roster);
-  while (it.hasNext()) {
-    it.next();
-    DisplayUserPtr p = it.value();
-    if (p != DisplayUserNullPtr) {
-      rosterList << "- " + p->getNick();
-    }
-  }
-  return rosterList;
-}
-
-QStringList
-DigestTreeScene::getRosterPrefixList()
-{
-  QStringList prefixList;
-  RosterIterator it(m_roster);
-  while (it.hasNext()) {
-    it.next();
-    DisplayUserPtr p = it.value();
-    if (p != DisplayUserNullPtr) {
-      prefixList << p->getPrefix();
-    }
-  }
-  return prefixList;
-}
-
 void
 DigestTreeScene::plot(QString rootDigest)
 {
@@ -65,12 +65,6 @@ public:
   void
   removeNode(const QString sessionPrefix);
 
-  QStringList
-  getRosterList();
-
-  QStringList
-  getRosterPrefixList();
-
   void
   plot(QString rootDigest);
 
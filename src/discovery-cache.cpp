@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Qiuhan Ding <qiuhanding@cs.ucla.edu>
+ *         Yingdi Yu <yingdi@cs.ucla.edu>
+ */
+
+#include "discovery-cache.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace chronochat {
+
+namespace fs = boost::filesystem;
+
+DiscoveryCache::DiscoveryCache(const std::string& path, time::system_clock::Duration maxAge)
+  : m_path(path)
+  , m_maxAge(maxAge)
+{
+}
+
+Block
+DiscoveryCache::encodeEntry(const Entry& entry)
+{
+  ndn::EncodingBuffer buffer;
+
+  size_t totalLength = buffer.prependBlock(entry.info.wireEncode());
+  totalLength += prependNonNegativeIntegerBlock(buffer, tlv::Timestamp,
+                                                time::toUnixTimestamp(entry.timestamp).count());
+  totalLength += buffer.prependVarNumber(totalLength);
+  totalLength += buffer.prependVarNumber(tlv::DiscoveryCacheEntry);
+
+  return buffer.block();
+}
+
+DiscoveryCache::Entry
+DiscoveryCache::decodeEntry(const Block& block)
+{
+  if (block.type() != tlv::DiscoveryCacheEntry)
+    NDN_THROW(Error("Unexpected TLV number when decoding discovery cache entry"));
+
+  block.parse();
+  Block::element_const_iterator i = block.elements_begin();
+
+  Entry entry;
+  if (i == block.elements_end() || i->type() != tlv::Timestamp)
+    NDN_THROW(Error("Missing Timestamp"));
+  entry.timestamp = time::fromUnixTimestamp(time::milliseconds(readNonNegativeInteger(*i)));
+  ++i;
+
+  if (i == block.elements_end())
+    NDN_THROW(Error("Missing Chatroom Info"));
+  entry.info.wireDecode(*i);
+  ++i;
+
+  if (i != block.elements_end())
+    NDN_THROW(Error("Unexpected element"));
+
+  return entry;
+}
+
+std::vector<DiscoveryCache::Entry>
+DiscoveryCache::load() const
+{
+  std::vector<Entry> entries;
+
+  std::ifstream is(m_path, std::ios::binary);
+  if (!is.is_open())
+    return entries;
+
+  time::system_clock::TimePoint oldest = time::system_clock::now() - m_maxAge;
+  while (is.peek() != std::char_traits<char>::eof()) {
+    Block block;
+    try {
+      block = Block::fromStream(is);
+    }
+    catch (const tlv::Error&) {
+      // a truncated tail, keep what was read so far
+      break;
+    }
+
+    try {
+      Entry entry = decodeEntry(block);
+      if (entry.timestamp >= oldest)
+        entries.push_back(std::move(entry));
+    }
+    catch (const Error&) {
+    }
+    catch (const ChatroomInfo::Error&) {
+    }
+    catch (const tlv::Error&) {
+    }
+  }
+
+  return entries;
+}
+
+void
+DiscoveryCache::save(const std::vector<Entry>& entries) const
+{
+  // a failure must not throw, the cache is saved from the thread of the face
+  boost::system::error_code error;
+  fs::path path(m_path);
+  fs::create_directories(path.parent_path(), error);
+  if (error)
+    return;
+
+  fs::path tmpPath = path;
+  tmpPath += ".tmp";
+  {
+    std::ofstream os(tmpPath.c_str(), std::ios::binary | std::ios::trunc);
+    for (const auto& entry : entries) {
+      Block block = encodeEntry(entry);
+      os.write(reinterpret_cast<const char*>(block.wire()), block.size());
+    }
+    // the buffered entries are written before the stream is checked
+    os.flush();
+    if (!os.good())
+      return;
+  }
+
+  fs::rename(tmpPath, path, error);
+}
+
+} // namespace chronochat
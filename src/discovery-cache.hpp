@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Qiuhan Ding <qiuhanding@cs.ucla.edu>
+ *         Yingdi Yu <yingdi@cs.ucla.edu>
+ */
+
+#ifndef CHRONOCHAT_DISCOVERY_CACHE_HPP
+#define CHRONOCHAT_DISCOVERY_CACHE_HPP
+
+#include "common.hpp"
+#include "tlv.hpp"
+#include "chatroom-info.hpp"
+
+namespace chronochat {
+
+/**
+ * @brief the last known chatrooms, persisted so that discovery can start warm
+ *
+ * The cache file is a sequence of entries:
+ *
+ *     DiscoveryCacheEntry := DISCOVERY-CACHE-ENTRY-TYPE TLV-LENGTH
+ *                              Timestamp
+ *                              ChatroomInfo
+ *
+ *     Timestamp := TIMESTAMP-TYPE TLV-LENGTH
+ *                    nonNegativeInteger  ; milliseconds since the Unix epoch
+ */
+class DiscoveryCache
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  class Entry
+  {
+  public:
+    ChatroomInfo info;
+    // when the info was last received from the network
+    time::system_clock::TimePoint timestamp;
+  };
+
+  /**
+   * @param path the cache file
+   * @param maxAge entries last received longer ago than this are not loaded
+   */
+  DiscoveryCache(const std::string& path, time::system_clock::Duration maxAge);
+
+  /**
+   * @brief load the entries, skipping the malformed or expired ones
+   */
+  std::vector<Entry>
+  load() const;
+
+  /**
+   * @brief replace the content of the cache file
+   *
+   * The entries are written to a temporary file first, so a crash while saving does not
+   * corrupt the previous cache. A failure leaves the previous cache in place, and does not
+   * throw.
+   */
+  void
+  save(const std::vector<Entry>& entries) const;
+
+  static Block
+  encodeEntry(const Entry& entry);
+
+  static Entry
+  decodeEntry(const Block& block);
+
+private:
+  std::string m_path;
+  time::system_clock::Duration m_maxAge;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_DISCOVERY_CACHE_HPP
@@ -14,8 +14,10 @@
 #include <QItemSelectionModel>
 #include <QModelIndex>
 #include <QMessageBox>
+#include <QSet>
 
 #ifndef Q_MOC_RUN
+#include <algorithm>
 #endif
 
 
@@ -23,6 +25,8 @@ namespace chronochat {
 
 static const ndn::Name::Component ROUTING_HINT_SEPARATOR =
   ndn::name::Component::fromEscapedString("%F0%2E");
+// a batch of list changes larger than this is applied by rebuilding the list
+static const int LIST_REBUILD_THRESHOLD = 64;
 
 DiscoveryPanel::DiscoveryPanel(QWidget *parent)
   : QDialog(parent)
@@ -96,11 +100,50 @@ void
 DiscoveryPanel::onChatroomListReady(const QStringList& list)
 {
   m_chatroomList = list;
+  std::sort(m_chatroomList.begin(), m_chatroomList.end());
   m_chatroomListModel->setStringList(m_chatroomList);
 }
 
 void
-DiscoveryPanel::onChatroomInfoReady(const ChatroomInfo& info, bool isParticipant)
+DiscoveryPanel::onChatroomListChanged(const QStringList& added, const QStringList& removed)
+{
+  if (added.size() + removed.size() > LIST_REBUILD_THRESHOLD) {
+    QSet<QString> removedSet;
+    for (const auto& chatroom : removed)
+      removedSet.insert(chatroom);
+    QStringList chatroomList;
+    for (const auto& chatroom : m_chatroomList) {
+      if (!removedSet.contains(chatroom))
+        chatroomList << chatroom;
+    }
+    chatroomList << added;
+    onChatroomListReady(chatroomList);
+    return;
+  }
+
+  for (const auto& chatroom : removed) {
+    auto it = std::lower_bound(m_chatroomList.begin(), m_chatroomList.end(), chatroom);
+    if (it == m_chatroomList.end() || *it != chatroom)
+      continue;
+    int row = it - m_chatroomList.begin();
+    m_chatroomList.removeAt(row);
+    m_chatroomListModel->removeRows(row, 1);
+  }
+
+  for (const auto& chatroom : added) {
+    auto it = std::lower_bound(m_chatroomList.begin(), m_chatroomList.end(), chatroom);
+    if (it != m_chatroomList.end() && *it == chatroom)
+      continue;
+    int row = it - m_chatroomList.begin();
+    m_chatroomList.insert(row, chatroom);
+    m_chatroomListModel->insertRows(row, 1);
+    m_chatroomListModel->setData(m_chatroomListModel->index(row), chatroom);
+  }
+}
+
+void
+DiscoveryPanel::onChatroomInfoReady(const ChatroomInfo& info, bool isParticipant,
+                                    bool isStale)
 {
   ui->NameData->setText(QString::fromStdString(info.getName().toUri()));
   ui->NameSpaceData->setText(QString::fromStdString(info.getSyncPrefix().toUri()));
@@ -141,6 +184,10 @@ DiscoveryPanel::onChatroomInfoReady(const ChatroomInfo& info, bool isParticipant
     ui->requestInvitation->setEnabled(false);
     ui->InChatroomWarning->setText(QString("You are already in this chatroom"));
   }
+  else if (isStale) {
+    ui->InChatroomWarning->setText(QString("Cached information, waiting for the chatroom "
+                                           "to be seen again"));
+  }
 
   std::list<Name>roster = info.getParticipants();
   m_rosterList.clear();
@@ -166,6 +213,9 @@ DiscoveryPanel::onSelectedChatroomChanged(const QItemSelection& selected,
                                           const QItemSelection& deselected)
 {
   QModelIndexList items = selected.indexes();
+  // the selected chatroom may have been removed from the list
+  if (items.isEmpty())
+    return;
   QString chatroomName = m_chatroomListModel->data(items.first(), Qt::DisplayRole).toString();
 
   bool chatroomFound = false;
@@ -100,14 +100,27 @@ public slots:
   void
   onChatroomListReady(const QStringList& list);
 
+  /**
+   * @brief apply the changes of the chatroom list on the panel
+   *
+   * Rows are inserted and removed in place so that the selection is kept, large batches
+   * rebuild the list at once.
+   *
+   * @param added chatrooms to add
+   * @param removed chatrooms to remove
+   */
+  void
+  onChatroomListChanged(const QStringList& added, const QStringList& removed);
+
   /**
    * @brief print the chatroom info on the panel
    *
    * @param info chatroom info get from discovery backend
    * @param isParticipant if the user is a participant of the chatroom
+   * @param isStale if the info comes from the discovery cache and is not confirmed yet
    */
   void
-  onChatroomInfoReady(const ChatroomInfo& info, bool isParticipant);
+  onChatroomInfoReady(const ChatroomInfo& info, bool isParticipant, bool isStale);
 
 private slots:
   void
@@ -134,7 +147,7 @@ private:
   QStringListModel* m_chatroomListModel;
   QStringListModel* m_rosterListModel;
 
-  // Internal data structure.
+  // Internal data structure, the chatroom list is kept sorted.
   QStringList m_chatroomList;
   QStringList m_rosterList;
   QString     m_chatroom;
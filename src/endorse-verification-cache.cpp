@@ -0,0 +1,47 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "endorse-verification-cache.hpp"
+
+#include <ndn-cxx/security/verification-helpers.hpp>
+
+namespace chronochat {
+
+bool
+EndorseVerificationCache::verify(const EndorseCertificate& cert, const Name& endorsee,
+                                 const function<shared_ptr<Contact>(const Name&)>& findContact,
+                                 const TrustScopeIndex& trustScopes)
+{
+  if (!cert.isValid())
+    return false;
+
+  auto key = std::make_pair(cert.getFullName(), cert.getSigner());
+  auto it = m_verdicts.find(key);
+  if (it != m_verdicts.end())
+    return it->second;
+
+  shared_ptr<Contact> signer = findContact(cert.getSigner());
+  bool verdict = doVerify(cert, endorsee, signer.get(), trustScopes);
+  m_verdicts.emplace(std::move(key), verdict);
+  return verdict;
+}
+
+bool
+EndorseVerificationCache::doVerify(const EndorseCertificate& cert, const Name& endorsee,
+                                   Contact* signer, const TrustScopeIndex& trustScopes)
+{
+  if (signer == nullptr)
+    return false;
+
+  if (!signer->isIntroducer() || !trustScopes.canVouch(signer->getNameSpace(), endorsee))
+    return false;
+
+  return ndn::security::verifySignature(cert, signer->getPublicKey().data(),
+                                        signer->getPublicKey().size());
+}
+
+} // namespace chronochat
@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_ENDORSE_VERIFICATION_CACHE_HPP
+#define CHRONOCHAT_ENDORSE_VERIFICATION_CACHE_HPP
+
+#include "common.hpp"
+#include "contact.hpp"
+#include "endorse-certificate.hpp"
+#include "trust-scope-index.hpp"
+
+namespace chronochat {
+
+/**
+ * @brief the memoized verdicts on endorse certificates
+ *
+ * A verdict tells whether an endorse certificate is signed by an introducer that is trusted
+ * for the endorsee. It is indexed by the full name of the certificate, which carries its
+ * digest, and by the signer. The verdicts depend on the keys, introducer flags and trust scopes
+ * of the contacts, so the cache must be cleared when any of them changes.
+ */
+class EndorseVerificationCache
+{
+public:
+  /**
+   * @brief get the verdict on @p cert, computing it on a miss
+   *
+   * @param cert the endorse certificate, its validity period is checked on every call
+   * @param endorsee the identity that is endorsed
+   * @param findContact returns the signer contact, only called on a miss
+   * @param trustScopes the trust scopes of the introducers, only used on a miss
+   */
+  bool
+  verify(const EndorseCertificate& cert, const Name& endorsee,
+         const function<shared_ptr<Contact>(const Name&)>& findContact,
+         const TrustScopeIndex& trustScopes);
+
+  void
+  clear();
+
+  size_t
+  size() const;
+
+private:
+  static bool
+  doVerify(const EndorseCertificate& cert, const Name& endorsee, Contact* signer,
+           const TrustScopeIndex& trustScopes);
+
+private:
+  std::map<std::pair<Name, Name>, bool> m_verdicts;
+};
+
+inline void
+EndorseVerificationCache::clear()
+{
+  m_verdicts.clear();
+}
+
+inline size_t
+EndorseVerificationCache::size() const
+{
+  return m_verdicts.size();
+}
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_ENDORSE_VERIFICATION_CACHE_HPP
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "fetch-pipeline.hpp"
+
+namespace chronochat {
+
+FetchPipeline::FetchPipeline(size_t windowSize)
+  : m_windowSize(std::max<size_t>(windowSize, 1))
+  , m_nInFlight(0)
+  , m_maxInFlight(0)
+  , m_isStarted(false)
+  , m_isFilling(false)
+{
+}
+
+void
+FetchPipeline::add(const Fetch& fetch)
+{
+  m_queue.push_back(fetch);
+
+  if (m_isStarted && !m_isFilling)
+    fill();
+}
+
+void
+FetchPipeline::start(const function<void()>& onFinished)
+{
+  BOOST_ASSERT(!m_isStarted);
+
+  m_onFinished = onFinished;
+  m_isStarted = true;
+  fill();
+}
+
+void
+FetchPipeline::fill()
+{
+  // keep the pipeline alive until fill() returns, the last fetch may release it
+  shared_ptr<FetchPipeline> self = shared_from_this();
+
+  m_isFilling = true;
+  while (m_nInFlight < m_windowSize && !m_queue.empty()) {
+    Fetch fetch = std::move(m_queue.front());
+    m_queue.pop_front();
+
+    m_nInFlight++;
+    m_maxInFlight = std::max(m_maxInFlight, m_nInFlight);
+    fetch([self] { self->onFetchDone(); });
+  }
+  m_isFilling = false;
+
+  if (m_nInFlight == 0 && m_queue.empty() && m_onFinished) {
+    function<void()> onFinished = std::move(m_onFinished);
+    m_onFinished = nullptr;
+    onFinished();
+  }
+}
+
+void
+FetchPipeline::onFetchDone()
+{
+  BOOST_ASSERT(m_nInFlight > 0);
+  m_nInFlight--;
+
+  if (!m_isFilling)
+    fill();
+}
+
+} // namespace chronochat
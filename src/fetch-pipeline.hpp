@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_FETCH_PIPELINE_HPP
+#define CHRONOCHAT_FETCH_PIPELINE_HPP
+
+#include "common.hpp"
+#include <deque>
+
+namespace chronochat {
+
+/**
+ * @brief a window of asynchronous fetches
+ *
+ * Fetches are started in the order they were added, with at most a window of them in flight;
+ * a new one is started as soon as one completes, whatever the order of completion. Once all
+ * of them are completed, the finish callback is called.
+ *
+ * The pipeline must be owned by a shared_ptr: it stays alive while fetches are in flight.
+ */
+class FetchPipeline : public std::enable_shared_from_this<FetchPipeline>
+{
+public:
+  /**
+   * @brief a fetch, it must call @p done exactly once when it completes, whatever its outcome
+   */
+  typedef function<void(const function<void()>& done)> Fetch;
+
+  explicit
+  FetchPipeline(size_t windowSize);
+
+  void
+  add(const Fetch& fetch);
+
+  /**
+   * @brief start the fetches
+   *
+   * @param onFinished called once all the fetches are completed, right away if there is none
+   */
+  void
+  start(const function<void()>& onFinished);
+
+  size_t
+  getNInFlight() const
+  {
+    return m_nInFlight;
+  }
+
+  /**
+   * @return the largest number of fetches that were in flight at the same time
+   */
+  size_t
+  getMaxInFlight() const
+  {
+    return m_maxInFlight;
+  }
+
+private:
+  void
+  fill();
+
+  void
+  onFetchDone();
+
+private:
+  size_t m_windowSize;
+  std::deque<Fetch> m_queue;
+  size_t m_nInFlight;
+  size_t m_maxInFlight;
+  bool m_isStarted;
+  // set while fill() starts fetches, so that fetches completing synchronously do not recurse
+  bool m_isFilling;
+  function<void()> m_onFinished;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_FETCH_PIPELINE_HPP
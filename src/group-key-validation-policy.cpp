@@ -0,0 +1,54 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "group-key-validation-policy.hpp"
+
+namespace chronochat {
+
+using ndn::security::ValidationError;
+using ndn::security::ValidationState;
+
+GroupKeyValidationPolicy::GroupKeyValidationPolicy(const GetGroupKey& getGroupKey)
+  : m_getGroupKey(getGroupKey)
+{
+}
+
+void
+GroupKeyValidationPolicy::checkPolicy(const Data& data, const shared_ptr<ValidationState>& state,
+                                      const ValidationContinuation& continueValidation)
+{
+  if (data.getSignatureInfo().getSignatureType() != ndn::tlv::SignatureHmacWithSha256) {
+    getInnerPolicy().checkPolicy(data, state, continueValidation);
+    return;
+  }
+
+  shared_ptr<const GroupKey> key = m_getGroupKey();
+  if (key == nullptr) {
+    state->fail({ValidationError::INVALID_KEY_LOCATOR,
+                 "No group key for " + data.getName().toUri()});
+    return;
+  }
+
+  if (!key->verify(data)) {
+    state->fail({ValidationError::INVALID_SIGNATURE, "Not signed with group key " +
+                 key->getName().toUri()});
+    return;
+  }
+
+  // no certificate to retrieve, the data is valid
+  continueValidation(nullptr, state);
+}
+
+void
+GroupKeyValidationPolicy::checkPolicy(const Interest& interest,
+                                      const shared_ptr<ValidationState>& state,
+                                      const ValidationContinuation& continueValidation)
+{
+  getInnerPolicy().checkPolicy(interest, state, continueValidation);
+}
+
+} // namespace chronochat
@@ -0,0 +1,49 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_GROUP_KEY_VALIDATION_POLICY_HPP
+#define CHRONOCHAT_GROUP_KEY_VALIDATION_POLICY_HPP
+
+#include "common.hpp"
+#include "group-key.hpp"
+
+#include <ndn-cxx/security/validation-policy.hpp>
+
+namespace chronochat {
+
+/**
+ * @brief validate the chat data signed with the group key of the chatroom
+ *
+ * The data signed with HMAC-SHA256 is checked against the current group key, without any
+ * certificate. Every other packet is passed to the inner policy, which must be set.
+ */
+class GroupKeyValidationPolicy : public ndn::security::ValidationPolicy
+{
+public:
+  typedef function<shared_ptr<const GroupKey>()> GetGroupKey;
+
+  /**
+   * @param getGroupKey get the current group key, or nullptr if there is none
+   */
+  explicit
+  GroupKeyValidationPolicy(const GetGroupKey& getGroupKey);
+
+  void
+  checkPolicy(const Data& data, const shared_ptr<ndn::security::ValidationState>& state,
+              const ValidationContinuation& continueValidation) override;
+
+  void
+  checkPolicy(const Interest& interest, const shared_ptr<ndn::security::ValidationState>& state,
+              const ValidationContinuation& continueValidation) override;
+
+private:
+  GetGroupKey m_getGroupKey;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_GROUP_KEY_VALIDATION_POLICY_HPP
@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "group-key.hpp"
+
+#include <ndn-cxx/encoding/buffer-stream.hpp>
+#include <ndn-cxx/security/transform/bool-sink.hpp>
+#include <ndn-cxx/security/transform/buffer-source.hpp>
+#include <ndn-cxx/security/transform/public-key.hpp>
+#include <ndn-cxx/security/transform/signer-filter.hpp>
+#include <ndn-cxx/security/transform/stream-sink.hpp>
+#include <ndn-cxx/security/transform/verifier-filter.hpp>
+#include <ndn-cxx/util/random.hpp>
+
+namespace chronochat {
+
+namespace transform = ndn::security::transform;
+
+static const size_t SECRET_SIZE = 32;
+
+GroupKey::GroupKey(const Name& name, const ndn::Buffer& secret)
+  : m_name(name)
+  , m_secret(secret)
+{
+  loadHmacKey();
+}
+
+GroupKey::GroupKey(const Block& groupKeyWire)
+{
+  wireDecode(groupKeyWire);
+}
+
+GroupKey::GroupKey(const Block& encryptedWire, const transform::PrivateKey& privateKey)
+{
+  if (encryptedWire.type() != tlv::EncryptedGroupKey)
+    NDN_THROW(Error("Unexpected TLV number when decoding encrypted group key"));
+
+  encryptedWire.parse();
+  Block::element_const_iterator i = encryptedWire.elements_begin();
+
+  if (i == encryptedWire.elements_end() || i->type() != tlv::Name)
+    NDN_THROW(Error("Missing Name"));
+  m_name.wireDecode(*i);
+  ++i;
+
+  if (i == encryptedWire.elements_end() || i->type() != tlv::EncryptedGroupKeySecret)
+    NDN_THROW(Error("Missing Encrypted Group Key Secret"));
+  ndn::ConstBufferPtr secret;
+  try {
+    secret = privateKey.decrypt(i->value(), i->value_size());
+  }
+  catch (const transform::PrivateKey::Error&) {
+    NDN_THROW_NESTED(Error("Cannot decrypt Group Key Secret"));
+  }
+  if (secret->empty())
+    NDN_THROW(Error("Empty Group Key Secret"));
+  m_secret = *secret;
+  ++i;
+
+  if (i != encryptedWire.elements_end())
+    NDN_THROW(Error("Unexpected element"));
+
+  loadHmacKey();
+}
+
+shared_ptr<GroupKey>
+GroupKey::generate(const Name& chatroomPrefix)
+{
+  ndn::Buffer secret(SECRET_SIZE);
+  ndn::random::generateSecureBytes(secret.data(), secret.size());
+
+  Name name(chatroomPrefix);
+  name.append("GROUP-KEY").appendVersion();
+  return std::make_shared<GroupKey>(name, secret);
+}
+
+Block
+GroupKey::wireEncode() const
+{
+  ndn::EncodingBuffer buffer;
+
+  size_t totalLength = prependByteArrayBlock(buffer, tlv::GroupKeySecret,
+                                             m_secret.data(), m_secret.size());
+  totalLength += m_name.wireEncode(buffer);
+  totalLength += buffer.prependVarNumber(totalLength);
+  totalLength += buffer.prependVarNumber(tlv::GroupKey);
+
+  return buffer.block();
+}
+
+void
+GroupKey::wireDecode(const Block& groupKeyWire)
+{
+  if (groupKeyWire.type() != tlv::GroupKey)
+    NDN_THROW(Error("Unexpected TLV number when decoding group key"));
+
+  groupKeyWire.parse();
+  Block::element_const_iterator i = groupKeyWire.elements_begin();
+
+  if (i == groupKeyWire.elements_end() || i->type() != tlv::Name)
+    NDN_THROW(Error("Missing Name"));
+  m_name.wireDecode(*i);
+  ++i;
+
+  if (i == groupKeyWire.elements_end() || i->type() != tlv::GroupKeySecret)
+    NDN_THROW(Error("Missing Group Key Secret"));
+  if (i->value_size() == 0)
+    NDN_THROW(Error("Empty Group Key Secret"));
+  m_secret = ndn::Buffer(i->value(), i->value_size());
+  ++i;
+
+  if (i != groupKeyWire.elements_end())
+    NDN_THROW(Error("Unexpected element"));
+
+  loadHmacKey();
+}
+
+Block
+GroupKey::wireEncodeEncrypted(const uint8_t* publicKey, size_t publicKeySize) const
+{
+  ndn::ConstBufferPtr encryptedSecret;
+  try {
+    transform::PublicKey key;
+    key.loadPkcs8(publicKey, publicKeySize);
+    encryptedSecret = key.encrypt(m_secret.data(), m_secret.size());
+  }
+  catch (const transform::PublicKey::Error&) {
+    NDN_THROW_NESTED(Error("Cannot encrypt Group Key Secret"));
+  }
+
+  ndn::EncodingBuffer buffer;
+
+  size_t totalLength = prependByteArrayBlock(buffer, tlv::EncryptedGroupKeySecret,
+                                             encryptedSecret->data(), encryptedSecret->size());
+  totalLength += m_name.wireEncode(buffer);
+  totalLength += buffer.prependVarNumber(totalLength);
+  totalLength += buffer.prependVarNumber(tlv::EncryptedGroupKey);
+
+  return buffer.block();
+}
+
+void
+GroupKey::sign(Data& data) const
+{
+  data.setSignatureInfo(ndn::SignatureInfo(ndn::tlv::SignatureHmacWithSha256,
+                                           ndn::KeyLocator(m_name)));
+
+  ndn::EncodingBuffer encoder;
+  data.wireEncode(encoder, true);
+  ndn::ConstBufferPtr value = computeHmac(encoder.buf(), encoder.size());
+  data.wireEncode(encoder, Block(ndn::tlv::SignatureValue, value));
+}
+
+bool
+GroupKey::verify(const Data& data) const
+{
+  const ndn::SignatureInfo& info = data.getSignatureInfo();
+  if (info.getSignatureType() != ndn::tlv::SignatureHmacWithSha256 ||
+      !info.hasKeyLocator() ||
+      info.getKeyLocator().getType() != ndn::tlv::Name ||
+      info.getKeyLocator().getName() != m_name)
+    return false;
+
+  const Block& wire = data.wireEncode();
+  wire.parse();
+  Block::element_const_iterator signatureValue = wire.find(ndn::tlv::SignatureValue);
+  if (signatureValue == wire.elements_end())
+    return false;
+
+  // the signed portion runs from the Name to the end of the SignatureInfo, the verifier filter
+  // compares the HMAC in constant time
+  bool result = false;
+  try {
+    transform::bufferSource(wire.value(), signatureValue->wire() - wire.value()) >>
+      transform::verifierFilter(ndn::DigestAlgorithm::SHA256, *m_hmacKey,
+                                signatureValue->value(), signatureValue->value_size()) >>
+      transform::boolSink(result);
+  }
+  catch (const transform::Error&) {
+    return false;
+  }
+  return result;
+}
+
+ndn::ConstBufferPtr
+GroupKey::computeHmac(const uint8_t* buffer, size_t size) const
+{
+  ndn::OBufferStream os;
+  transform::bufferSource(buffer, size) >>
+    transform::signerFilter(ndn::DigestAlgorithm::SHA256, *m_hmacKey) >>
+    transform::streamSink(os);
+  return os.buf();
+}
+
+void
+GroupKey::loadHmacKey()
+{
+  auto key = std::make_shared<transform::PrivateKey>();
+  key->loadRaw(ndn::KeyType::HMAC, m_secret.data(), m_secret.size());
+  m_hmacKey = std::move(key);
+}
+
+shared_ptr<const GroupKey>
+GroupKeyStore::find(const std::string& chatroom) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_keys.find(chatroom);
+  if (it == m_keys.end())
+    return nullptr;
+  return it->second;
+}
+
+shared_ptr<const GroupKey>
+GroupKeyStore::create(const std::string& chatroom, const Name& chatroomPrefix)
+{
+  shared_ptr<const GroupKey> key = GroupKey::generate(chatroomPrefix);
+  insert(chatroom, key);
+  return key;
+}
+
+void
+GroupKeyStore::insert(const std::string& chatroom, shared_ptr<const GroupKey> key)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_keys[chatroom] = std::move(key);
+}
+
+void
+GroupKeyStore::erase(const std::string& chatroom)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_keys.erase(chatroom);
+}
+
+void
+GroupKeyStore::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_keys.clear();
+}
+
+} // namespace chronochat
@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_GROUP_KEY_HPP
+#define CHRONOCHAT_GROUP_KEY_HPP
+
+#include "common.hpp"
+#include "tlv.hpp"
+
+#include <mutex>
+#include <ndn-cxx/encoding/buffer.hpp>
+#include <ndn-cxx/security/transform/private-key.hpp>
+
+namespace chronochat {
+
+/**
+ * @brief the symmetric key shared by the members of a chatroom
+ *
+ * The chat data of the room is signed with HMAC-SHA256 under this key, which costs a few hash
+ * compressions instead of an asymmetric signature per message. The key is named under the
+ * chatroom prefix, the KeyLocator of the signed data carries this name.
+ *
+ * Every holder of the key can sign for every session of the room: the key authenticates the
+ * membership of the room, not the member.
+ *
+ *     GroupKey := GROUP-KEY-TYPE TLV-LENGTH
+ *                   Name
+ *                   GroupKeySecret
+ *
+ *     GroupKeySecret := GROUP-KEY-SECRET-TYPE TLV-LENGTH
+ *                         BYTE+
+ *
+ * The key is handed to a new member with its secret encrypted to a public key of the member:
+ *
+ *     EncryptedGroupKey := ENCRYPTED-GROUP-KEY-TYPE TLV-LENGTH
+ *                            Name
+ *                            EncryptedGroupKeySecret
+ *
+ *     EncryptedGroupKeySecret := ENCRYPTED-GROUP-KEY-SECRET-TYPE TLV-LENGTH
+ *                                  BYTE+
+ */
+class GroupKey
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    explicit
+    Error(const std::string& what)
+      : std::runtime_error(what)
+    {
+    }
+  };
+
+  GroupKey(const Name& name, const ndn::Buffer& secret);
+
+  explicit
+  GroupKey(const Block& groupKeyWire);
+
+  /**
+   * @brief decode an EncryptedGroupKey, whose secret is decrypted with @p privateKey
+   *
+   * @throw Error the block is malformed, or the secret cannot be decrypted with the key
+   */
+  GroupKey(const Block& encryptedWire, const ndn::security::transform::PrivateKey& privateKey);
+
+  /**
+   * @brief create a key with a random secret, named under @p chatroomPrefix
+   */
+  static shared_ptr<GroupKey>
+  generate(const Name& chatroomPrefix);
+
+  const Name&
+  getName() const
+  {
+    return m_name;
+  }
+
+  Block
+  wireEncode() const;
+
+  void
+  wireDecode(const Block& groupKeyWire);
+
+  /**
+   * @brief encode the key as an EncryptedGroupKey, with the secret encrypted to @p publicKey
+   *
+   * @param publicKey an RSA public key in PKCS #8, the secret is encrypted with RSA-OAEP
+   * @throw Error the public key cannot be loaded or cannot encrypt
+   */
+  Block
+  wireEncodeEncrypted(const uint8_t* publicKey, size_t publicKeySize) const;
+
+  /**
+   * @brief sign @p data, which replaces its SignatureInfo
+   */
+  void
+  sign(Data& data) const;
+
+  /**
+   * @return whether @p data is signed with this key
+   */
+  bool
+  verify(const Data& data) const;
+
+  /**
+   * @brief compute the HMAC-SHA256 of a buffer under this key (RFC 2104)
+   */
+  ndn::ConstBufferPtr
+  computeHmac(const uint8_t* buffer, size_t size) const;
+
+private:
+  /**
+   * @brief load the secret as the HMAC key of the signer and verifier filters
+   */
+  void
+  loadHmacKey();
+
+private:
+  Name m_name;
+  ndn::Buffer m_secret;
+  shared_ptr<ndn::security::transform::PrivateKey> m_hmacKey;
+};
+
+/**
+ * @brief the group keys of the chatrooms, by chatroom name
+ *
+ * The store is shared by the controller and its backend thread, it is thread-safe.
+ */
+class GroupKeyStore
+{
+public:
+  /**
+   * @return the key of @p chatroom, or nullptr if there is none
+   */
+  shared_ptr<const GroupKey>
+  find(const std::string& chatroom) const;
+
+  /**
+   * @brief generate a key for @p chatroom, which replaces the previous one
+   */
+  shared_ptr<const GroupKey>
+  create(const std::string& chatroom, const Name& chatroomPrefix);
+
+  void
+  insert(const std::string& chatroom, shared_ptr<const GroupKey> key);
+
+  void
+  erase(const std::string& chatroom);
+
+  void
+  clear();
+
+private:
+  mutable std::mutex m_mutex;
+  std::map<std::string, shared_ptr<const GroupKey>> m_keys;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_GROUP_KEY_HPP
@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "interest-coalescer.hpp"
+
+namespace chronochat {
+
+void
+InterestCoalescer::request(const Interest& interest,
+                           const ndn::security::DataValidationSuccessCallback& onValidated,
+                           const ndn::security::DataValidationFailureCallback& onValidationFailed,
+                           const TimeoutCallback& onTimeout,
+                           const Send& send)
+{
+  Key key(interest.getName(), interest.getCanBePrefix(), interest.getMustBeFresh());
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_pending.find(key);
+    if (it != m_pending.end()) {
+      it->second.push_back({onValidated, onValidationFailed, onTimeout});
+      m_nCoalesced++;
+      return;
+    }
+    m_pending[key].push_back({onValidated, onValidationFailed, onTimeout});
+  }
+
+  send(interest,
+       [this, key] (const Data& data) {
+         for (const auto& waiter : takeWaiters(key))
+           waiter.onValidated(data);
+       },
+       [this, key] (const Data& data, const ndn::security::ValidationError& error) {
+         for (const auto& waiter : takeWaiters(key))
+           waiter.onValidationFailed(data, error);
+       },
+       [this, key] (const Interest& timedOut) {
+         for (const auto& waiter : takeWaiters(key))
+           waiter.onTimeout(timedOut);
+       });
+}
+
+std::vector<InterestCoalescer::Waiter>
+InterestCoalescer::takeWaiters(const Key& key)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::vector<Waiter> waiters;
+  auto it = m_pending.find(key);
+  if (it != m_pending.end()) {
+    waiters.swap(it->second);
+    m_pending.erase(it);
+  }
+  return waiters;
+}
+
+size_t
+InterestCoalescer::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pending.size();
+}
+
+size_t
+InterestCoalescer::getNCoalesced() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nCoalesced;
+}
+
+} // namespace chronochat
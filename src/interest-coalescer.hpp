@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_INTEREST_COALESCER_HPP
+#define CHRONOCHAT_INTEREST_COALESCER_HPP
+
+#include "common.hpp"
+#include <ndn-cxx/security/validation-callback.hpp>
+#include <mutex>
+#include <tuple>
+
+namespace chronochat {
+
+/**
+ * @brief merges concurrent requests for the same Data
+ *
+ * Requests are keyed by the name, CanBePrefix and MustBeFresh of their Interest. Only the
+ * first request of a key is sent, the ones arriving while it is outstanding wait for its
+ * outcome, which is then handed to all of them: the validated Data, the validation failure or
+ * the timeout.
+ *
+ * The coalescer is safe to use from several threads, callbacks are called without its lock.
+ */
+class InterestCoalescer
+{
+public:
+  typedef function<void(const Interest&)> TimeoutCallback;
+
+  /**
+   * @brief sends an Interest, it must call exactly one of the callbacks once
+   */
+  typedef function<void(const Interest& interest,
+                        const ndn::security::DataValidationSuccessCallback& onValidated,
+                        const ndn::security::DataValidationFailureCallback& onValidationFailed,
+                        const TimeoutCallback& onTimeout)> Send;
+
+  /**
+   * @brief request the Data of @p interest
+   *
+   * @param send called only if no identical request is outstanding
+   */
+  void
+  request(const Interest& interest,
+          const ndn::security::DataValidationSuccessCallback& onValidated,
+          const ndn::security::DataValidationFailureCallback& onValidationFailed,
+          const TimeoutCallback& onTimeout,
+          const Send& send);
+
+  /**
+   * @return the number of outstanding Interests
+   */
+  size_t
+  size() const;
+
+  /**
+   * @return the number of requests that were merged into an outstanding one
+   */
+  size_t
+  getNCoalesced() const;
+
+private:
+  typedef std::tuple<Name, bool, bool> Key;
+
+  class Waiter
+  {
+  public:
+    ndn::security::DataValidationSuccessCallback onValidated;
+    ndn::security::DataValidationFailureCallback onValidationFailed;
+    TimeoutCallback onTimeout;
+  };
+
+  /**
+   * @brief remove the waiters of @p key, they get the outcome of the request
+   */
+  std::vector<Waiter>
+  takeWaiters(const Key& key);
+
+private:
+  std::map<Key, std::vector<Waiter>> m_pending;
+  size_t m_nCoalesced = 0;
+
+  mutable std::mutex m_mutex;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_INTEREST_COALESCER_HPP
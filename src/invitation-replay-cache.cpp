@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "invitation-replay-cache.hpp"
+
+#include <ndn-cxx/util/sha256.hpp>
+
+#include <algorithm>
+
+namespace chronochat {
+
+// an inviter retries an invitation with the same name for about a minute
+static const time::milliseconds MAX_AGE = time::minutes(2);
+static const time::milliseconds MAX_CLOCK_SKEW = time::minutes(1);
+// how long a validation, with the fetch of the certificate of the inviter, may take
+static const time::milliseconds PENDING_LIFETIME = time::seconds(30);
+// the validations, whoever the inviters claim to be
+static const double VALIDATION_BURST = 64;
+static const time::milliseconds VALIDATION_INTERVAL = time::milliseconds(100);
+// the invitations shown, per validated inviter
+static const double RATE_BURST = 10;
+static const time::milliseconds RATE_INTERVAL = time::seconds(3);
+static const size_t MAX_INVITERS = 256;
+
+InvitationReplayCache::InvitationReplayCache(size_t capacity)
+  : m_capacity(std::max<size_t>(capacity, 1))
+  , m_sequence(0)
+  , m_validationBucket{VALIDATION_BURST, time::steady_clock::now()}
+{
+}
+
+InvitationReplayCache::Decision
+InvitationReplayCache::check(const Name& interestName, const Invitation& invitation)
+{
+  time::steady_clock::TimePoint now = time::steady_clock::now();
+  std::string key = makeKey(interestName);
+
+  auto it = m_entries.find(key);
+  if (it != m_entries.end() && it->second.expiry > now)
+    return it->second.verdict == INVALID ? KNOWN_INVALID : DUPLICATE;
+
+  time::system_clock::TimePoint timestamp =
+    time::fromUnixTimestamp(time::milliseconds(invitation.getTimestamp()));
+  time::system_clock::TimePoint wallNow = time::system_clock::now();
+  if (timestamp + MAX_AGE < wallNow || timestamp > wallNow + MAX_CLOCK_SKEW)
+    return REPLAY;
+
+  if (!takeToken(m_validationBucket, VALIDATION_BURST, VALIDATION_INTERVAL, now))
+    return RATE_LIMITED;
+
+  insert(key, PENDING, now + PENDING_LIFETIME);
+  return PROCESS;
+}
+
+bool
+InvitationReplayCache::setVerdict(const Name& interestName, const Invitation& invitation,
+                                  bool isValid)
+{
+  time::steady_clock::TimePoint now = time::steady_clock::now();
+
+  // remembered until the timestamp of the invitation is out of the window
+  insert(makeKey(interestName), isValid ? VALID : INVALID, now + MAX_AGE + MAX_CLOCK_SKEW);
+
+  // the inviter is known once the invitation is valid
+  return isValid && takeInviterToken(invitation, now);
+}
+
+void
+InvitationReplayCache::erase(const Name& interestName)
+{
+  m_entries.erase(makeKey(interestName));
+}
+
+std::string
+InvitationReplayCache::makeKey(const Name& interestName)
+{
+  const Block& wire = interestName.wireEncode();
+  ndn::ConstBufferPtr digest = ndn::util::Sha256::computeDigest(wire.wire(), wire.size());
+  return std::string(reinterpret_cast<const char*>(digest->data()), digest->size());
+}
+
+void
+InvitationReplayCache::insert(const std::string& key, Verdict verdict,
+                              const time::steady_clock::TimePoint& expiry)
+{
+  auto it = m_entries.find(key);
+  if (it != m_entries.end()) {
+    it->second.verdict = verdict;
+    it->second.expiry = expiry;
+    return;
+  }
+
+  m_sequence++;
+  m_entries[key] = Entry{verdict, expiry, m_sequence};
+  m_order.emplace_back(key, m_sequence);
+
+  // the keys erased or inserted again since are skipped
+  while (!m_order.empty()) {
+    auto oldest = m_entries.find(m_order.front().first);
+    bool isCurrent = oldest != m_entries.end() &&
+                     oldest->second.sequence == m_order.front().second;
+    if (isCurrent && m_entries.size() <= m_capacity)
+      break;
+    if (isCurrent)
+      m_entries.erase(oldest);
+    m_order.pop_front();
+  }
+}
+
+bool
+InvitationReplayCache::takeToken(Bucket& bucket, double burst, const time::milliseconds& interval,
+                                 const time::steady_clock::TimePoint& now)
+{
+  double nIntervals = static_cast<double>((now - bucket.lastRefill).count()) /
+                      time::steady_clock::duration(interval).count();
+  bucket.nTokens = std::min(burst, bucket.nTokens + nIntervals);
+  bucket.lastRefill = now;
+
+  if (bucket.nTokens < 1)
+    return false;
+  bucket.nTokens -= 1;
+  return true;
+}
+
+bool
+InvitationReplayCache::takeInviterToken(const Invitation& invitation,
+                                        const time::steady_clock::TimePoint& now)
+{
+  Name inviter = ndn::security::extractIdentityFromCertName(
+    invitation.getInviterCertificateName().getPrefix(-1));
+
+  auto it = m_inviterBuckets.find(inviter);
+  if (it == m_inviterBuckets.end()) {
+    // the inviter seen least recently gives its place, it comes back with a full bucket
+    if (m_inviterBuckets.size() >= MAX_INVITERS) {
+      auto leastRecent = std::min_element(m_inviterBuckets.begin(), m_inviterBuckets.end(),
+        [] (const std::pair<const Name, Bucket>& a, const std::pair<const Name, Bucket>& b) {
+          return a.second.lastRefill < b.second.lastRefill;
+        });
+      m_inviterBuckets.erase(leastRecent);
+    }
+    it = m_inviterBuckets.emplace(inviter, Bucket{RATE_BURST, now}).first;
+  }
+
+  return takeToken(it->second, RATE_BURST, RATE_INTERVAL, now);
+}
+
+} // namespace chronochat
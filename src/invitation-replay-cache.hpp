@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_INVITATION_REPLAY_CACHE_HPP
+#define CHRONOCHAT_INVITATION_REPLAY_CACHE_HPP
+
+#include "common.hpp"
+#include "invitation.hpp"
+
+#include <deque>
+#include <unordered_map>
+
+namespace chronochat {
+
+/**
+ * @brief the invitations received lately, to drop the ones not worth a validation
+ *
+ * An invitation is known by the digest of its signed name, which includes its timestamp and
+ * its signature: a forged copy of an invitation is another invitation. The retransmissions of
+ * an invitation being validated or already validated are dropped, and so are the ones of an
+ * invitation that failed the validation. An invitation whose timestamp is out of the window
+ * of acceptance is a replay.
+ *
+ * The inviter is not known before the validation, the validations are limited as a whole: a
+ * burst, then one more per interval. Once validated, each inviter may have a burst of
+ * invitations shown, then one more per interval; the inviters seen least recently are
+ * forgotten first.
+ *
+ * The number of invitations remembered is bounded, the oldest ones are forgotten first.
+ */
+class InvitationReplayCache
+{
+public:
+  enum Decision {
+    PROCESS,
+    DUPLICATE,
+    KNOWN_INVALID,
+    REPLAY,
+    RATE_LIMITED
+  };
+
+  explicit
+  InvitationReplayCache(size_t capacity = 1024);
+
+  /**
+   * @brief decide whether @p invitation, received as @p interestName, is to be validated
+   *
+   * An invitation to validate is remembered as pending until its verdict is set.
+   */
+  Decision
+  check(const Name& interestName, const Invitation& invitation);
+
+  /**
+   * @brief remember the outcome of the validation of the invitation received as @p interestName
+   *
+   * @return whether the invitation is valid and within the rate of its inviter
+   */
+  bool
+  setVerdict(const Name& interestName, const Invitation& invitation, bool isValid);
+
+  /**
+   * @brief forget the invitation received as @p interestName, whose validation could not be
+   *        completed
+   */
+  void
+  erase(const Name& interestName);
+
+  size_t
+  size() const
+  {
+    return m_entries.size();
+  }
+
+private:
+  enum Verdict {
+    PENDING,
+    VALID,
+    INVALID
+  };
+
+  class Entry
+  {
+  public:
+    Verdict verdict;
+    time::steady_clock::TimePoint expiry;
+    uint64_t sequence;
+  };
+
+  class Bucket
+  {
+  public:
+    double nTokens;
+    time::steady_clock::TimePoint lastRefill;
+  };
+
+  static std::string
+  makeKey(const Name& interestName);
+
+  void
+  insert(const std::string& key, Verdict verdict, const time::steady_clock::TimePoint& expiry);
+
+  /**
+   * @brief take a token from @p bucket, refilled with @p burst tokens at most, one per
+   *        @p interval
+   *
+   * @return whether there was a token to take
+   */
+  static bool
+  takeToken(Bucket& bucket, double burst, const time::milliseconds& interval,
+            const time::steady_clock::TimePoint& now);
+
+  /**
+   * @return whether the inviter of @p invitation, validated, may have one more invitation shown
+   */
+  bool
+  takeInviterToken(const Invitation& invitation, const time::steady_clock::TimePoint& now);
+
+private:
+  size_t m_capacity;
+  std::unordered_map<std::string, Entry> m_entries;
+  // the keys in the order of insertion, with the sequence of their entry at that time
+  std::deque<std::pair<std::string, uint64_t>> m_order;
+  uint64_t m_sequence;
+
+  Bucket m_validationBucket;
+  std::map<Name, Bucket> m_inviterBuckets;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_INVITATION_REPLAY_CACHE_HPP
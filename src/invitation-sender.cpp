@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "invitation-sender.hpp"
+#include "fetch-pipeline.hpp"
+
+#include <ndn-cxx/security/verification-helpers.hpp>
+
+namespace chronochat {
+
+static const Name::Component ROUTING_HINT_SEPARATOR = Name::Component::fromEscapedString("%F0%2E");
+static const size_t MAX_RETRIES = 2;
+static const time::milliseconds INITIAL_BACKOFF(500);
+// the invitee answers from a dialog, the answer may take a while
+static const time::milliseconds INVITATION_LIFETIME(15000);
+
+class InvitationSender::Batch
+{
+public:
+  std::vector<Invitation> invitations;
+  std::vector<ndn::Buffer> inviteeKeys;
+  // signed once, a retry only changes the nonce
+  std::vector<Interest> interests;
+  std::vector<size_t> nAttempts;
+  ndn::security::SigningInfo signingInfo;
+  shared_ptr<FetchPipeline> pipeline;
+  Progress progress;
+  OutcomeCallback onOutcome;
+  ProgressCallback onProgress;
+};
+
+InvitationSender::InvitationSender(ndn::Face& face, ndn::KeyChain& keyChain,
+                                   const Name& routingPrefix, size_t windowSize)
+  : m_face(face)
+  , m_keyChain(keyChain)
+  , m_scheduler(face.getIoService())
+  , m_routingPrefix(routingPrefix)
+  , m_windowSize(windowSize)
+  , m_maxRetries(MAX_RETRIES)
+  , m_initialBackoff(INITIAL_BACKOFF)
+  , m_interestLifetime(INVITATION_LIFETIME)
+{
+}
+
+void
+InvitationSender::send(const std::vector<Invitation>& invitations,
+                       const std::vector<ndn::Buffer>& inviteeKeys,
+                       const ndn::security::SigningInfo& signingInfo,
+                       const OutcomeCallback& onOutcome,
+                       const ProgressCallback& onProgress)
+{
+  BOOST_ASSERT(inviteeKeys.size() == invitations.size());
+
+  auto batch = std::make_shared<Batch>();
+  batch->invitations = invitations;
+  batch->inviteeKeys = inviteeKeys;
+  batch->interests.resize(invitations.size());
+  batch->nAttempts.assign(invitations.size(), 0);
+  batch->signingInfo = signingInfo;
+  batch->pipeline = std::make_shared<FetchPipeline>(m_windowSize);
+  batch->progress.nInvitations = invitations.size();
+  batch->onOutcome = onOutcome;
+  batch->onProgress = onProgress;
+
+  for (size_t i = 0; i < invitations.size(); i++)
+    batch->pipeline->add([this, batch, i] (const function<void()>& done) {
+      sendOne(batch, i, done);
+    });
+
+  batch->onProgress(batch->progress);
+  // the batch is over once every invitation has an outcome, retries are added to the
+  // pipeline after it may have drained
+  batch->pipeline->start([] {});
+}
+
+Interest
+InvitationSender::makeInterest(const Invitation& invitation,
+                               const ndn::security::SigningInfo& signingInfo)
+{
+  Interest signedInterest(invitation.getUnsignedInterestName());
+  m_keyChain.sign(signedInterest, signingInfo);
+
+  Name interestName;
+  if (!m_routingPrefix.isPrefixOf(invitation.getInviteeNameSpace()))
+    interestName.append(m_routingPrefix).append(ROUTING_HINT_SEPARATOR);
+  interestName.append(signedInterest.getName());
+
+  Interest interest(interestName);
+  // an acceptance is named after the invitation
+  interest.setCanBePrefix(true);
+  interest.setMustBeFresh(true);
+  interest.setInterestLifetime(m_interestLifetime);
+  return interest;
+}
+
+void
+InvitationSender::sendOne(const shared_ptr<Batch>& batch, size_t index,
+                          const function<void()>& done)
+{
+  Interest& interest = batch->interests[index];
+  if (batch->nAttempts[index] == 0)
+    interest = makeInterest(batch->invitations[index], batch->signingInfo);
+  else
+    interest.refreshNonce();
+  batch->nAttempts[index]++;
+
+  m_face.expressInterest(interest,
+    [this, batch, index, done] (const Interest&, const Data& data) {
+      onResponse(batch, index, data);
+      done();
+    },
+    [this, batch, index, done] (const Interest&, const ndn::lp::Nack&) {
+      onNoResponse(batch, index);
+      done();
+    },
+    [this, batch, index, done] (const Interest&) {
+      onNoResponse(batch, index);
+      done();
+    });
+}
+
+void
+InvitationSender::onResponse(const shared_ptr<Batch>& batch, size_t index, const Data& data)
+{
+  // the response is wrapped when the invitee is not under the routing prefix:
+  // <routing_prefix>/%F0./<response>
+  Name wrapperPrefix = Name(m_routingPrefix).append(ROUTING_HINT_SEPARATOR);
+  Data response;
+  try {
+    response = data;
+    if (wrapperPrefix.isPrefixOf(data.getName()))
+      response.wireDecode(data.getContent().blockFromValue());
+  }
+  catch (const tlv::Error&) {
+    finishOne(batch, index, FAILED);
+    return;
+  }
+
+  // the wrapper is signed with a digest only, the response inside must come from the invitee
+  Name invitationName = batch->interests[index].getName();
+  if (wrapperPrefix.isPrefixOf(invitationName))
+    invitationName = invitationName.getSubName(wrapperPrefix.size());
+  const ndn::Buffer& inviteeKey = batch->inviteeKeys[index];
+  if (!invitationName.isPrefixOf(response.getName()) ||
+      !ndn::security::verifySignature(response, inviteeKey.data(), inviteeKey.size())) {
+    onNoResponse(batch, index);
+    return;
+  }
+
+  // an acceptance carries the certificate of the invitee, a rejection is empty
+  finishOne(batch, index, response.getContent().value_size() > 0 ? ACCEPTED : REJECTED);
+}
+
+void
+InvitationSender::onNoResponse(const shared_ptr<Batch>& batch, size_t index)
+{
+  size_t nAttempts = batch->nAttempts[index];
+  if (nAttempts > m_maxRetries) {
+    finishOne(batch, index, FAILED);
+    return;
+  }
+
+  batch->progress.nRetries++;
+  batch->onProgress(batch->progress);
+
+  time::milliseconds backoff = m_initialBackoff * (1 << (nAttempts - 1));
+  m_scheduler.schedule(backoff, [this, batch, index] {
+    batch->pipeline->add([this, batch, index] (const function<void()>& done) {
+      sendOne(batch, index, done);
+    });
+  });
+}
+
+void
+InvitationSender::finishOne(const shared_ptr<Batch>& batch, size_t index, Outcome outcome)
+{
+  switch (outcome) {
+  case ACCEPTED:
+    batch->progress.nAccepted++;
+    break;
+  case REJECTED:
+    batch->progress.nRejected++;
+    break;
+  case FAILED:
+    batch->progress.nFailed++;
+    break;
+  }
+
+  batch->onOutcome(batch->invitations[index], outcome);
+  batch->onProgress(batch->progress);
+}
+
+} // namespace chronochat
@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_INVITATION_SENDER_HPP
+#define CHRONOCHAT_INVITATION_SENDER_HPP
+
+#include "common.hpp"
+#include "invitation.hpp"
+
+#include <ndn-cxx/face.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+
+namespace chronochat {
+
+/**
+ * @brief send the invitations to a chatroom in batch, and gather their outcomes
+ *
+ * The invitations of a batch are sent through a window, each one signed right before it is
+ * sent, so that signing overlaps the invitations in flight. An invitation that times out or
+ * is nacked is sent again after a backoff that doubles with each attempt, and fails once its
+ * retries are exhausted; a retry releases its place in the window while it waits.
+ *
+ * A response counts only if it is named under the invitation and signed with the key of the
+ * invitee, any other answer is taken as no answer.
+ *
+ * The sender must be used from the thread of the face.
+ */
+class InvitationSender
+{
+public:
+  enum Outcome {
+    ACCEPTED,
+    REJECTED,
+    FAILED
+  };
+
+  class Progress
+  {
+  public:
+    size_t
+    getNDone() const
+    {
+      return nAccepted + nRejected + nFailed;
+    }
+
+  public:
+    size_t nInvitations = 0;
+    size_t nAccepted = 0;
+    size_t nRejected = 0;
+    size_t nFailed = 0;
+    size_t nRetries = 0;
+  };
+
+  typedef function<void(const Invitation& invitation, Outcome outcome)> OutcomeCallback;
+  typedef function<void(const Progress& progress)> ProgressCallback;
+
+  /**
+   * @param routingPrefix the prefix invitations are routed under, to invitees not under it
+   * @param windowSize the maximum number of invitations in flight
+   */
+  InvitationSender(ndn::Face& face, ndn::KeyChain& keyChain, const Name& routingPrefix,
+                   size_t windowSize = 32);
+
+  /**
+   * @brief sign and send @p invitations
+   *
+   * @param inviteeKeys the public keys of the invitees, in the order of @p invitations, which
+   *                    their responses must be signed with
+   * @param onOutcome called once for each invitation, when its outcome is known
+   * @param onProgress called when the batch starts, then whenever its progress changes
+   */
+  void
+  send(const std::vector<Invitation>& invitations,
+       const std::vector<ndn::Buffer>& inviteeKeys,
+       const ndn::security::SigningInfo& signingInfo,
+       const OutcomeCallback& onOutcome,
+       const ProgressCallback& onProgress);
+
+  void
+  setRetry(size_t maxRetries, time::milliseconds initialBackoff)
+  {
+    m_maxRetries = maxRetries;
+    m_initialBackoff = initialBackoff;
+  }
+
+  void
+  setInterestLifetime(time::milliseconds lifetime)
+  {
+    m_interestLifetime = lifetime;
+  }
+
+private:
+  class Batch;
+
+  /**
+   * @return the invitation Interest, signed, under the routing prefix if needed
+   */
+  Interest
+  makeInterest(const Invitation& invitation, const ndn::security::SigningInfo& signingInfo);
+
+  void
+  sendOne(const shared_ptr<Batch>& batch, size_t index, const function<void()>& done);
+
+  void
+  onResponse(const shared_ptr<Batch>& batch, size_t index, const Data& data);
+
+  void
+  onNoResponse(const shared_ptr<Batch>& batch, size_t index);
+
+  void
+  finishOne(const shared_ptr<Batch>& batch, size_t index, Outcome outcome);
+
+private:
+  ndn::Face& m_face;
+  ndn::KeyChain& m_keyChain;
+  ndn::Scheduler m_scheduler;
+  Name m_routingPrefix;
+  size_t m_windowSize;
+  size_t m_maxRetries;
+  time::milliseconds m_initialBackoff;
+  time::milliseconds m_interestLifetime;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_INVITATION_SENDER_HPP
@@ -24,6 +24,13 @@ const ssize_t Invitation::INVITER_PREFIX        = -5;
 const ssize_t Invitation::CHATROOM              = -6;
 const ssize_t Invitation::CHRONOCHAT_INVITATION = -7;
 
+const size_t  Invitation::COMPACT_NAME_SIZE_MIN         = 8;
+const ssize_t Invitation::INVITER_CERT_DIGEST           = -4;
+const ssize_t Invitation::INVITER_CERT_NAME             = -5;
+const ssize_t Invitation::COMPACT_INVITER_PREFIX        = -6;
+const ssize_t Invitation::COMPACT_CHATROOM              = -7;
+const ssize_t Invitation::COMPACT_CHRONOCHAT_INVITATION = -8;
+
 
 Invitation::Invitation(const Name& interestName)
 {
@@ -32,33 +39,62 @@ Invitation::Invitation(const Name& interestName)
   if (nameSize < NAME_SIZE_MIN)
     NDN_THROW(Error("Wrong Invitation Name: Wrong length"));
 
-  if (interestName.get(CHRONOCHAT_INVITATION).toUri() != "CHRONOCHAT-INVITATION")
+  // the legacy format carries a certificate where the compact one puts the digest
+  m_isCompact = nameSize >= COMPACT_NAME_SIZE_MIN &&
+                interestName.get(INVITER_CERT_DIGEST).isImplicitSha256Digest();
+
+  ssize_t tag = m_isCompact ? COMPACT_CHRONOCHAT_INVITATION : CHRONOCHAT_INVITATION;
+  if (interestName.get(tag).toUri() != "CHRONOCHAT-INVITATION")
     NDN_THROW(Error("Wrong Invitation Name: Wrong application tags"));
 
-  m_interestName = interestName.getPrefix(KEY_LOCATOR);
-  m_timestamp = interestName.get(TIMESTAMP).toNumber();
-  m_inviterCertificate.wireDecode(interestName.get(INVITER_CERT).blockFromValue());
-  m_inviterRoutingPrefix.wireDecode(interestName.get(INVITER_PREFIX).blockFromValue());
-  m_chatroom = interestName.get(CHATROOM).toUri();
-  m_inviteeNameSpace = interestName.getPrefix(CHRONOCHAT_INVITATION);
+  try {
+    m_interestName = interestName.getPrefix(KEY_LOCATOR);
+    m_timestamp = interestName.get(TIMESTAMP).toNumber();
+    if (m_isCompact) {
+      m_inviterCertificateName.wireDecode(interestName.get(INVITER_CERT_NAME).blockFromValue());
+      if (!Certificate::isValidName(m_inviterCertificateName))
+        NDN_THROW(Error("Wrong Invitation Name: Wrong certificate name"));
+      m_inviterCertificateName.append(interestName.get(INVITER_CERT_DIGEST));
+      m_inviterRoutingPrefix.wireDecode(
+        interestName.get(COMPACT_INVITER_PREFIX).blockFromValue());
+      m_chatroom = interestName.get(COMPACT_CHATROOM).toUri();
+    }
+    else {
+      m_inviterCertificate.wireDecode(interestName.get(INVITER_CERT).blockFromValue());
+      m_inviterCertificateName = m_inviterCertificate.getFullName();
+      m_inviterRoutingPrefix.wireDecode(interestName.get(INVITER_PREFIX).blockFromValue());
+      m_chatroom = interestName.get(CHATROOM).toUri();
+    }
+  }
+  catch (const tlv::Error&) {
+    NDN_THROW(Error("Wrong Invitation Name: Malformed components"));
+  }
+  m_inviteeNameSpace = interestName.getPrefix(tag);
 }
 
 Invitation::Invitation(const Name& inviteeNameSpace,
                        const string& chatroom,
                        const Name& inviterRoutingPrefix,
-                       const Certificate& inviterCertificate)
+                       const Certificate& inviterCertificate,
+                       bool isCompact)
   : m_inviteeNameSpace(inviteeNameSpace)
   , m_chatroom(chatroom)
   , m_inviterRoutingPrefix(inviterRoutingPrefix)
+  , m_inviterCertificateName(inviterCertificate.getFullName())
   , m_inviterCertificate(inviterCertificate)
   , m_timestamp(time::toUnixTimestamp(time::system_clock::now()).count())
+  , m_isCompact(isCompact)
 {
   m_interestName = m_inviteeNameSpace;
   m_interestName.append("CHRONOCHAT-INVITATION")
     .append(m_chatroom)
-    .append(m_inviterRoutingPrefix.wireEncode())
-    .append(m_inviterCertificate.wireEncode())
-    .append(name::Component::fromNumber(m_timestamp));
+    .append(m_inviterRoutingPrefix.wireEncode());
+  if (m_isCompact)
+    m_interestName.append(m_inviterCertificate.getName().wireEncode())
+      .append(m_inviterCertificateName.get(-1));
+  else
+    m_interestName.append(m_inviterCertificate.wireEncode());
+  m_interestName.append(name::Component::fromNumber(m_timestamp));
 }
 
 Invitation::Invitation(const Invitation& invitation)
@@ -66,9 +102,20 @@ Invitation::Invitation(const Invitation& invitation)
   , m_inviteeNameSpace(invitation.m_inviteeNameSpace)
   , m_chatroom(invitation.m_chatroom)
   , m_inviterRoutingPrefix(invitation.m_inviterRoutingPrefix)
+  , m_inviterCertificateName(invitation.m_inviterCertificateName)
   , m_inviterCertificate(invitation.m_inviterCertificate)
   , m_timestamp(invitation.m_timestamp)
+  , m_isCompact(invitation.m_isCompact)
+{
+}
+
+void
+Invitation::setInviterCertificate(const Certificate& inviterCertificate)
 {
+  if (inviterCertificate.getFullName() != m_inviterCertificateName)
+    NDN_THROW(Error("Wrong inviter certificate: " + inviterCertificate.getName().toUri()));
+
+  m_inviterCertificate = inviterCertificate;
 }
 
 } // namespace chronochat
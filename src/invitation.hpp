@@ -40,6 +40,27 @@ public:
   static const ssize_t CHATROOM;
   static const ssize_t CHRONOCHAT_INVITATION;
 
+  /*
+   * The compact format refers to the certificate of the inviter, which the invitee looks up or
+   * fetches, instead of carrying it:
+   *
+   *  /[invitee_namespace]
+   *  /CHRONOCHAT-INVITATION
+   *  /<chatroom_name>
+   *  /<inviter_routing_prefix>
+   *  /<inviter_cert_name>
+   *  /<inviter_cert_digest>
+   *  /<timestamp>
+   *  /<keylocator>
+   *  /<signature>
+   */
+  static const size_t COMPACT_NAME_SIZE_MIN;
+  static const ssize_t INVITER_CERT_DIGEST;
+  static const ssize_t INVITER_CERT_NAME;
+  static const ssize_t COMPACT_INVITER_PREFIX;
+  static const ssize_t COMPACT_CHATROOM;
+  static const ssize_t COMPACT_CHRONOCHAT_INVITATION;
+
   class Error : public std::runtime_error
   {
   public:
@@ -50,15 +71,20 @@ public:
   };
 
   Invitation()
+    : m_isCompact(false)
   {
   }
 
   Invitation(const Name& interestName);
 
+  /**
+   * @param isCompact whether the invitation refers to @p inviterCertificate instead of carrying it
+   */
   Invitation(const Name& inviteeNameSpace,
              const std::string& chatroom,
              const Name& inviterRoutingPrefix,
-             const ndn::security::Certificate& inviterCertificate);
+             const ndn::security::Certificate& inviterCertificate,
+             bool isCompact = true);
 
   Invitation(const Invitation& invitation);
 
@@ -85,12 +111,45 @@ public:
     return m_inviterRoutingPrefix;
   }
 
+  bool
+  isCompact() const
+  {
+    return m_isCompact;
+  }
+
+  /**
+   * @return the full name of the certificate of the inviter, with its implicit digest
+   */
+  const Name&
+  getInviterCertificateName() const
+  {
+    return m_inviterCertificateName;
+  }
+
+  /**
+   * @return whether the certificate of the inviter is known, which is always the case for the
+   *         legacy format
+   */
+  bool
+  hasInviterCertificate() const
+  {
+    return !m_inviterCertificate.getName().empty();
+  }
+
   const ndn::security::Certificate&
   getInviterCertificate() const
   {
     return m_inviterCertificate;
   }
 
+  /**
+   * @brief set the certificate of the inviter, looked up or fetched for a compact invitation
+   *
+   * @throw Error @p inviterCertificate is not the one the invitation refers to
+   */
+  void
+  setInviterCertificate(const ndn::security::Certificate& inviterCertificate);
+
   uint64_t
   getTimestamp() const
   {
@@ -109,8 +168,10 @@ private:
   Name m_inviteeNameSpace;
   std::string m_chatroom;
   Name m_inviterRoutingPrefix;
+  Name m_inviterCertificateName;
   ndn::security::Certificate m_inviterCertificate;
   uint64_t m_timestamp;
+  bool m_isCompact;
 };
 
 } // namespace chronochat
@@ -21,6 +21,8 @@ InviteListDialog::InviteListDialog(QWidget* parent)
   ui->setupUi(this);
 
   ui->contactListView->setModel(m_contactListModel);
+  ui->contactListView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+  ui->progressBar->hide();
 
   connect(ui->inviteButton, SIGNAL(clicked()),
           this, SLOT(onInviteClicked()));
@@ -42,21 +44,59 @@ InviteListDialog::setInviteLabel(std::string label)
   ui->inviteLabel->setText(QString::fromStdString(msg));
 }
 
+void
+InviteListDialog::setChatroom(const QString& chatroom)
+{
+  if (chatroom != m_chatroom) {
+    m_chatroom = chatroom;
+    ui->progressBar->hide();
+    ui->progressLabel->clear();
+    ui->inviteButton->setEnabled(true);
+  }
+  setInviteLabel(chatroom.toStdString());
+}
+
 void
 InviteListDialog::onInviteClicked()
 {
-  QModelIndexList selected = ui->contactListView->selectionModel()->selectedIndexes();
-  QString alias = m_contactListModel->data(selected.first(), Qt::DisplayRole).toString();
-
-  // TODO:: could be optimized without using for loop.
-  for (int i = 0; i < m_contactAliasList.size(); i++) {
-    if (alias == m_contactAliasList[i]) {
-      emit sendInvitation(m_contactIdList[i]);
-      break;
-    }
+  // the aliases are listed in the order of the identities
+  QStringList identities;
+  for (const QModelIndex& index : ui->contactListView->selectionModel()->selectedIndexes()) {
+    if (index.row() < m_contactIdList.size())
+      identities.append(m_contactIdList[index.row()]);
   }
 
-  this->close();
+  if (identities.isEmpty())
+    return;
+
+  ui->inviteButton->setEnabled(false);
+  emit sendInvitations(m_chatroom, identities);
+}
+
+void
+InviteListDialog::onInvitationProgress(QString chatroom, int nAccepted, int nRejected,
+                                       int nFailed, int nInvitations)
+{
+  if (chatroom != m_chatroom)
+    return;
+
+  // none of the identities could be invited
+  if (nInvitations == 0) {
+    ui->progressBar->hide();
+    ui->inviteButton->setEnabled(true);
+    return;
+  }
+
+  int nDone = nAccepted + nRejected + nFailed;
+  ui->progressBar->setRange(0, nInvitations);
+  ui->progressBar->setValue(nDone);
+  ui->progressBar->show();
+  ui->progressLabel->setText(QString("%1 accepted, %2 declined, %3 unanswered, %4 pending")
+                             .arg(nAccepted).arg(nRejected).arg(nFailed)
+                             .arg(nInvitations - nDone));
+
+  if (nDone == nInvitations)
+    ui->inviteButton->setEnabled(true);
 }
 
 void
@@ -33,9 +33,15 @@ public:
   void
   setInviteLabel(std::string label);
 
+  /**
+   * @brief prepare the dialog to invite contacts to @p chatroom
+   */
+  void
+  setChatroom(const QString& chatroom);
+
 signals:
   void
-  sendInvitation(const QString&);
+  sendInvitations(const QString& chatroom, const QStringList& identities);
 
 public slots:
   void
@@ -44,6 +50,10 @@ public slots:
   void
   onContactIdListReady(const QStringList& idList);
 
+  void
+  onInvitationProgress(QString chatroom, int nAccepted, int nRejected, int nFailed,
+                       int nInvitations);
+
 private slots:
   void
   onInviteClicked();
@@ -56,6 +66,7 @@ private:
   QStringListModel* m_contactListModel;
   QStringList m_contactAliasList;
   QStringList m_contactIdList;
+  QString m_chatroom;
 };
 
 } // namespace chronochat
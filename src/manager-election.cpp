@@ -0,0 +1,69 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Qiuhan Ding <qiuhanding@cs.ucla.edu>
+ *         Yingdi Yu <yingdi@cs.ucla.edu>
+ */
+
+#include "manager-election.hpp"
+
+#include <algorithm>
+
+namespace chronochat {
+
+const time::milliseconds ManagerElection::SLOT(500);
+
+// FNV-1a, the hash must be identical on every platform
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint64_t
+hashBlock(uint64_t hash, const Block& block)
+{
+  for (const uint8_t* it = block.wire(); it != block.wire() + block.size(); ++it) {
+    hash ^= *it;
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+uint64_t
+ManagerElection::getPriority(const Name::Component& chatroomName, const Name& participant)
+{
+  uint64_t hash = hashBlock(FNV_OFFSET_BASIS, chatroomName.wireEncode());
+  return hashBlock(hash, participant.wireEncode());
+}
+
+ManagerElection::ManagerElection(const Name::Component& chatroomName,
+                                 const std::list<Name>& candidates)
+{
+  std::vector<std::pair<uint64_t, Name>> ranked;
+  ranked.reserve(candidates.size());
+  for (const auto& candidate : candidates)
+    ranked.emplace_back(getPriority(chatroomName, candidate), candidate);
+
+  // ties are broken by the name, duplicates are dropped
+  std::sort(ranked.begin(), ranked.end());
+  ranked.erase(std::unique(ranked.begin(), ranked.end()), ranked.end());
+
+  m_order.reserve(ranked.size());
+  for (const auto& candidate : ranked)
+    m_order.push_back(candidate.second);
+}
+
+size_t
+ManagerElection::getRank(const Name& participant) const
+{
+  return std::find(m_order.begin(), m_order.end(), participant) - m_order.begin();
+}
+
+time::milliseconds
+ManagerElection::getBackoff(const Name& participant) const
+{
+  return SLOT * static_cast<int64_t>(getRank(participant));
+}
+
+} // namespace chronochat
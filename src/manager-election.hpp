@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ *
+ * Author: Qiuhan Ding <qiuhanding@cs.ucla.edu>
+ *         Yingdi Yu <yingdi@cs.ucla.edu>
+ */
+
+#ifndef CHRONOCHAT_MANAGER_ELECTION_HPP
+#define CHRONOCHAT_MANAGER_ELECTION_HPP
+
+#include "common.hpp"
+
+namespace chronochat {
+
+/**
+ * @brief rank based election of a chatroom manager
+ *
+ * When the manager of a chatroom disappears, every participant ranks the known participants
+ * by a hash of the chatroom name and the participant's routable identity, which is the same
+ * on every node. The participant ranked r takes over after r backoff slots, unless it hears
+ * from a new manager first, so that a single participant publishes in the common case.
+ *
+ * Mixing the chatroom name into the hash spreads the manager role of different chatrooms over
+ * different participants.
+ */
+class ManagerElection
+{
+public:
+  /**
+   * @param chatroomName the name of the chatroom
+   * @param candidates the routable identities of the participants that may take over
+   */
+  ManagerElection(const Name::Component& chatroomName, const std::list<Name>& candidates);
+
+  /**
+   * @brief get the rank of a candidate, 0 being the first to take over
+   *
+   * @return the number of candidates if @p participant is not a candidate
+   */
+  size_t
+  getRank(const Name& participant) const;
+
+  /**
+   * @brief get how long a candidate waits before taking over
+   */
+  time::milliseconds
+  getBackoff(const Name& participant) const;
+
+  /**
+   * @brief get the candidates in the order they take over
+   */
+  const std::vector<Name>&
+  getOrder() const;
+
+  /**
+   * @brief get the hash that orders @p participant in the election of @p chatroomName
+   */
+  static uint64_t
+  getPriority(const Name::Component& chatroomName, const Name& participant);
+
+public:
+  /**
+   * @brief the backoff between two consecutive ranks
+   *
+   * It covers the propagation of a sync update plus the skew between the participants
+   * detecting the loss of the manager.
+   */
+  static const time::milliseconds SLOT;
+
+private:
+  std::vector<Name> m_order;
+};
+
+inline const std::vector<Name>&
+ManagerElection::getOrder() const
+{
+  return m_order;
+}
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_MANAGER_ELECTION_HPP
@@ -11,60 +11,50 @@
 
 namespace chronochat {
 
-static const int CONNECTION_RETRY_TIMER = 2;
-
 NfdConnectionChecker::NfdConnectionChecker(QObject* parent)
-  :QThread(parent)
+  : QThread(parent)
+  , m_nfdConnected(false)
+  , m_monitor(m_ioService)
 {
+  m_monitor.onConnectivityChanged.connect([this] (bool isConnected) {
+      {
+        std::lock_guard<std::mutex>lock(m_nfdMutex);
+        m_nfdConnected = isConnected;
+      }
+      if (isConnected)
+        emit nfdConnected();
+      else
+        emit nfdDisconnected();
+    });
+}
+
+bool
+NfdConnectionChecker::isNfdConnected()
+{
+  std::lock_guard<std::mutex>lock(m_nfdMutex);
+  return m_nfdConnected;
 }
 
 void
 NfdConnectionChecker::run()
 {
-  m_face = unique_ptr<ndn::Face>(new ndn::Face);
-#ifdef BOOST_THREAD_USES_CHRONO
-  time::seconds reconnetTimer = time::seconds(CONNECTION_RETRY_TIMER);
-#else
-  boost::posix_time::time_duration reconnectTimer;
-  reconnectTimer = boost::posix_time::seconds(CONNECTION_RETRY_TIMER);
-#endif
-  do {
-    {
-      std::lock_guard<std::mutex>lock(m_nfdMutex);
-      m_nfdConnected = true;
-    }
-    try {
-      Interest interest("/localhost/nfd/status");
-      interest.setCanBePrefix(true);
-      m_face->expressInterest(interest,
-                              [&] (const Interest& interest, const Data& data) {
-                                m_face->shutdown();
-                              },
-                              NULL,
-                              [] (const Interest& interest) {});
-      m_face->processEvents(time::milliseconds::zero(), true);
-    }
-    catch (const std::runtime_error& e) {
-      {
-        std::lock_guard<std::mutex>lock(m_nfdMutex);
-        m_nfdConnected = false;
-      }
-#ifdef BOOST_THREAD_USES_CHRONO
-      boost::this_thread::sleep_for(reconnetTimer);
-#else
-      boost::this_thread::sleep(reconnectTimer);
-#endif
-    }
-  } while (!m_nfdConnected);
-  emit nfdConnected();
+  boost::asio::io_service::work work(m_ioService);
+  m_ioService.post([this] { m_monitor.start(); });
+  m_ioService.run();
+  m_monitor.stop();
 }
 
 void
 NfdConnectionChecker::shutdown()
 {
-  // In this case, we just stop checking the nfd connection and exit
-  std::lock_guard<std::mutex>lock(m_nfdMutex);
-  m_nfdConnected = true;
+  m_ioService.stop();
+}
+
+void
+NfdConnectionChecker::recheck()
+{
+  // the monitor is only used on the thread of the checker
+  m_ioService.post([this] { m_monitor.recheck(); });
 }
 
 } // namespace chronochat
@@ -11,14 +11,20 @@
 #define CHRONOCHAT_NFD_CONNECTION_CHECKER_HPP
 
 #include "common.hpp"
+#include "nfd-connectivity-monitor.hpp"
 
 #include <QThread>
 #include <mutex>
-#include <boost/thread.hpp>
-#include <ndn-cxx/face.hpp>
+#include <boost/asio/io_service.hpp>
 
 namespace chronochat {
 
+/**
+ * @brief run a NfdConnectivityMonitor on its own thread, and signal its transitions
+ *
+ * The checker runs for the whole session. The backends report the failures of their faces,
+ * and wait for nfdConnected() to reconnect.
+ */
 class NfdConnectionChecker : public QThread
 {
   Q_OBJECT
@@ -26,6 +32,9 @@ class NfdConnectionChecker : public QThread
 public:
   NfdConnectionChecker(QObject* parent = nullptr);
 
+  bool
+  isNfdConnected();
+
 protected:
   void
   run();
@@ -34,15 +43,25 @@ signals:
   void
   nfdConnected();
 
+  void
+  nfdDisconnected();
+
 public slots:
   void
   shutdown();
 
+  /**
+   * @brief check the connection again, after a face failed
+   */
+  void
+  recheck();
+
 private:
   bool m_nfdConnected;
   std::mutex m_nfdMutex;
 
-  unique_ptr<ndn::Face> m_face;
+  boost::asio::io_service m_ioService;
+  NfdConnectivityMonitor m_monitor;
 };
 
 } // namespace chronochat
@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "nfd-connectivity-monitor.hpp"
+
+#include <boost/asio/local/stream_protocol.hpp>
+#include <ndn-cxx/transport/tcp-transport.hpp>
+#include <ndn-cxx/transport/unix-transport.hpp>
+#include <ndn-cxx/util/config-file.hpp>
+#include <ndn-cxx/util/random.hpp>
+
+#include <cstdlib>
+#include <tuple>
+
+namespace chronochat {
+
+static const time::milliseconds INITIAL_BACKOFF(50);
+static const time::milliseconds MAX_BACKOFF(2000);
+
+NfdConnectivityMonitor::NfdConnectivityMonitor(boost::asio::io_service& io,
+                                               const std::string& transportUri)
+  : m_socket(io)
+  , m_resolver(io)
+  , m_scheduler(io)
+  , m_initialBackoff(INITIAL_BACKOFF)
+  , m_maxBackoff(MAX_BACKOFF)
+  , m_backoff(INITIAL_BACKOFF)
+  , m_isRunning(false)
+  , m_isConnected(false)
+  , m_nAttempts(0)
+{
+  try {
+    m_socketPath = ndn::UnixTransport::getSocketNameFromUri(transportUri);
+  }
+  catch (const ndn::Transport::Error&) {
+    // not a Unix socket, the faces reach the forwarder over TCP or cannot reach it at all
+    std::tie(m_host, m_port) = ndn::TcpTransport::getSocketHostAndPortFromUri(transportUri);
+  }
+}
+
+NfdConnectivityMonitor::~NfdConnectivityMonitor()
+{
+  stop();
+}
+
+std::string
+NfdConnectivityMonitor::getDefaultTransportUri()
+{
+  // the same precedence as the default transport of a face
+  const char* transportEnviron = std::getenv("NDN_CLIENT_TRANSPORT");
+  if (transportEnviron != nullptr)
+    return transportEnviron;
+
+  try {
+    ndn::ConfigFile config;
+    return config.getParsedConfiguration().get<std::string>("transport", "");
+  }
+  catch (const ndn::ConfigFile::Error&) {
+    return "";
+  }
+}
+
+void
+NfdConnectivityMonitor::setBackoff(time::milliseconds initial, time::milliseconds maximum)
+{
+  m_initialBackoff = initial;
+  m_maxBackoff = std::max(initial, maximum);
+  m_backoff = m_initialBackoff;
+}
+
+void
+NfdConnectivityMonitor::start()
+{
+  if (m_isRunning)
+    return;
+
+  m_isRunning = true;
+  m_backoff = m_initialBackoff;
+  connect();
+}
+
+void
+NfdConnectivityMonitor::stop()
+{
+  m_isRunning = false;
+  m_retryEvent.cancel();
+  m_resolver.cancel();
+  boost::system::error_code error;
+  m_socket.close(error);
+}
+
+void
+NfdConnectivityMonitor::recheck()
+{
+  if (!m_isRunning)
+    return;
+
+  m_retryEvent.cancel();
+  m_resolver.cancel();
+  boost::system::error_code error;
+  m_socket.close(error);
+  setConnected(false);
+
+  m_backoff = m_initialBackoff;
+  connect();
+}
+
+void
+NfdConnectivityMonitor::connect()
+{
+  m_nAttempts++;
+  if (m_host.empty()) {
+    m_endpoints = {boost::asio::local::stream_protocol::endpoint(m_socketPath)};
+    connectToEndpoint(0);
+    return;
+  }
+
+  // the host is resolved on each attempt, as its address may change while the forwarder is away
+  using boost::asio::ip::tcp;
+  m_resolver.async_resolve(tcp::resolver::query(m_host, m_port),
+                           [this] (const boost::system::error_code& error,
+                                   tcp::resolver::iterator it) {
+                             if (error == boost::asio::error::operation_aborted)
+                               return;
+                             m_endpoints.clear();
+                             for (; it != tcp::resolver::iterator(); ++it)
+                               m_endpoints.push_back(it->endpoint());
+                             if (error || m_endpoints.empty()) {
+                               onConnectResult(boost::asio::error::host_not_found);
+                               return;
+                             }
+                             connectToEndpoint(0);
+                           });
+}
+
+void
+NfdConnectivityMonitor::connectToEndpoint(size_t index)
+{
+  m_socket.async_connect(m_endpoints[index],
+                         [this, index] (const boost::system::error_code& error) {
+                           if (error == boost::asio::error::operation_aborted)
+                             return;
+                           if (error && index + 1 < m_endpoints.size()) {
+                             // the next address of the host, on a socket of its own family
+                             boost::system::error_code closeError;
+                             m_socket.close(closeError);
+                             connectToEndpoint(index + 1);
+                             return;
+                           }
+                           onConnectResult(error);
+                         });
+}
+
+void
+NfdConnectivityMonitor::onConnectResult(const boost::system::error_code& error)
+{
+  if (!m_isRunning)
+    return;
+
+  if (error) {
+    reconnectLater();
+    return;
+  }
+
+  m_backoff = m_initialBackoff;
+  setConnected(true);
+  watch();
+}
+
+void
+NfdConnectivityMonitor::watch()
+{
+  m_socket.async_read_some(boost::asio::buffer(m_buffer),
+                           [this] (const boost::system::error_code& error, size_t) {
+                             if (error == boost::asio::error::operation_aborted)
+                               return;
+                             onReadResult(error);
+                           });
+}
+
+void
+NfdConnectivityMonitor::onReadResult(const boost::system::error_code& error)
+{
+  if (!m_isRunning)
+    return;
+
+  if (!error) {
+    watch();
+    return;
+  }
+
+  // the forwarder closed the connection, which it does when it exits
+  setConnected(false);
+  reconnectLater();
+}
+
+void
+NfdConnectivityMonitor::reconnectLater()
+{
+  boost::system::error_code error;
+  m_socket.close(error);
+
+  // wait between half and all of the backoff, so that the clients of a restarted forwarder
+  // do not all come back at once
+  std::uniform_int_distribution<time::milliseconds::rep> jitter(m_backoff.count() / 2,
+                                                                m_backoff.count());
+  time::milliseconds delay(jitter(ndn::random::getRandomNumberEngine()));
+  m_backoff = std::min(m_backoff * 2, m_maxBackoff);
+
+  m_retryEvent = m_scheduler.schedule(delay, [this] { connect(); });
+}
+
+void
+NfdConnectivityMonitor::setConnected(bool isConnected)
+{
+  if (m_isConnected == isConnected)
+    return;
+
+  m_isConnected = isConnected;
+  onConnectivityChanged(isConnected);
+}
+
+} // namespace chronochat
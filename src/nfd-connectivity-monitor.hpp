@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_NFD_CONNECTIVITY_MONITOR_HPP
+#define CHRONOCHAT_NFD_CONNECTIVITY_MONITOR_HPP
+
+#include "common.hpp"
+
+#include <array>
+#include <vector>
+#include <boost/asio/generic/stream_protocol.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <ndn-cxx/util/scheduler.hpp>
+#include <ndn-cxx/util/signal.hpp>
+
+namespace chronochat {
+
+/**
+ * @brief watch the connectivity to the local forwarder through the transport of its clients
+ *
+ * The monitor keeps a connection open to the Unix socket or the TCP endpoint the faces use,
+ * and learns that the forwarder is gone as soon as the connection is closed. It then connects
+ * again after a delay which starts short and doubles after each failure up to a maximum, with
+ * a random jitter, so that it notices the return of the forwarder quickly without polling the
+ * socket in a loop.
+ */
+class NfdConnectivityMonitor
+{
+public:
+  /**
+   * @param io the io_service running the monitor, which is not thread-safe
+   * @param transportUri the transport of the forwarder, a unix:// or a tcp:// FaceUri; empty
+   *                     for the default Unix socket
+   * @throw ndn::Transport::Error @p transportUri is not a Unix or TCP transport
+   */
+  NfdConnectivityMonitor(boost::asio::io_service& io,
+                         const std::string& transportUri = getDefaultTransportUri());
+
+  ~NfdConnectivityMonitor();
+
+  /**
+   * @return the transport the faces use, from NDN_CLIENT_TRANSPORT or else from the client
+   *         configuration of ndn-cxx; empty when neither sets one
+   */
+  static std::string
+  getDefaultTransportUri();
+
+  /**
+   * @brief set the delay before the first reconnection attempt, and its maximum
+   */
+  void
+  setBackoff(time::milliseconds initial, time::milliseconds maximum);
+
+  void
+  start();
+
+  void
+  stop();
+
+  /**
+   * @brief drop the connection and connect again right away
+   *
+   * A face may fail while the socket of the monitor is still open; connecting again confirms
+   * that the forwarder is there and signals a new connection.
+   */
+  void
+  recheck();
+
+  bool
+  isConnected() const
+  {
+    return m_isConnected;
+  }
+
+  /**
+   * @return the number of connection attempts made so far
+   */
+  size_t
+  getNAttempts() const
+  {
+    return m_nAttempts;
+  }
+
+public:
+  /**
+   * @brief signals each change of the connectivity, with true once connected
+   */
+  ndn::util::Signal<NfdConnectivityMonitor, bool> onConnectivityChanged;
+
+private:
+  void
+  connect();
+
+  /**
+   * @brief connect to the endpoint at @p index of the forwarder, or else to the ones after it
+   */
+  void
+  connectToEndpoint(size_t index);
+
+  void
+  onConnectResult(const boost::system::error_code& error);
+
+  /**
+   * @brief wait for the forwarder to close the connection, discarding what it sends
+   */
+  void
+  watch();
+
+  void
+  onReadResult(const boost::system::error_code& error);
+
+  /**
+   * @brief close the connection, and schedule the next attempt after the current backoff
+   */
+  void
+  reconnectLater();
+
+  void
+  setConnected(bool isConnected);
+
+private:
+  // the Unix socket of the forwarder, or its TCP host and port when m_host is not empty
+  std::string m_socketPath;
+  std::string m_host;
+  std::string m_port;
+  boost::asio::generic::stream_protocol::socket m_socket;
+  boost::asio::ip::tcp::resolver m_resolver;
+  // the endpoints of the current attempt, which must outlive it
+  std::vector<boost::asio::generic::stream_protocol::endpoint> m_endpoints;
+  ndn::Scheduler m_scheduler;
+  ndn::scheduler::ScopedEventId m_retryEvent;
+  time::milliseconds m_initialBackoff;
+  time::milliseconds m_maxBackoff;
+  time::milliseconds m_backoff;
+  bool m_isRunning;
+  bool m_isConnected;
+  size_t m_nAttempts;
+  std::array<uint8_t, 256> m_buffer;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_NFD_CONNECTIVITY_MONITOR_HPP
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "rtt-table.hpp"
+
+namespace chronochat {
+
+RttTable::RttTable()
+  : RttTable(Options())
+{
+}
+
+RttTable::RttTable(const Options& options)
+  : m_options(options)
+{
+}
+
+time::milliseconds
+RttTable::getTimeout(const Name& destination, int nRetransmissions) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  time::nanoseconds rto = m_options.initialRto;
+  auto it = m_entries.find(destination);
+  if (it != m_entries.end() && it->second.hasMeasurement)
+    rto = it->second.rto;
+
+  for (int i = 0; i < nRetransmissions && rto < m_options.maxRto; i++)
+    rto *= 2;
+
+  rto = std::min<time::nanoseconds>(rto, m_options.maxRto);
+  return time::duration_cast<time::milliseconds>(rto);
+}
+
+void
+RttTable::addMeasurement(const Name& destination, time::nanoseconds rtt)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  Entry& entry = m_entries[destination];
+
+  if (!entry.hasMeasurement) {
+    entry.srtt = rtt;
+    entry.rttVar = rtt / 2;
+    entry.hasMeasurement = true;
+  }
+  else {
+    time::nanoseconds delta = entry.srtt > rtt ? entry.srtt - rtt : rtt - entry.srtt;
+    entry.rttVar = time::duration_cast<time::nanoseconds>((1 - m_options.beta) * entry.rttVar +
+                                                          m_options.beta * delta);
+    entry.srtt = time::duration_cast<time::nanoseconds>((1 - m_options.alpha) * entry.srtt +
+                                                        m_options.alpha * rtt);
+  }
+
+  entry.rto = entry.srtt + m_options.k * entry.rttVar;
+  entry.rto = std::max<time::nanoseconds>(entry.rto, m_options.minRto);
+  entry.rto = std::min<time::nanoseconds>(entry.rto, m_options.maxRto);
+}
+
+void
+RttTable::addSuccess(const Name& destination)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries[destination].nFailures = 0;
+}
+
+void
+RttTable::addFailure(const Name& destination)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Entry& entry = m_entries[destination];
+  entry.nFailures++;
+  if (entry.nFailures >= m_options.nFailuresToDead)
+    entry.deadUntil = time::steady_clock::now() + m_options.deadPeriod;
+}
+
+bool
+RttTable::isDead(const Name& destination) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  auto it = m_entries.find(destination);
+  if (it == m_entries.end())
+    return false;
+
+  return it->second.nFailures >= m_options.nFailuresToDead &&
+         time::steady_clock::now() < it->second.deadUntil;
+}
+
+size_t
+RttTable::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+} // namespace chronochat
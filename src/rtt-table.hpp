@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_RTT_TABLE_HPP
+#define CHRONOCHAT_RTT_TABLE_HPP
+
+#include "common.hpp"
+#include <mutex>
+
+namespace chronochat {
+
+/**
+ * @brief round-trip time estimates and outcomes per destination
+ *
+ * The retransmission timeout of each destination follows RFC 6298: a smoothed RTT and its
+ * variation are updated with every measurement, and the timeout is doubled for every
+ * retransmission of the same Interest. A destination that failed several requests in a row is
+ * considered dead for a while, so that requests to it fail right away instead of waiting for
+ * their timeouts again.
+ *
+ * The table is safe to use from several threads.
+ */
+class RttTable
+{
+public:
+  class Options
+  {
+  public:
+    // gain of the smoothed RTT
+    double alpha = 0.125;
+    // gain of the RTT variation
+    double beta = 0.25;
+    int k = 4;
+    time::milliseconds initialRto = time::milliseconds(1000);
+    time::milliseconds minRto = time::milliseconds(200);
+    time::milliseconds maxRto = time::milliseconds(8000);
+    // consecutive failed requests before a destination is considered dead
+    int nFailuresToDead = 3;
+    // how long requests to a dead destination fail right away
+    time::milliseconds deadPeriod = time::milliseconds(30000);
+  };
+
+  RttTable();
+
+  explicit
+  RttTable(const Options& options);
+
+  /**
+   * @brief get the lifetime of an Interest to @p destination
+   *
+   * @param nRetransmissions the number of times the Interest was retransmitted already
+   */
+  time::milliseconds
+  getTimeout(const Name& destination, int nRetransmissions = 0) const;
+
+  /**
+   * @brief record the round-trip time of an Interest that was answered on its first transmission
+   */
+  void
+  addMeasurement(const Name& destination, time::nanoseconds rtt);
+
+  /**
+   * @brief record a request that got its answer, possibly after retransmissions
+   */
+  void
+  addSuccess(const Name& destination);
+
+  /**
+   * @brief record a request that failed after all its retransmissions
+   */
+  void
+  addFailure(const Name& destination);
+
+  bool
+  isDead(const Name& destination) const;
+
+  size_t
+  size() const;
+
+private:
+  class Entry
+  {
+  public:
+    bool hasMeasurement = false;
+    time::nanoseconds srtt = time::nanoseconds::zero();
+    time::nanoseconds rttVar = time::nanoseconds::zero();
+    time::nanoseconds rto = time::nanoseconds::zero();
+    int nFailures = 0;
+    time::steady_clock::TimePoint deadUntil;
+  };
+
+private:
+  Options m_options;
+  std::map<Name, Entry> m_entries;
+
+  mutable std::mutex m_mutex;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_RTT_TABLE_HPP
@@ -40,8 +40,8 @@ void
 StartChatDialog::onOkClicked()
 {
   QString chatroom = ui->chatroomInput->text();
-  bool secured = false;
-  // bool secured = ui->withSecurity->isChecked();
+  // a secured chatroom is signed with a group key, which is created with it
+  bool secured = ui->withSecurity->isChecked();
   emit startChatroom(chatroom, secured);
   this->close();
 }
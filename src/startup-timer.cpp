@@ -0,0 +1,37 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "startup-timer.hpp"
+
+namespace chronochat {
+
+StartupTimer::StartupTimer()
+  : m_start(time::steady_clock::now())
+  , m_last(m_start)
+{
+}
+
+void
+StartupTimer::mark(const std::string& phase)
+{
+  time::steady_clock::TimePoint now = time::steady_clock::now();
+  m_phases.emplace_back(phase, now - m_last);
+  m_last = now;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const StartupTimer& timer)
+{
+  os << "startup:";
+  for (const auto& phase : timer.getPhases())
+    os << " " << phase.first << " "
+       << time::duration_cast<time::milliseconds>(phase.second).count() << "ms,";
+  return os << " total " << time::duration_cast<time::milliseconds>(timer.getTotal()).count()
+            << "ms";
+}
+
+} // namespace chronochat
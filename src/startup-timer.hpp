@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_STARTUP_TIMER_HPP
+#define CHRONOCHAT_STARTUP_TIMER_HPP
+
+#include "common.hpp"
+
+#include <ostream>
+
+namespace chronochat {
+
+/**
+ * @brief the duration of each phase of the startup, which starts with the timer
+ */
+class StartupTimer
+{
+public:
+  typedef std::vector<std::pair<std::string, time::nanoseconds>> Phases;
+
+  StartupTimer();
+
+  /**
+   * @brief end @p phase, which started at the end of the previous one
+   */
+  void
+  mark(const std::string& phase);
+
+  const Phases&
+  getPhases() const
+  {
+    return m_phases;
+  }
+
+  time::nanoseconds
+  getTotal() const
+  {
+    return m_last - m_start;
+  }
+
+private:
+  time::steady_clock::TimePoint m_start;
+  time::steady_clock::TimePoint m_last;
+  Phases m_phases;
+};
+
+/**
+ * @brief print the phases and the total, in milliseconds, on one line
+ */
+std::ostream&
+operator<<(std::ostream& os, const StartupTimer& timer);
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_STARTUP_TIMER_HPP
@@ -31,6 +31,15 @@ enum {
   ChatMessageType = 150,
   ChatData = 151,
   Timestamp = 152,
+  ChatroomInfoDelta = 153,
+  BaseVersion = 154,
+  AddedParticipants = 155,
+  RemovedParticipants = 156,
+  DiscoveryCacheEntry = 157,
+  GroupKey = 158,
+  GroupKeySecret = 159,
+  EncryptedGroupKey = 160,
+  EncryptedGroupKeySecret = 161,
 };
 
 } // namespace tlv
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "trust-scope-index.hpp"
+
+namespace chronochat {
+
+TrustScopeIndex::TrustScopeIndex()
+  : m_root(std::make_unique<Node>())
+  , m_nScopes(0)
+{
+}
+
+void
+TrustScopeIndex::addContact(const Contact& contact)
+{
+  if (!contact.isIntroducer())
+    return;
+
+  for (auto it = contact.trustScopeBegin(); it != contact.trustScopeEnd(); it++)
+    add(contact.getNameSpace(), it->first);
+}
+
+void
+TrustScopeIndex::add(const Name& introducer, const Name& scope)
+{
+  if (!m_scopes[introducer].insert(scope).second)
+    return;
+
+  Node* node = m_root.get();
+  for (const auto& component : scope) {
+    unique_ptr<Node>& child = node->children[component];
+    if (child == nullptr)
+      child = std::make_unique<Node>();
+    node = child.get();
+  }
+  node->introducers.insert(introducer);
+  m_nScopes++;
+}
+
+void
+TrustScopeIndex::remove(const Name& introducer)
+{
+  auto it = m_scopes.find(introducer);
+  if (it == m_scopes.end())
+    return;
+
+  for (const Name& scope : it->second) {
+    // remember the path to prune the nodes left empty
+    std::vector<Node*> path{m_root.get()};
+    for (const auto& component : scope)
+      path.push_back(path.back()->children.at(component).get());
+
+    path.back()->introducers.erase(introducer);
+    for (size_t i = scope.size(); i > 0; i--) {
+      Node* node = path[i];
+      if (!node->introducers.empty() || !node->children.empty())
+        break;
+      path[i - 1]->children.erase(scope.get(i - 1));
+    }
+    m_nScopes--;
+  }
+  m_scopes.erase(it);
+}
+
+void
+TrustScopeIndex::clear()
+{
+  m_root = std::make_unique<Node>();
+  m_scopes.clear();
+  m_nScopes = 0;
+}
+
+std::vector<Name>
+TrustScopeIndex::findIntroducers(const Name& name) const
+{
+  std::set<Name> found;
+  walk(name, [&found] (const std::set<Name>& introducers) {
+    found.insert(introducers.begin(), introducers.end());
+    return false;
+  });
+  return std::vector<Name>(found.begin(), found.end());
+}
+
+bool
+TrustScopeIndex::canVouch(const Name& introducer, const Name& name) const
+{
+  return walk(name, [&introducer] (const std::set<Name>& introducers) {
+    return introducers.count(introducer) > 0;
+  });
+}
+
+bool
+TrustScopeIndex::walk(const Name& name, const function<bool(const std::set<Name>&)>& f) const
+{
+  const Node* node = m_root.get();
+  if (!node->introducers.empty() && f(node->introducers))
+    return true;
+
+  for (const auto& component : name) {
+    auto it = node->children.find(component);
+    if (it == node->children.end())
+      return false;
+
+    node = it->second.get();
+    if (!node->introducers.empty() && f(node->introducers))
+      return true;
+  }
+  return false;
+}
+
+} // namespace chronochat
@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_TRUST_SCOPE_INDEX_HPP
+#define CHRONOCHAT_TRUST_SCOPE_INDEX_HPP
+
+#include "common.hpp"
+#include "contact.hpp"
+
+#include <set>
+
+namespace chronochat {
+
+/**
+ * @brief the trust scopes of all the introducers, compiled into a name component trie
+ *
+ * A trust scope is a name prefix (Contact::addTrustScope creates it with Regex::fromName), an
+ * introducer can vouch for every name under one of its scopes. The introducers that can vouch
+ * for a name are found by walking the trie along the components of the name, in a time
+ * proportional to its length, whatever the number of introducers.
+ */
+class TrustScopeIndex
+{
+public:
+  TrustScopeIndex();
+
+  /**
+   * @brief add the trust scopes of @p contact, if it is an introducer
+   */
+  void
+  addContact(const Contact& contact);
+
+  void
+  add(const Name& introducer, const Name& scope);
+
+  /**
+   * @brief remove all the trust scopes of @p introducer
+   */
+  void
+  remove(const Name& introducer);
+
+  void
+  clear();
+
+  /**
+   * @return the introducers that can vouch for @p name
+   */
+  std::vector<Name>
+  findIntroducers(const Name& name) const;
+
+  bool
+  canVouch(const Name& introducer, const Name& name) const;
+
+  /**
+   * @return the number of trust scopes
+   */
+  size_t
+  size() const
+  {
+    return m_nScopes;
+  }
+
+private:
+  class Node
+  {
+  public:
+    std::map<ndn::name::Component, unique_ptr<Node>> children;
+    // the introducers with this node as a scope
+    std::set<Name> introducers;
+  };
+
+  /**
+   * @brief call @p f with the introducers of every scope that is a prefix of @p name
+   *
+   * @return whether @p f stopped the walk by returning true
+   */
+  bool
+  walk(const Name& name, const function<bool(const std::set<Name>&)>& f) const;
+
+private:
+  unique_ptr<Node> m_root;
+  std::map<Name, std::set<Name>> m_scopes;
+  size_t m_nScopes;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_TRUST_SCOPE_INDEX_HPP
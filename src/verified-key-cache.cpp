@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "verified-key-cache.hpp"
+
+#include <ndn-cxx/security/verification-helpers.hpp>
+
+namespace chronochat {
+
+void
+VerifiedKeyCache::insert(const Name& session, const ndn::security::Certificate& certificate)
+{
+  auto publicKey = std::make_shared<ndn::security::transform::PublicKey>();
+  try {
+    publicKey->loadPkcs8(certificate.getPublicKey().data(), certificate.getPublicKey().size());
+  }
+  catch (const ndn::security::transform::PublicKey::Error&) {
+    return;
+  }
+
+  Entry& entry = m_keys[session];
+  entry.keyName = certificate.getKeyName();
+  entry.certName = certificate.getName();
+  entry.publicKey = publicKey;
+  std::tie(entry.notBefore, entry.notAfter) = certificate.getValidityPeriod().getPeriod();
+}
+
+void
+VerifiedKeyCache::learn(const Data& data, ndn::security::Validator& validator)
+{
+  const ndn::SignatureInfo& info = data.getSignatureInfo();
+  if (data.getName().empty() || !info.hasKeyLocator() ||
+      info.getKeyLocator().getType() != tlv::Name)
+    return;
+
+  Name session = data.getName().getPrefix(-1);
+  const Name& keyLocator = info.getKeyLocator().getName();
+  if (hasKey(session, keyLocator))
+    return;
+
+  Interest certInterest(keyLocator);
+  certInterest.setCanBePrefix(true);
+  const ndn::security::Certificate* certificate = validator.findTrustedCert(certInterest);
+  if (certificate != nullptr)
+    insert(session, *certificate);
+}
+
+bool
+VerifiedKeyCache::hasKey(const Name& session, const Name& keyLocator) const
+{
+  auto it = m_keys.find(session);
+  return it != m_keys.end() &&
+         (it->second.keyName == keyLocator || it->second.certName == keyLocator);
+}
+
+bool
+VerifiedKeyCache::verify(const Data& data)
+{
+  const Entry* entry = findEntry(data);
+  if (entry == nullptr)
+    return false;
+
+  time::system_clock::TimePoint now = time::system_clock::now();
+  if (now < entry->notBefore || now > entry->notAfter) {
+    m_keys.erase(data.getName().getPrefix(-1));
+    return false;
+  }
+
+  // another key is validated in full, and replaces this one if it is valid
+  if (!isUsable(*entry, data))
+    return false;
+
+  return ndn::security::verifySignature(data, *entry->publicKey);
+}
+
+shared_ptr<const ndn::security::transform::PublicKey>
+VerifiedKeyCache::findKey(const Data& data) const
+{
+  const Entry* entry = findEntry(data);
+  if (entry == nullptr || !isUsable(*entry, data))
+    return nullptr;
+  return entry->publicKey;
+}
+
+void
+VerifiedKeyCache::erase(const Name& session)
+{
+  m_keys.erase(session);
+}
+
+void
+VerifiedKeyCache::clear()
+{
+  m_keys.clear();
+}
+
+const VerifiedKeyCache::Entry*
+VerifiedKeyCache::findEntry(const Data& data) const
+{
+  if (data.getName().empty())
+    return nullptr;
+
+  auto it = m_keys.find(data.getName().getPrefix(-1));
+  if (it == m_keys.end())
+    return nullptr;
+  return &it->second;
+}
+
+bool
+VerifiedKeyCache::isUsable(const Entry& entry, const Data& data)
+{
+  time::system_clock::TimePoint now = time::system_clock::now();
+  if (now < entry.notBefore || now > entry.notAfter)
+    return false;
+
+  const ndn::SignatureInfo& info = data.getSignatureInfo();
+  if (!info.hasKeyLocator() || info.getKeyLocator().getType() != tlv::Name)
+    return false;
+
+  const Name& keyLocator = info.getKeyLocator().getName();
+  return keyLocator == entry.keyName || keyLocator == entry.certName;
+}
+
+} // namespace chronochat
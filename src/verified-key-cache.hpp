@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_VERIFIED_KEY_CACHE_HPP
+#define CHRONOCHAT_VERIFIED_KEY_CACHE_HPP
+
+#include "common.hpp"
+
+#include <ndn-cxx/security/certificate.hpp>
+#include <ndn-cxx/security/transform/public-key.hpp>
+#include <ndn-cxx/security/validator.hpp>
+
+namespace chronochat {
+
+/**
+ * @brief the signing key of each remote chat session, once a packet of the session validated
+ *
+ * The chat data of a session are named <session>/<seq>, and the rules of validation-chat.conf
+ * only relate the name of a packet to its KeyLocator. A packet of a session whose key is known
+ * therefore needs a single signature check against that key, instead of the rule evaluation
+ * and the certificate lookups of the full validation. A key is used until the end of the
+ * validity of its certificate.
+ */
+class VerifiedKeyCache
+{
+public:
+  /**
+   * @brief remember @p certificate as the key of @p session
+   */
+  void
+  insert(const Name& session, const ndn::security::Certificate& certificate);
+
+  /**
+   * @brief remember the key of the session of @p data, which @p validator has just validated
+   *
+   * The certificate is taken among the trusted and verified ones of @p validator.
+   */
+  void
+  learn(const Data& data, ndn::security::Validator& validator);
+
+  /**
+   * @return whether @p keyLocator is the known key of @p session, by key or certificate name
+   */
+  bool
+  hasKey(const Name& session, const Name& keyLocator) const;
+
+  /**
+   * @brief check @p data against the known key of its session
+   *
+   * The entry of a session whose certificate is no longer valid is removed.
+   *
+   * @return whether the key of the session is known, is the one of @p data, and its signature
+   *         is valid; false means that the full validation is needed
+   */
+  bool
+  verify(const Data& data);
+
+  /**
+   * @return the known key of the session of @p data if it signed @p data and its certificate
+   *         is valid, or nullptr; the signature itself is not checked
+   */
+  shared_ptr<const ndn::security::transform::PublicKey>
+  findKey(const Data& data) const;
+
+  void
+  erase(const Name& session);
+
+  void
+  clear();
+
+  size_t
+  size() const
+  {
+    return m_keys.size();
+  }
+
+private:
+  class Entry
+  {
+  public:
+    Name keyName;
+    Name certName;
+    shared_ptr<ndn::security::transform::PublicKey> publicKey;
+    time::system_clock::TimePoint notBefore;
+    time::system_clock::TimePoint notAfter;
+  };
+
+  /**
+   * @return the entry of the session of @p data, or nullptr if it does not exist
+   */
+  const Entry*
+  findEntry(const Data& data) const;
+
+  /**
+   * @return whether @p entry signed @p data, with a certificate valid at this time
+   */
+  static bool
+  isUsable(const Entry& entry, const Data& data);
+
+private:
+  std::map<Name, Entry> m_keys;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_VERIFIED_KEY_CACHE_HPP
@@ -0,0 +1,41 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "verified-key-validation-policy.hpp"
+
+namespace chronochat {
+
+using ndn::security::ValidationState;
+
+VerifiedKeyValidationPolicy::VerifiedKeyValidationPolicy(VerifiedKeyCache& verifiedKeys)
+  : m_verifiedKeys(verifiedKeys)
+{
+}
+
+void
+VerifiedKeyValidationPolicy::checkPolicy(const Data& data,
+                                         const shared_ptr<ValidationState>& state,
+                                         const ValidationContinuation& continueValidation)
+{
+  if (m_verifiedKeys.verify(data)) {
+    // the signature is already checked, there is no certificate to retrieve
+    continueValidation(nullptr, state);
+    return;
+  }
+
+  getInnerPolicy().checkPolicy(data, state, continueValidation);
+}
+
+void
+VerifiedKeyValidationPolicy::checkPolicy(const Interest& interest,
+                                         const shared_ptr<ValidationState>& state,
+                                         const ValidationContinuation& continueValidation)
+{
+  getInnerPolicy().checkPolicy(interest, state, continueValidation);
+}
+
+} // namespace chronochat
@@ -0,0 +1,44 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_VERIFIED_KEY_VALIDATION_POLICY_HPP
+#define CHRONOCHAT_VERIFIED_KEY_VALIDATION_POLICY_HPP
+
+#include "common.hpp"
+#include "verified-key-cache.hpp"
+
+#include <ndn-cxx/security/validation-policy.hpp>
+
+namespace chronochat {
+
+/**
+ * @brief accept the chat data signed with the known key of their session
+ *
+ * Every other packet is passed to the inner policy, which must be set. The cache is filled by
+ * the owner of the validator, with the certificates of the data that passed the inner policy.
+ */
+class VerifiedKeyValidationPolicy : public ndn::security::ValidationPolicy
+{
+public:
+  explicit
+  VerifiedKeyValidationPolicy(VerifiedKeyCache& verifiedKeys);
+
+  void
+  checkPolicy(const Data& data, const shared_ptr<ndn::security::ValidationState>& state,
+              const ValidationContinuation& continueValidation) override;
+
+  void
+  checkPolicy(const Interest& interest, const shared_ptr<ndn::security::ValidationState>& state,
+              const ValidationContinuation& continueValidation) override;
+
+private:
+  VerifiedKeyCache& m_verifiedKeys;
+};
+
+} // namespace chronochat
+
+#endif // CHRONOCHAT_VERIFIED_KEY_VALIDATION_POLICY_HPP
@@ -0,0 +1,79 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "anchor-validation-policy.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+
+namespace chronochat {
+namespace tests {
+
+class AnchorValidationPolicyFixture
+{
+public:
+  AnchorValidationPolicyFixture()
+    : keyChain("pib-memory:", "tpm-memory:")
+  {
+    alice = keyChain.createIdentity("/ndn/alice").getDefaultKey().getDefaultCertificate();
+    mallory = keyChain.createIdentity("/ndn/mallory").getDefaultKey().getDefaultCertificate();
+    validator = AnchorValidationPolicy::makeValidator(alice);
+  }
+
+  template<typename Packet>
+  bool
+  isValid(const Packet& packet)
+  {
+    bool isValidated = false;
+    validator->validate(packet,
+                        [&] (const Packet&) { isValidated = true; },
+                        [] (const Packet&, const ndn::security::ValidationError&) {});
+    return isValidated;
+  }
+
+public:
+  ndn::KeyChain keyChain;
+  ndn::security::Certificate alice;
+  ndn::security::Certificate mallory;
+  shared_ptr<ndn::security::Validator> validator;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestAnchorValidationPolicy, AnchorValidationPolicyFixture)
+
+BOOST_AUTO_TEST_CASE(SignedData)
+{
+  ndn::Data data("/ndn/broadcast/%F0./ndn/alice/CHRONOCHAT-GROUP-KEY/lunch/ndn/bob");
+  keyChain.sign(data, ndn::security::signingByCertificate(alice));
+  BOOST_CHECK(isValid(data));
+
+  // the other keys are never fetched
+  keyChain.sign(data, ndn::security::signingByCertificate(mallory));
+  BOOST_CHECK(!isValid(data));
+
+  keyChain.sign(data, ndn::security::signingWithSha256());
+  BOOST_CHECK(!isValid(data));
+}
+
+BOOST_AUTO_TEST_CASE(SignedInterest)
+{
+  ndn::Interest interest("/ndn/broadcast/%F0./ndn/bob/CHRONOCHAT-INVITATION/lunch");
+  keyChain.sign(interest, ndn::security::signingByCertificate(alice));
+  BOOST_CHECK(isValid(interest));
+
+  ndn::Interest forged("/ndn/broadcast/%F0./ndn/bob/CHRONOCHAT-INVITATION/lunch");
+  keyChain.sign(forged, ndn::security::signingByCertificate(mallory));
+  BOOST_CHECK(!isValid(forged));
+
+  // an unsigned Interest
+  BOOST_CHECK(!isValid(ndn::Interest("/ndn/broadcast/%F0./ndn/bob/CHRONOCHAT-INVITATION")));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
@@ -0,0 +1,331 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "backend-simulation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <boost/filesystem.hpp>
+
+namespace chronochat {
+namespace tests {
+
+static std::atomic<size_t> g_nAllocations(0);
+
+size_t
+getNAllocations()
+{
+  return g_nAllocations.load(std::memory_order_relaxed);
+}
+
+} // namespace tests
+} // namespace chronochat
+
+// every allocation of the test program is counted, which is one increment
+
+void*
+operator new(std::size_t size)
+{
+  chronochat::tests::g_nAllocations.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void*
+operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+void
+operator delete[](void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+namespace chronochat {
+namespace tests {
+
+namespace fs = boost::filesystem;
+
+const Name BackendSimulation::ROUTING_PREFIX("/ucla");
+
+static const time::minutes MINUTE(1);
+
+static time::nanoseconds
+toCpuTime(std::clock_t clock)
+{
+  return time::nanoseconds(static_cast<int64_t>(clock * (1e9 / CLOCKS_PER_SEC)));
+}
+
+SimulatedChatDialogBackend::SimulatedChatDialogBackend(shared_ptr<DummyClientFace> face,
+                                                       const Name& routingPrefix,
+                                                       const Name& identity,
+                                                       const std::string& chatroomName)
+  : ChatDialogBackend(Name("/ndn/broadcast/ChronoChat/Chatroom").append(chatroomName),
+                      Name(identity).append("CHRONOCHAT-CHATDATA").append(chatroomName),
+                      routingPrefix,
+                      chatroomName,
+                      identity.get(-1).toUri())
+  , m_simulatedFace(std::move(face))
+{
+}
+
+SimulatedChatroomDiscoveryBackend::SimulatedChatroomDiscoveryBackend(
+  shared_ptr<DummyClientFace> face, const Name& routingPrefix, const Name& identity)
+  : ChatroomDiscoveryBackend(routingPrefix, identity)
+  , m_simulatedFace(std::move(face))
+{
+}
+
+BackendSimulation::BackendSimulation()
+  : m_steadyClock(std::make_shared<time::UnitTestSteadyClock>())
+  , m_systemClock(std::make_shared<time::UnitTestSystemClock>())
+  , m_keyChain("pib-memory:", "tpm-memory:")
+  , m_minuteElapsed(time::nanoseconds::zero())
+  , m_minuteAllocations(getNAllocations())
+  , m_minuteCpuTime(std::clock())
+{
+  time::setCustomClocks(m_steadyClock, m_systemClock);
+
+  const char* home = getenv("HOME");
+  if (home != nullptr)
+    m_previousHome = home;
+  m_home = (fs::temp_directory_path() / fs::unique_path("chronochat-simulation-%%%%%%%%"))
+           .string();
+  fs::create_directories(fs::path(m_home) / ".chronos");
+  setenv("HOME", m_home.c_str(), 1);
+}
+
+BackendSimulation::~BackendSimulation()
+{
+  while (!m_users.empty())
+    crash(m_users.front());
+  m_faces.clear();
+
+  setenv("HOME", m_previousHome.c_str(), 1);
+  boost::system::error_code error;
+  fs::remove_all(m_home, error);
+
+  time::setCustomClocks();
+}
+
+SimulatedUser&
+BackendSimulation::addUser(const Name& identity)
+{
+  m_users.emplace_back();
+  SimulatedUser& user = m_users.back();
+  user.identity = identity;
+  user.discovery = std::make_shared<SimulatedChatroomDiscoveryBackend>(addFace(),
+                                                                       ROUTING_PREFIX,
+                                                                       identity);
+
+  // Controller answers with the info of the chat dialog, from another thread
+  SimulatedUser* userPtr = &user;
+  std::weak_ptr<SimulatedChatroomDiscoveryBackend> weakDiscovery = user.discovery;
+  QObject::connect(user.discovery.get(), &ChatroomDiscoveryBackend::chatroomInfoRequest,
+                   [this, userPtr, weakDiscovery] (std::string chatroomName, bool isManager) {
+    m_io.post([userPtr, weakDiscovery, chatroomName, isManager] {
+      // the user is gone with its discovery backend
+      auto discovery = weakDiscovery.lock();
+      if (discovery == nullptr)
+        return;
+      auto chatroom = userPtr->chatrooms.find(chatroomName);
+      if (chatroom == userPtr->chatrooms.end())
+        return;
+
+      ChatroomInfo info;
+      info.setName(Name::Component(chatroomName));
+      for (const Name& participant : chatroom->second->getRoster()->getParticipants())
+        info.addParticipant(participant);
+      info.setSyncPrefix(Name("/ndn/broadcast/ChronoChat/Chatroom").append(chatroomName));
+      info.setTrustModel(chatroom->second->getGroupKey() != nullptr ?
+                         ChatroomInfo::TRUST_MODEL_HIERARCHICAL :
+                         ChatroomInfo::TRUST_MODEL_NONE);
+      discovery->onRespondChatroomInfoRequest(info, isManager);
+    });
+  });
+
+  user.discovery->initializeSync();
+  return user;
+}
+
+SimulatedChatDialogBackend&
+BackendSimulation::join(SimulatedUser& user, const std::string& chatroom,
+                        shared_ptr<const GroupKey> groupKey)
+{
+  auto backend = std::make_unique<SimulatedChatDialogBackend>(addFace(), ROUTING_PREFIX,
+                                                              user.identity, chatroom);
+  backend->setGroupKey(std::move(groupKey));
+
+  std::weak_ptr<SimulatedChatroomDiscoveryBackend> weakDiscovery = user.discovery;
+  QObject::connect(backend.get(), &ChatDialogBackend::newChatroomForDiscovery,
+                   [this, weakDiscovery] (Name::Component chatroomName) {
+    m_io.post([weakDiscovery, chatroomName] {
+      if (auto discovery = weakDiscovery.lock())
+        discovery->onNewChatroomForDiscovery(chatroomName);
+    });
+  });
+  QObject::connect(backend->getRoster(), &ChatroomRoster::participantAdded,
+                   [this, weakDiscovery] (Name participant, Name::Component chatroomName) {
+    m_io.post([weakDiscovery, participant, chatroomName] {
+      if (auto discovery = weakDiscovery.lock())
+        discovery->onAddInRoster(participant, chatroomName);
+    });
+  });
+  QObject::connect(backend->getRoster(), &ChatroomRoster::participantRemoved,
+                   [this, weakDiscovery] (Name participant, Name::Component chatroomName) {
+    m_io.post([weakDiscovery, participant, chatroomName] {
+      if (auto discovery = weakDiscovery.lock())
+        discovery->onEraseInRoster(participant, chatroomName);
+    });
+  });
+
+  backend->initializeSync();
+  auto& entry = user.chatrooms[chatroom];
+  entry = std::move(backend);
+  return *entry;
+}
+
+void
+BackendSimulation::crash(SimulatedUser& user)
+{
+  for (auto& chatroom : user.chatrooms) {
+    chatroom.second->close();
+    removeFace(chatroom.second->getFace());
+  }
+  user.chatrooms.clear();
+
+  user.discovery->close();
+  removeFace(user.discovery->getFace());
+  user.discovery.reset();
+
+  m_users.remove_if([&user] (const SimulatedUser& other) { return &other == &user; });
+}
+
+void
+BackendSimulation::advanceClocks(time::nanoseconds duration, time::nanoseconds tick)
+{
+  for (time::nanoseconds elapsed = time::nanoseconds::zero(); elapsed < duration;
+       elapsed += tick) {
+    m_steadyClock->advance(tick);
+    m_systemClock->advance(tick);
+    m_io.poll();
+    m_io.reset();
+
+    m_minuteElapsed += tick;
+    if (m_minuteElapsed >= MINUTE) {
+      m_minuteElapsed -= MINUTE;
+      endMinute();
+    }
+  }
+}
+
+Usage
+BackendSimulation::getAverage(size_t first, size_t last) const
+{
+  BOOST_ASSERT(first < last && last <= m_minutes.size());
+
+  Usage total;
+  for (size_t i = first; i < last; i++) {
+    total.nInterests += m_minutes[i].nInterests;
+    total.nData += m_minutes[i].nData;
+    total.nAllocations += m_minutes[i].nAllocations;
+    total.cpuTime += m_minutes[i].cpuTime;
+  }
+
+  size_t nMinutes = last - first;
+  total.nInterests /= nMinutes;
+  total.nData /= nMinutes;
+  total.nAllocations /= nMinutes;
+  total.cpuTime /= nMinutes;
+  return total;
+}
+
+shared_ptr<DummyClientFace>
+BackendSimulation::addFace()
+{
+  auto face = std::make_shared<DummyClientFace>(m_io, m_keyChain,
+                                                DummyClientFace::Options{false, true});
+  const DummyClientFace* from = face.get();
+  face->onSendInterest.connect([this, from] (const Interest& interest) {
+    // the commands to the forwarder are answered by the face itself
+    if (Name("/localhost").isPrefixOf(interest.getName()))
+      return;
+    m_current.nInterests++;
+    broadcast(from, interest);
+  });
+  face->onSendData.connect([this, from] (const Data& data) {
+    m_current.nData++;
+    broadcast(from, data);
+  });
+
+  m_faces.push_back(face);
+  return face;
+}
+
+void
+BackendSimulation::removeFace(const shared_ptr<DummyClientFace>& face)
+{
+  m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), face), m_faces.end());
+}
+
+template<typename Packet>
+void
+BackendSimulation::broadcast(const DummyClientFace* from, const Packet& packet)
+{
+  m_io.post([this, from, packet] {
+    // the faces removed in the meantime do not get it
+    std::vector<shared_ptr<DummyClientFace>> faces = m_faces;
+    for (const auto& face : faces) {
+      if (face.get() != from)
+        face->receive(packet);
+    }
+  });
+}
+
+void
+BackendSimulation::endMinute()
+{
+  size_t nAllocations = getNAllocations();
+  std::clock_t cpuTime = std::clock();
+  m_current.nAllocations = nAllocations - m_minuteAllocations;
+  m_current.cpuTime = toCpuTime(cpuTime - m_minuteCpuTime);
+  m_minuteAllocations = nAllocations;
+  m_minuteCpuTime = cpuTime;
+
+  m_minutes.push_back(m_current);
+  if (onMinute)
+    onMinute(m_current);
+  m_current = Usage();
+}
+
+} // namespace tests
+} // namespace chronochat
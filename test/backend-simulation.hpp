@@ -0,0 +1,224 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#ifndef CHRONOCHAT_TESTS_BACKEND_SIMULATION_HPP
+#define CHRONOCHAT_TESTS_BACKEND_SIMULATION_HPP
+
+#include "chat-dialog-backend.hpp"
+#include "chatroom-discovery-backend.hpp"
+
+#include <ctime>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/dummy-client-face.hpp>
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+
+namespace chronochat {
+namespace tests {
+
+using ndn::util::DummyClientFace;
+
+/**
+ * @return the number of allocations made by the test program so far
+ */
+size_t
+getNAllocations();
+
+/**
+ * @brief what the simulated network and the process used during a period
+ */
+class Usage
+{
+public:
+  size_t nInterests = 0;
+  size_t nData = 0;
+  size_t nAllocations = 0;
+  time::nanoseconds cpuTime = time::nanoseconds::zero();
+};
+
+/**
+ * @brief a chat dialog backend run without its thread, on a simulated face
+ */
+class SimulatedChatDialogBackend : public ChatDialogBackend
+{
+public:
+  SimulatedChatDialogBackend(shared_ptr<DummyClientFace> face,
+                             const Name& routingPrefix,
+                             const Name& identity,
+                             const std::string& chatroomName);
+
+  using ChatDialogBackend::initializeSync;
+  using ChatDialogBackend::close;
+
+  const shared_ptr<DummyClientFace>&
+  getFace() const
+  {
+    return m_simulatedFace;
+  }
+
+protected:
+  shared_ptr<ndn::Face>
+  makeFace() override
+  {
+    return m_simulatedFace;
+  }
+
+private:
+  shared_ptr<DummyClientFace> m_simulatedFace;
+};
+
+/**
+ * @brief a chatroom discovery backend run without its thread, on a simulated face
+ */
+class SimulatedChatroomDiscoveryBackend : public ChatroomDiscoveryBackend
+{
+public:
+  SimulatedChatroomDiscoveryBackend(shared_ptr<DummyClientFace> face,
+                                    const Name& routingPrefix,
+                                    const Name& identity);
+
+  using ChatroomDiscoveryBackend::initializeSync;
+  using ChatroomDiscoveryBackend::close;
+
+  const shared_ptr<DummyClientFace>&
+  getFace() const
+  {
+    return m_simulatedFace;
+  }
+
+protected:
+  shared_ptr<ndn::Face>
+  makeFace() override
+  {
+    return m_simulatedFace;
+  }
+
+private:
+  shared_ptr<DummyClientFace> m_simulatedFace;
+};
+
+/**
+ * @brief the backends of one user, connected to each other the way Controller connects them
+ */
+class SimulatedUser
+{
+public:
+  Name identity;
+  // the calls posted to it are dropped once it is gone
+  shared_ptr<SimulatedChatroomDiscoveryBackend> discovery;
+  std::map<std::string, unique_ptr<SimulatedChatDialogBackend>> chatrooms;
+};
+
+/**
+ * @brief run the chat dialog and chatroom discovery backends of many users on simulated time
+ *
+ * All the faces share one broadcast medium, where each packet sent by a face reaches all the
+ * others, and one io_service. The steady and system clocks only move with advanceClocks(), so
+ * hours of the HELLOs, session timeouts and chatroom expiries of the backends run in seconds.
+ * The random delays of ChronoSync are not controlled, the tests check ranges of times.
+ *
+ * The packets sent, the CPU time and the allocations are measured for each simulated minute.
+ * HOME points to a temporary directory while the simulation exists, for the discovery cache
+ * and the default KeyChain.
+ */
+class BackendSimulation
+{
+public:
+  BackendSimulation();
+
+  ~BackendSimulation();
+
+  /**
+   * @brief start the discovery backend of a new user
+   */
+  SimulatedUser&
+  addUser(const Name& identity);
+
+  /**
+   * @brief make @p user join @p chatroom, with the group key @p groupKey if it is secured
+   */
+  SimulatedChatDialogBackend&
+  join(SimulatedUser& user, const std::string& chatroom,
+       shared_ptr<const GroupKey> groupKey = nullptr);
+
+  /**
+   * @brief stop all the backends of @p user at once, without leaving its chatrooms
+   */
+  void
+  crash(SimulatedUser& user);
+
+  /**
+   * @brief advance the clocks by @p duration, in steps of @p tick
+   *
+   * After each step, the io_service runs everything that is ready, which includes the
+   * packets sent during the step.
+   */
+  void
+  advanceClocks(time::nanoseconds duration,
+                time::nanoseconds tick = time::milliseconds(100));
+
+  /**
+   * @return the usage during each simulated minute so far
+   */
+  const std::vector<Usage>&
+  getMinutes() const
+  {
+    return m_minutes;
+  }
+
+  /**
+   * @return the average usage over the simulated minutes [@p first, @p last)
+   */
+  Usage
+  getAverage(size_t first, size_t last) const;
+
+public:
+  /**
+   * @brief called at the end of each simulated minute, with its usage
+   */
+  function<void(const Usage&)> onMinute;
+
+  static const Name ROUTING_PREFIX;
+
+private:
+  shared_ptr<DummyClientFace>
+  addFace();
+
+  void
+  removeFace(const shared_ptr<DummyClientFace>& face);
+
+  /**
+   * @brief deliver @p packet to all the faces but @p from, once the sender is done
+   */
+  template<typename Packet>
+  void
+  broadcast(const DummyClientFace* from, const Packet& packet);
+
+  void
+  endMinute();
+
+private:
+  shared_ptr<time::UnitTestSteadyClock> m_steadyClock;
+  shared_ptr<time::UnitTestSystemClock> m_systemClock;
+  std::string m_home;
+  std::string m_previousHome;
+
+  boost::asio::io_service m_io;
+  ndn::KeyChain m_keyChain;
+  std::vector<shared_ptr<DummyClientFace>> m_faces;
+  std::list<SimulatedUser> m_users;
+
+  time::nanoseconds m_minuteElapsed;
+  Usage m_current;
+  size_t m_minuteAllocations;
+  std::clock_t m_minuteCpuTime;
+  std::vector<Usage> m_minutes;
+};
+
+} // namespace tests
+} // namespace chronochat
+
+#endif // CHRONOCHAT_TESTS_BACKEND_SIMULATION_HPP
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "backend-simulation.hpp"
+
+#include <QStringList>
+#include <boost/test/unit_test.hpp>
+
+namespace chronochat {
+namespace tests {
+
+static std::ostream&
+operator<<(std::ostream& os, const Usage& usage)
+{
+  return os << usage.nInterests << " Interests, " << usage.nData << " Data, "
+            << usage.nAllocations << " allocations, "
+            << time::duration_cast<time::microseconds>(usage.cpuTime).count() << "us CPU";
+}
+
+BOOST_FIXTURE_TEST_SUITE(TestBackendSimulation, BackendSimulation)
+
+BOOST_AUTO_TEST_CASE(SessionTimeout)
+{
+  SimulatedUser& alice = addUser("/ndn/alice");
+  SimulatedUser& bob = addUser("/ndn/bob");
+  SimulatedUser& carol = addUser("/ndn/carol");
+  ChatroomRoster* aliceRoster = join(alice, "lunch").getRoster();
+  ChatroomRoster* bobRoster = join(bob, "lunch").getRoster();
+  join(carol, "lunch");
+
+  advanceClocks(time::seconds(10));
+  BOOST_CHECK_EQUAL(aliceRoster->size(), 3);
+  BOOST_CHECK_EQUAL(bobRoster->size(), 3);
+
+  // the HELLOs keep the sessions
+  advanceClocks(time::hours(1));
+  BOOST_CHECK_EQUAL(aliceRoster->size(), 3);
+  BOOST_CHECK_EQUAL(bobRoster->size(), 3);
+
+  // the last HELLO of carol was at most a minute ago, the session times out after 3 minutes
+  crash(carol);
+  advanceClocks(time::seconds(115));
+  BOOST_CHECK_EQUAL(aliceRoster->size(), 3);
+  BOOST_CHECK_EQUAL(bobRoster->size(), 3);
+
+  advanceClocks(time::seconds(70));
+  BOOST_CHECK_EQUAL(aliceRoster->size(), 2);
+  BOOST_CHECK_EQUAL(bobRoster->size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(ChatroomExpiry)
+{
+  SimulatedUser& alice = addUser("/ndn/alice");
+  SimulatedUser& bob = addUser("/ndn/bob");
+
+  QStringList added;
+  QStringList removed;
+  QObject::connect(bob.discovery.get(), &ChatroomDiscoveryBackend::chatroomListChanged,
+                   [&] (const QStringList& addedList, const QStringList& removedList) {
+    added << addedList;
+    removed << removedList;
+  });
+
+  // alice manages the chatroom, bob only discovers it
+  join(alice, "lunch");
+  advanceClocks(time::minutes(2));
+  BOOST_CHECK(added.contains("lunch"));
+  BOOST_CHECK(removed.empty());
+
+  // the manager announced the chatroom at most a minute ago, it expires after 5 minutes
+  crash(alice);
+  advanceClocks(time::seconds(235));
+  BOOST_CHECK(removed.empty());
+
+  advanceClocks(time::seconds(85));
+  BOOST_CHECK(removed.contains("lunch"));
+}
+
+BOOST_AUTO_TEST_CASE(SteadyState)
+{
+  const size_t N_USERS = 8;
+  const size_t N_CHATROOMS = 4;
+
+  std::vector<shared_ptr<const GroupKey>> groupKeys;
+  for (size_t i = 0; i < N_CHATROOMS; i++)
+    groupKeys.push_back(GroupKey::generate(Name("/ndn/broadcast/ChronoChat/Chatroom")
+                                           .append("room" + std::to_string(i))));
+
+  // every user is in two secured chatrooms, every chatroom has four users
+  std::vector<ChatroomRoster*> rosters;
+  for (size_t i = 0; i < N_USERS; i++) {
+    SimulatedUser& user = addUser(Name("/ndn").append("user" + std::to_string(i)));
+    for (size_t room : {i % N_CHATROOMS, (i + 1) % N_CHATROOMS}) {
+      SimulatedChatDialogBackend& backend = join(user, "room" + std::to_string(room),
+                                                 groupKeys[room]);
+      rosters.push_back(backend.getRoster());
+    }
+  }
+
+  advanceClocks(time::minutes(10));
+  size_t start = getMinutes().size();
+  advanceClocks(time::hours(3));
+
+  for (ChatroomRoster* roster : rosters)
+    BOOST_CHECK_EQUAL(roster->size(), N_USERS * 2 / N_CHATROOMS);
+
+  std::vector<Usage> hours;
+  for (size_t hour = 0; hour < 3; hour++) {
+    hours.push_back(getAverage(start + hour * 60, start + (hour + 1) * 60));
+    BOOST_TEST_MESSAGE("hour " << hour << ", per minute: " << hours.back());
+  }
+
+  // the timers of the backends do not pile up: the traffic and the work of the last hour
+  // are those of the first one
+  BOOST_CHECK_GT(hours[0].nInterests, 0);
+  BOOST_CHECK_GT(hours[0].nData, 0);
+  BOOST_CHECK_LE(hours[2].nInterests, hours[0].nInterests * 6 / 5 + 10);
+  BOOST_CHECK_LE(hours[2].nData, hours[0].nData * 6 / 5 + 10);
+  BOOST_CHECK_LE(hours[2].nAllocations, hours[0].nAllocations * 6 / 5 + 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "batch-validator.hpp"
+#include "verified-key-validation-policy.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/security/certificate-fetcher-offline.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/security/validation-policy-simple-hierarchy.hpp>
+
+namespace chronochat {
+namespace tests {
+
+/**
+ * @brief count the packets checked by the inner policy, which are the full validations
+ */
+class CountingPolicy : public ndn::security::ValidationPolicy
+{
+public:
+  void
+  checkPolicy(const Data& data, const shared_ptr<ndn::security::ValidationState>& state,
+              const ValidationContinuation& continueValidation) override
+  {
+    nChecks++;
+    getInnerPolicy().checkPolicy(data, state, continueValidation);
+  }
+
+  void
+  checkPolicy(const Interest& interest, const shared_ptr<ndn::security::ValidationState>& state,
+              const ValidationContinuation& continueValidation) override
+  {
+    getInnerPolicy().checkPolicy(interest, state, continueValidation);
+  }
+
+public:
+  size_t nChecks = 0;
+};
+
+class BatchValidatorFixture
+{
+public:
+  BatchValidatorFixture()
+    : keyChain("pib-memory:", "tpm-memory:")
+  {
+    alice = keyChain.createIdentity("/ndn/alice").getDefaultKey();
+    bob = keyChain.createIdentity("/ndn/bob").getDefaultKey();
+
+    auto policy = std::make_unique<VerifiedKeyValidationPolicy>(verifiedKeys);
+    auto countingPolicy = std::make_unique<CountingPolicy>();
+    counter = countingPolicy.get();
+    policy->setInnerPolicy(std::move(countingPolicy));
+    policy->setInnerPolicy(std::make_unique<ndn::security::ValidationPolicySimpleHierarchy>());
+    validator = std::make_unique<ndn::security::Validator>(
+      std::move(policy), std::make_unique<ndn::security::CertificateFetcherOffline>());
+    validator->loadAnchor("alice", ndn::security::Certificate(alice.getDefaultCertificate()));
+    validator->loadAnchor("bob", ndn::security::Certificate(bob.getDefaultCertificate()));
+  }
+
+  shared_ptr<const Data>
+  makeChatData(const Name& session, uint64_t seqNo, const ndn::security::Key& key)
+  {
+    auto data = std::make_shared<Data>(Name(session).appendNumber(seqNo));
+    data->setContent(reinterpret_cast<const uint8_t*>("hello"), 5);
+    keyChain.sign(*data, ndn::security::signingByKey(key));
+    return data;
+  }
+
+public:
+  ndn::KeyChain keyChain;
+  ndn::security::Key alice;
+  ndn::security::Key bob;
+  VerifiedKeyCache verifiedKeys;
+  CountingPolicy* counter;
+  unique_ptr<ndn::security::Validator> validator;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestBatchValidator, BatchValidatorFixture)
+
+BOOST_AUTO_TEST_CASE(Batch)
+{
+  Name aliceSession("/ndn/alice/CHRONOCHAT-CHATDATA/lunch/1");
+  Name bobSession("/ndn/bob/CHRONOCHAT-CHATDATA/lunch/1");
+  shared_ptr<GroupKey> roomKey = GroupKey::generate("/ndn/broadcast/ChronoChat/Chatroom/lunch");
+
+  std::vector<shared_ptr<const Data>> packets;
+  std::vector<bool> expected;
+  for (uint64_t seqNo = 1; seqNo <= 20; seqNo++) {
+    packets.push_back(makeChatData(aliceSession, seqNo, alice));
+    expected.push_back(true);
+    packets.push_back(makeChatData(bobSession, seqNo, bob));
+    expected.push_back(true);
+  }
+
+  // signed with the group key
+  auto hmacSigned = std::make_shared<Data>(Name(aliceSession).appendNumber(21));
+  roomKey->sign(*hmacSigned);
+  packets.push_back(hmacSigned);
+  expected.push_back(true);
+
+  // alice signing in the name of bob fails the policy
+  packets.push_back(makeChatData("/ndn/bob/CHRONOCHAT-CHATDATA/lunch/2", 1, alice));
+  expected.push_back(false);
+
+  // a tampered packet of alice
+  ndn::Buffer wire(packets[0]->wireEncode().wire(), packets[0]->wireEncode().size());
+  const std::string text = "hello";
+  auto content = std::search(wire.begin(), wire.end(), text.begin(), text.end());
+  BOOST_REQUIRE(content != wire.end());
+  *content = 'j';
+  packets.push_back(std::make_shared<Data>(Block(wire.data(), wire.size())));
+  expected.push_back(false);
+
+  BatchValidator batchValidator(*validator, verifiedKeys, [roomKey] { return roomKey; }, 4);
+
+  std::vector<Name> delivered;
+  std::vector<bool> outcomes;
+  batchValidator.validate(packets, [&] (const Data& data, bool isValidated) {
+    delivered.push_back(data.getName());
+    outcomes.push_back(isValidated);
+  });
+
+  BOOST_REQUIRE_EQUAL(delivered.size(), packets.size());
+  for (size_t i = 0; i < packets.size(); i++)
+    BOOST_CHECK_EQUAL(delivered[i], packets[i]->getName());
+  BOOST_CHECK_EQUAL_COLLECTIONS(outcomes.begin(), outcomes.end(),
+                                expected.begin(), expected.end());
+
+  // once per signer and session: alice, bob, and alice in the session of bob
+  BOOST_CHECK_EQUAL(counter->nChecks, 3);
+  BOOST_CHECK_EQUAL(batchValidator.getNFullValidations(), 3);
+  BOOST_CHECK_EQUAL(verifiedKeys.size(), 2);
+
+  // the keys of the sessions are known now
+  delivered.clear();
+  outcomes.clear();
+  batchValidator.validate({makeChatData(aliceSession, 22, alice),
+                           makeChatData(bobSession, 21, bob)},
+                          [&] (const Data& data, bool isValidated) {
+                            delivered.push_back(data.getName());
+                            outcomes.push_back(isValidated);
+                          });
+  BOOST_CHECK_EQUAL(delivered.size(), 2);
+  BOOST_CHECK(outcomes[0] && outcomes[1]);
+  BOOST_CHECK_EQUAL(batchValidator.getNFullValidations(), 3);
+
+  // without the group key
+  BatchValidator withoutGroupKey(*validator, verifiedKeys, [] { return nullptr; });
+  withoutGroupKey.validate({hmacSigned}, [&] (const Data& data, bool isValidated) {
+    BOOST_CHECK(!isValidated);
+  });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "chatroom-credentials.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/security/verification-helpers.hpp>
+
+namespace chronochat {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestChatroomCredentials)
+
+BOOST_AUTO_TEST_CASE(GetOnce)
+{
+  ndn::KeyChain keyChain("pib-memory:", "tpm-memory:");
+  ChatroomCredentials credentials(keyChain);
+
+  // the identity is created at the first use
+  auto lunch = credentials.get("lunch", "/ndn/alice");
+  BOOST_REQUIRE(lunch != nullptr);
+  BOOST_CHECK_EQUAL(lunch->identity, Name("/ndn/alice"));
+  BOOST_CHECK_EQUAL(lunch->certificate.getIdentity(), Name("/ndn/alice"));
+  BOOST_CHECK(lunch->certificateWire == lunch->certificate.wireEncode());
+  BOOST_CHECK_EQUAL(keyChain.getPib().getIdentities().size(), 1);
+
+  // loaded once, and shared by the chatrooms of the identity
+  BOOST_CHECK_EQUAL(credentials.get("lunch", "/ndn/alice"), lunch);
+  BOOST_CHECK_EQUAL(credentials.get("dinner", "/ndn/alice"), lunch);
+  BOOST_CHECK_EQUAL(credentials.size(), 2);
+
+  // an existing identity is loaded, not created again
+  ndn::security::Identity bob = keyChain.createIdentity("/ndn/bob");
+  auto bobLunch = credentials.get("lunch", "/ndn/bob");
+  BOOST_CHECK_EQUAL(bobLunch->certificate.getName(),
+                    bob.getDefaultKey().getDefaultCertificate().getName());
+  BOOST_CHECK_EQUAL(bob.getKeys().size(), 1);
+  BOOST_CHECK_EQUAL(credentials.size(), 2);
+
+  Data data("/ndn/bob/response");
+  keyChain.sign(data, bobLunch->signingInfo);
+  BOOST_CHECK_EQUAL(data.getSignatureInfo().getKeyLocator().getName(),
+                    bobLunch->certificate.getName());
+  BOOST_CHECK(ndn::security::verifySignature(data, bobLunch->certificate));
+
+  credentials.erase("lunch");
+  BOOST_CHECK_EQUAL(credentials.size(), 1);
+  credentials.clear();
+  BOOST_CHECK_EQUAL(credentials.size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "chatroom-discovery-table.hpp"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace chronochat {
+
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestChatroomDiscoveryTable)
+
+BOOST_AUTO_TEST_CASE(GetAndErase)
+{
+  ChatroomDiscoveryTable table(8);
+  Name::Component ndnd("ndnd");
+
+  BOOST_CHECK(table.find(ndnd) == table.end());
+
+  ChatroomInfoBackend& chatroom = table.get(ndnd);
+  BOOST_CHECK_EQUAL(chatroom.chatroomName, "ndnd");
+  BOOST_CHECK_EQUAL(chatroom.isParticipant, false);
+  BOOST_CHECK_EQUAL(chatroom.isManager, false);
+  BOOST_CHECK_EQUAL(chatroom.count, 0);
+
+  chatroom.isParticipant = true;
+  BOOST_CHECK_EQUAL(table.get(ndnd).isParticipant, true);
+  BOOST_CHECK_EQUAL(table.size(), 1);
+
+  table.erase(ndnd);
+  BOOST_CHECK(table.find(ndnd) == table.end());
+  BOOST_CHECK_EQUAL(table.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Expiry)
+{
+  ChatroomDiscoveryTable table(8);
+  Name::Component ndnd("ndnd");
+  Name::Component nfd("nfd");
+
+  table.get(ndnd);
+  table.setExpiry(table.find(ndnd), 2);
+  table.get(nfd);
+  table.setExpiry(table.find(nfd), 2);
+
+  BOOST_CHECK_EQUAL(table.advance(), 0);
+
+  // refreshing moves the expiry, cancelling removes it
+  table.setExpiry(table.find(ndnd), 3);
+  table.cancelExpiry(table.find(nfd));
+
+  BOOST_CHECK_EQUAL(table.advance(), 0);
+  BOOST_CHECK_EQUAL(table.advance(), 0);
+  BOOST_CHECK_EQUAL(table.advance(), 1);
+  BOOST_CHECK(table.find(ndnd) == table.end());
+  BOOST_CHECK(table.find(nfd) != table.end());
+
+  // the wheel wraps around
+  table.setExpiry(table.find(nfd), 7);
+  for (int i = 0; i < 6; ++i)
+    BOOST_CHECK_EQUAL(table.advance(), 0);
+  BOOST_CHECK_EQUAL(table.advance(), 1);
+  BOOST_CHECK_EQUAL(table.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Changes)
+{
+  ChatroomDiscoveryTable table(8);
+  std::vector<std::string> added;
+  std::vector<std::string> removed;
+
+  table.get(Name::Component("ndnd"));
+  table.get(Name::Component("nfd"));
+  table.get(Name::Component("nfd"));
+  BOOST_CHECK(table.hasChanges());
+
+  table.takeChanges(added, removed);
+  std::sort(added.begin(), added.end());
+  BOOST_REQUIRE_EQUAL(added.size(), 2);
+  BOOST_CHECK_EQUAL(added[0], "ndnd");
+  BOOST_CHECK_EQUAL(added[1], "nfd");
+  BOOST_CHECK(removed.empty());
+  BOOST_CHECK(!table.hasChanges());
+
+  // a chatroom added and removed between two pushes is never reported
+  table.get(Name::Component("repo"));
+  table.erase(Name::Component("repo"));
+  BOOST_CHECK(!table.hasChanges());
+
+  // neither is a chatroom removed and added again
+  table.erase(Name::Component("ndnd"));
+  table.get(Name::Component("ndnd"));
+  BOOST_CHECK(!table.hasChanges());
+
+  table.setExpiry(table.find(Name::Component("nfd")), 1);
+  table.advance();
+
+  added.clear();
+  table.takeChanges(added, removed);
+  BOOST_CHECK(added.empty());
+  BOOST_REQUIRE_EQUAL(removed.size(), 1);
+  BOOST_CHECK_EQUAL(removed[0], "nfd");
+
+  // clearing the table is not reported
+  table.clear();
+  BOOST_CHECK(!table.hasChanges());
+  BOOST_CHECK_EQUAL(table.size(), 0);
+}
+
+static size_t
+getAllocatedBytes()
+{
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+  return mallinfo2().uordblks;
+#else
+  return static_cast<size_t>(mallinfo().uordblks);
+#endif
+#else
+  return 0;
+#endif
+}
+
+// Run with: unit-tests --run_test=TestChatroomDiscoveryTable/Benchmark --log_level=message
+BOOST_AUTO_TEST_CASE(Benchmark, *boost::unit_test::disabled())
+{
+  // the expiry of the chatrooms that the user is not in, as in the discovery backend
+  static const size_t EXPIRY_TICKS = 31;
+
+  ChatroomInfo info;
+  info.setName(Name::Component("chatroom"));
+  info.setManager("/ndn/ucla/alice");
+  info.setSyncPrefix("/ndn/broadcast/ChronoChat/chatroom");
+  info.addParticipant(Name("/ndn/ucla/alice"));
+  info.addParticipant(Name("/ndn/ucla/ymj"));
+  info.wireEncode();
+
+  for (size_t nChatrooms : {1000, 10000, 100000}) {
+    std::vector<Name::Component> names;
+    names.reserve(nChatrooms);
+    for (size_t i = 0; i < nChatrooms; ++i)
+      names.push_back(Name::Component("chatroom-" + std::to_string(i)));
+
+    size_t allocatedBefore = getAllocatedBytes();
+
+    ChatroomDiscoveryTable table(EXPIRY_TICKS + 1);
+    for (const auto& name : names) {
+      table.get(name).info = info;
+      table.setExpiry(table.find(name), EXPIRY_TICKS);
+    }
+
+    size_t bytesPerChatroom = (getAllocatedBytes() - allocatedBefore) / nChatrooms;
+
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
+    table.takeChanges(added, removed);
+    BOOST_CHECK_EQUAL(added.size(), nChatrooms);
+
+    // one hello round refreshes every chatroom, then a tick sweeps a bucket
+    auto start = time::steady_clock::now();
+    for (const auto& name : names)
+      table.setExpiry(table.find(name), EXPIRY_TICKS);
+    table.advance();
+    added.clear();
+    table.takeChanges(added, removed);
+    auto refreshTime = time::steady_clock::now() - start;
+    BOOST_CHECK(added.empty());
+
+    // the full list that used to be pushed to the panel on every refresh
+    start = time::steady_clock::now();
+    std::vector<std::string> fullList = table.getNames();
+    auto fullListTime = time::steady_clock::now() - start;
+    BOOST_CHECK_EQUAL(fullList.size(), nChatrooms);
+
+    BOOST_TEST_MESSAGE(nChatrooms << " chatrooms: "
+                       << bytesPerChatroom << " bytes per chatroom, "
+                       << time::duration_cast<time::microseconds>(refreshTime).count()
+                       << " us per refresh, "
+                       << time::duration_cast<time::microseconds>(fullListTime).count()
+                       << " us per full list");
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+
+} // namespace chronochat
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "chatroom-info-delta.hpp"
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/encoding/block.hpp>
+
+namespace chronochat {
+
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestChatroomInfoDelta)
+
+const uint8_t chatroomInfoDelta[] = {
+  0x99, 0x35, // ChatroomInfoDelta
+    0x81, 0x06, // ChatroomName
+      0x08, 0x04,
+        0x06e, 0x64, 0x6e, 0x64,
+    0x9a, 0x01, // BaseVersion
+      0x05,
+    0x9b, 0x12, // AddedParticipants
+      0x07, 0x10,
+        0x08, 0x03,
+          0x6e, 0x64, 0x6e,
+        0x08, 0x04,
+          0x75, 0x63, 0x6c, 0x61,
+        0x08, 0x03,
+          0x79, 0x6d, 0x6a,
+    0x9c, 0x14, // RemovedParticipants
+      0x07, 0x12,
+        0x08, 0x03,
+          0x6e, 0x64, 0x6e,
+        0x08, 0x04,
+          0x75, 0x63, 0x6c, 0x61,
+        0x08, 0x05,
+          0x61, 0x6c, 0x69, 0x63, 0x65
+};
+
+BOOST_AUTO_TEST_CASE(EncodeDelta)
+{
+  std::list<Name> base;
+  base.push_back(Name("/ndn/ucla/alice"));
+  base.push_back(Name("/ndn/ucla/bob"));
+
+  std::list<Name> current;
+  current.push_back(Name("/ndn/ucla/bob"));
+  current.push_back(Name("/ndn/ucla/ymj"));
+
+  ChatroomInfoDelta delta;
+  delta.setName(ndn::Name::Component("ndnd"));
+  delta.setBaseVersion(5);
+  delta.setParticipants(base, current);
+
+  BOOST_CHECK_EQUAL(delta.size(), 2);
+
+  const Block& encoded = delta.wireEncode();
+  Block deltaBlock(chatroomInfoDelta, sizeof(chatroomInfoDelta));
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(deltaBlock.wire(),
+                                deltaBlock.wire() + deltaBlock.size(),
+                                encoded.wire(),
+                                encoded.wire() + encoded.size());
+}
+
+BOOST_AUTO_TEST_CASE(DecodeDelta)
+{
+  Block deltaBlock(chatroomInfoDelta, sizeof(chatroomInfoDelta));
+  ChatroomInfoDelta delta(deltaBlock);
+
+  BOOST_CHECK_EQUAL(delta.getName(), ndn::Name::Component("ndnd"));
+  BOOST_CHECK_EQUAL(delta.getBaseVersion(), 5);
+  BOOST_REQUIRE_EQUAL(delta.getAddedParticipants().size(), 1);
+  BOOST_CHECK_EQUAL(delta.getAddedParticipants().front(), Name("/ndn/ucla/ymj"));
+  BOOST_REQUIRE_EQUAL(delta.getRemovedParticipants().size(), 1);
+  BOOST_CHECK_EQUAL(delta.getRemovedParticipants().front(), Name("/ndn/ucla/alice"));
+}
+
+BOOST_AUTO_TEST_CASE(ApplyDelta)
+{
+  ChatroomInfo snapshot;
+  snapshot.setName(ndn::Name::Component("ndnd"));
+  snapshot.setManager("/ndn/ucla/alice");
+  snapshot.setSyncPrefix("/ndn/broadcast");
+  snapshot.setTrustModel(ChatroomInfo::TRUST_MODEL_WEBOFTRUST);
+  snapshot.addParticipant(Name("/ndn/ucla/alice"));
+  snapshot.addParticipant(Name("/ndn/ucla/bob"));
+
+  ChatroomInfo current = snapshot;
+  current.removeParticipant(Name("/ndn/ucla/bob"));
+  current.addParticipant(Name("/ndn/ucla/ymj"));
+  current.addParticipant(Name("/ndn/ucla/carol"));
+
+  ChatroomInfoDelta delta;
+  delta.setName(snapshot.getName());
+  delta.setBaseVersion(1);
+  delta.setParticipants(snapshot.getParticipants(), current.getParticipants());
+
+  ChatroomInfo rebuilt = snapshot;
+  ChatroomInfoDelta(delta.wireEncode()).apply(rebuilt);
+
+  BOOST_CHECK_EQUAL_COLLECTIONS(rebuilt.getParticipants().begin(),
+                                rebuilt.getParticipants().end(),
+                                current.getParticipants().begin(),
+                                current.getParticipants().end());
+  BOOST_CHECK_EQUAL(rebuilt.getManagerPrefix(), snapshot.getManagerPrefix());
+
+  // an empty delta is a valid heartbeat
+  ChatroomInfoDelta heartbeat;
+  heartbeat.setName(snapshot.getName());
+  heartbeat.setBaseVersion(1);
+  heartbeat.setParticipants(snapshot.getParticipants(), snapshot.getParticipants());
+  BOOST_CHECK_EQUAL(heartbeat.size(), 0);
+  BOOST_CHECK_NO_THROW(ChatroomInfoDelta(heartbeat.wireEncode()));
+}
+
+BOOST_AUTO_TEST_CASE(DecodeDeltaError)
+{
+  const uint8_t error1[] = {
+    0x80, 0x0b, // ChatroomInfo Type Error
+      0x81, 0x06, // ChatroomName
+        0x08, 0x04,
+          0x06e, 0x64, 0x6e, 0x64,
+      0x9a, 0x01, // BaseVersion
+        0x05
+  };
+
+  Block errorBlock1(error1, sizeof(error1));
+  BOOST_CHECK_THROW(ChatroomInfoDelta delta(errorBlock1), ChatroomInfoDelta::Error);
+
+  const uint8_t error2[] = {
+    0x99, 0x0f, // ChatroomInfoDelta
+      0x81, 0x06, // ChatroomName
+        0x08, 0x04,
+          0x06e, 0x64, 0x6e, 0x64,
+      0x9a, 0x01, // BaseVersion
+        0x05,
+      0x9c, 0x00, // RemovedParticipants before AddedParticipants
+      0x9b, 0x00
+  };
+
+  Block errorBlock2(error2, sizeof(error2));
+  BOOST_CHECK_THROW(ChatroomInfoDelta delta(errorBlock2), ChatroomInfoDelta::Error);
+
+  const uint8_t error3[] = {
+    0x99, 0x0b, // ChatroomInfoDelta
+      0x81, 0x06, // ChatroomName
+        0x08, 0x04,
+          0x06e, 0x64, 0x6e, 0x64,
+      0x9a, 0x01, // BaseVersion
+        0x05
+    // no participant changes
+  };
+
+  Block errorBlock3(error3, sizeof(error3));
+  BOOST_CHECK_THROW(ChatroomInfoDelta delta(errorBlock3), ChatroomInfoDelta::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+
+} // namespace chronochat
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "chatroom-roster.hpp"
+
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+
+namespace chronochat {
+namespace tests {
+
+class ChatroomRosterFixture
+{
+public:
+  ChatroomRosterFixture()
+    : roster("lunch")
+    , alice("/ucla/alice/CHRONOCHAT-CHATDATA/lunch/%FD%01")
+    , bob("/ucla/bob/CHRONOCHAT-CHATDATA/lunch/%FD%02")
+  {
+    // the signals are delivered directly, there is no event loop in the tests
+    QObject::connect(&roster, &ChatroomRoster::sessionAdded,
+                     [this] (const Name& sessionPrefix, const QString&) {
+                       addedSessions.push_back(sessionPrefix);
+                     });
+    QObject::connect(&roster, &ChatroomRoster::sessionRemoved,
+                     [this] (const Name& sessionPrefix) {
+                       removedSessions.push_back(sessionPrefix);
+                     });
+    QObject::connect(&roster, &ChatroomRoster::participantAdded,
+                     [this] (const Name& participant, const Name::Component& chatroomName) {
+                       BOOST_CHECK_EQUAL(chatroomName, Name::Component("lunch"));
+                       addedParticipants.push_back(participant);
+                     });
+    QObject::connect(&roster, &ChatroomRoster::participantRemoved,
+                     [this] (const Name& participant, const Name::Component& chatroomName) {
+                       BOOST_CHECK_EQUAL(chatroomName, Name::Component("lunch"));
+                       removedParticipants.push_back(participant);
+                     });
+  }
+
+public:
+  ChatroomRoster roster;
+  Name alice;
+  Name bob;
+
+  std::vector<Name> addedSessions;
+  std::vector<Name> removedSessions;
+  std::vector<Name> addedParticipants;
+  std::vector<Name> removedParticipants;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestChatroomRoster, ChatroomRosterFixture)
+
+BOOST_AUTO_TEST_CASE(AddRemove)
+{
+  BOOST_CHECK(roster.addSession(alice, "Alice", true));
+  BOOST_CHECK(roster.addSession(bob, "Bob"));
+  BOOST_CHECK(!roster.addSession(bob, "Robert"));
+  BOOST_CHECK_EQUAL(roster.size(), 2);
+  BOOST_CHECK(roster.hasSession(alice));
+  BOOST_CHECK(roster.hasSession(bob));
+  BOOST_REQUIRE_EQUAL(addedSessions.size(), 2);
+  BOOST_CHECK_EQUAL(addedSessions[0], alice);
+  BOOST_CHECK_EQUAL(addedSessions[1], bob);
+
+  BOOST_CHECK(roster.removeSession(bob));
+  BOOST_CHECK(!roster.removeSession(bob));
+  BOOST_CHECK_EQUAL(roster.size(), 1);
+  BOOST_CHECK(!roster.hasSession(bob));
+  BOOST_REQUIRE_EQUAL(removedSessions.size(), 1);
+  BOOST_CHECK_EQUAL(removedSessions[0], bob);
+
+  // a reset does not notify, the chat dialog is reset at the same time
+  roster.clear();
+  BOOST_CHECK_EQUAL(roster.size(), 0);
+  BOOST_CHECK_EQUAL(removedSessions.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(RemoteParticipants)
+{
+  // the local session is announced to discovery by the chatroom join instead
+  roster.addSession(alice, "Alice", true);
+  BOOST_CHECK(addedParticipants.empty());
+
+  roster.addSession(bob, "Bob");
+  BOOST_REQUIRE_EQUAL(addedParticipants.size(), 1);
+  BOOST_CHECK_EQUAL(addedParticipants[0], Name("/ucla/bob"));
+
+  roster.removeSession(bob);
+  BOOST_REQUIRE_EQUAL(removedParticipants.size(), 1);
+  BOOST_CHECK_EQUAL(removedParticipants[0], Name("/ucla/bob"));
+}
+
+BOOST_AUTO_TEST_CASE(Queries)
+{
+  roster.addSession(alice, "Alice", true);
+  roster.addSession(bob, "Bob");
+
+  std::vector<Name> participants = roster.getParticipants();
+  std::sort(participants.begin(), participants.end());
+  BOOST_REQUIRE_EQUAL(participants.size(), 2);
+  BOOST_CHECK_EQUAL(participants[0], Name("/ucla/alice"));
+  BOOST_CHECK_EQUAL(participants[1], Name("/ucla/bob"));
+
+  BOOST_CHECK_EQUAL(roster.getNick(alice), "Alice");
+  BOOST_CHECK_EQUAL(roster.getNick(bob), "Bob");
+  BOOST_CHECK_EQUAL(roster.getNick("/ucla/carol/CHRONOCHAT-CHATDATA/lunch/%FD%03"), "");
+
+  QStringList nickList = roster.getNickList();
+  BOOST_CHECK_EQUAL(nickList.size(), 2);
+  BOOST_CHECK(nickList.contains("- Alice"));
+  BOOST_CHECK(nickList.contains("- Bob"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "collected-endorsements.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/security/transform/buffer-source.hpp>
+#include <ndn-cxx/security/transform/digest-filter.hpp>
+#include <ndn-cxx/security/transform/stream-sink.hpp>
+
+namespace chronochat {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestCollectedEndorsements)
+
+BOOST_AUTO_TEST_CASE(Changes)
+{
+  CollectedEndorsements endorsements;
+  BOOST_CHECK(endorsements.needsPublishing());
+
+  BOOST_CHECK(endorsements.set("/ndn/alice", "/ndn/alice/endorse/1", "hash-a1"));
+  BOOST_CHECK(endorsements.set("/ndn/bob", "/ndn/bob/endorse/1", "hash-b1"));
+  BOOST_CHECK_EQUAL(endorsements.size(), 2);
+  endorsements.markPublished();
+  BOOST_CHECK(!endorsements.needsPublishing());
+
+  // the same entry again is not a change
+  BOOST_CHECK(!endorsements.set("/ndn/alice", "/ndn/alice/endorse/1", "hash-a1"));
+  BOOST_CHECK(!endorsements.needsPublishing());
+
+  // an entry is replaced by the next endorsement of the same endorser
+  BOOST_CHECK(endorsements.set("/ndn/alice", "/ndn/alice/endorse/2", "hash-a2"));
+  BOOST_CHECK_EQUAL(endorsements.size(), 2);
+  BOOST_CHECK(endorsements.needsPublishing());
+
+  // changes that cancel each other leave the published content as it is
+  BOOST_CHECK(endorsements.set("/ndn/alice", "/ndn/alice/endorse/1", "hash-a1"));
+  BOOST_CHECK(!endorsements.needsPublishing());
+
+  // the digest does not depend on the order of the changes
+  CollectedEndorsements other;
+  other.set("/ndn/bob", "/ndn/bob/endorse/1", "hash-b1");
+  other.set("/ndn/alice", "/ndn/alice/endorse/1", "hash-a1");
+  other.markPublished();
+  other.set("/ndn/alice", "/ndn/alice/endorse/2", "hash-a2");
+  other.set("/ndn/bob", "/ndn/bob/endorse/2", "hash-b2");
+  BOOST_CHECK(other.needsPublishing());
+  other.set("/ndn/bob", "/ndn/bob/endorse/1", "hash-b1");
+  BOOST_CHECK(other.needsPublishing());
+  other.set("/ndn/alice", "/ndn/alice/endorse/1", "hash-a1");
+  BOOST_CHECK(!other.needsPublishing());
+
+  endorsements.clear();
+  BOOST_CHECK_EQUAL(endorsements.size(), 0);
+  BOOST_CHECK(endorsements.needsPublishing());
+}
+
+BOOST_AUTO_TEST_CASE(Encode)
+{
+  CollectedEndorsements endorsements;
+  endorsements.set("/ndn/bob", "/ndn/bob/endorse/1", "hash-b1");
+  endorsements.set("/ndn/alice", "/ndn/alice/endorse/1", "hash-a1");
+
+  EndorseCollection collection(endorsements.wireEncode());
+  BOOST_REQUIRE_EQUAL(collection.getCollectionEntries().size(), 2);
+  BOOST_CHECK_EQUAL(collection.getCollectionEntries()[0].certName, Name("/ndn/alice/endorse/1"));
+  BOOST_CHECK_EQUAL(collection.getCollectionEntries()[0].hash, "hash-a1");
+  BOOST_CHECK_EQUAL(collection.getCollectionEntries()[1].certName, Name("/ndn/bob/endorse/1"));
+
+  // the encoding is kept until the next change
+  const uint8_t* wire = endorsements.wireEncode().wire();
+  BOOST_CHECK(endorsements.wireEncode().wire() == wire);
+  endorsements.set("/ndn/bob", "/ndn/bob/endorse/2", "hash-b2");
+  EndorseCollection changed(endorsements.wireEncode());
+  BOOST_CHECK_EQUAL(changed.getCollectionEntries()[1].certName, Name("/ndn/bob/endorse/2"));
+}
+
+BOOST_AUTO_TEST_CASE(Hash)
+{
+  Data data(Name("/ndn/alice/endorse/1"));
+  data.setContent(reinterpret_cast<const uint8_t*>("endorse"), 7);
+  ndn::KeyChain keyChain("pib-memory:", "tpm-memory:");
+  keyChain.sign(data, ndn::security::signingWithSha256());
+
+  // the hash is the one checked against the endorse certificates that are fetched
+  std::ostringstream ss;
+  {
+    using namespace ndn::security::transform;
+    bufferSource(data.wireEncode().wire(), data.wireEncode().size())
+      >> digestFilter(ndn::DigestAlgorithm::SHA256)
+      >> streamSink(ss);
+  }
+  BOOST_CHECK_EQUAL(CollectedEndorsements::computeHash(data.wireEncode()), ss.str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
@@ -7,9 +7,13 @@
 
 #include "contact-storage.hpp"
 
+#include <ndn-cxx/security/key-chain.hpp>
+
 #include <boost/test/unit_test.hpp>
 #include <boost/filesystem.hpp>
 
+#include <future>
+
 namespace chronochat {
 namespace tests {
 
@@ -29,6 +33,266 @@ BOOST_AUTO_TEST_CASE(InitializeTable)
   BOOST_CHECK(boost::filesystem::exists(dbPath));
 }
 
+static Contact
+makeContact(const Name& identity)
+{
+  const uint8_t key[] = {0x01, 0x02, 0x03, 0x04};
+  Contact contact(identity, identity.get(-1).toUri(), Name(identity).append("KEY").append("1"),
+                  time::system_clock::now(), time::system_clock::now() + time::days(365),
+                  ndn::Buffer(key, sizeof(key)), true);
+
+  Profile profile(identity);
+  profile["name"] = identity.get(-1).toUri();
+  profile["institution"] = "UCLA";
+  contact.setProfile(profile);
+  contact.addTrustScope(identity);
+  return contact;
+}
+
+BOOST_AUTO_TEST_CASE(ReuseStatements)
+{
+  ContactStorage contactStorage(Name("/TestContactStorage/ReuseStatements"));
+  Name alice("/TestContactStorage/ReuseStatements/alice");
+  Name bob("/TestContactStorage/ReuseStatements/bob");
+  contactStorage.removeContact(alice);
+  contactStorage.removeContact(bob);
+
+  contactStorage.addContact(makeContact(alice));
+  contactStorage.addContact(makeContact(bob));
+  BOOST_CHECK_THROW(contactStorage.addContact(makeContact(bob)), ContactStorage::Error);
+
+  // a reused statement does not keep the bindings or the rows of its previous use
+  for (int i = 0; i < 3; ++i) {
+    shared_ptr<Contact> contact = contactStorage.getContact(alice);
+    BOOST_REQUIRE(contact != nullptr);
+    BOOST_CHECK_EQUAL(contact->getAlias(), "alice");
+    BOOST_CHECK_EQUAL(contact->getProfile().get("institution"), "UCLA");
+
+    contact = contactStorage.getContact(bob);
+    BOOST_REQUIRE(contact != nullptr);
+    BOOST_CHECK_EQUAL(contact->getAlias(), "bob");
+  }
+  BOOST_CHECK(contactStorage.getContact(Name("/TestContactStorage/ReuseStatements/carol")) ==
+              nullptr);
+
+  std::vector<shared_ptr<Contact>> contacts;
+  contactStorage.getAllContacts(contacts);
+  BOOST_CHECK_EQUAL(contacts.size(), 2);
+
+  contactStorage.removeContact(alice);
+  BOOST_CHECK(contactStorage.getContact(alice) == nullptr);
+  contactStorage.removeContact(bob);
+}
+
+BOOST_AUTO_TEST_CASE(GetAllContacts)
+{
+  ContactStorage contactStorage(Name("/TestContactStorage/GetAllContacts"));
+  std::vector<shared_ptr<Contact>> contacts;
+  contactStorage.getAllContacts(contacts);
+  for (const auto& contact : contacts)
+    contactStorage.removeContact(contact->getNameSpace());
+
+  Name alice("/TestContactStorage/GetAllContacts/alice");
+  Name bob("/TestContactStorage/GetAllContacts/bob");
+  contactStorage.addContact(makeContact(alice));
+  Contact contact = makeContact(bob);
+  contact.setIsIntroducer(false);
+  contactStorage.addContact(contact);
+
+  contacts.clear();
+  contactStorage.getAllContacts(contacts);
+  BOOST_REQUIRE_EQUAL(contacts.size(), 2);
+
+  // the bulk loader assembles the same contacts as the lookup of each one
+  for (const auto& loaded : contacts) {
+    shared_ptr<Contact> expected = contactStorage.getContact(loaded->getNameSpace());
+    BOOST_REQUIRE(expected != nullptr);
+    BOOST_CHECK_EQUAL(loaded->getAlias(), expected->getAlias());
+    BOOST_CHECK_EQUAL(loaded->getPublicKeyName(), expected->getPublicKeyName());
+    BOOST_CHECK(loaded->getPublicKey() == expected->getPublicKey());
+    BOOST_CHECK_EQUAL(loaded->isIntroducer(), expected->isIntroducer());
+    BOOST_CHECK(loaded->getProfile() == expected->getProfile());
+    BOOST_CHECK_EQUAL(loaded->getName(), loaded->getNameSpace().get(-1).toUri());
+    BOOST_CHECK_EQUAL(std::distance(loaded->trustScopeBegin(), loaded->trustScopeEnd()),
+                      std::distance(expected->trustScopeBegin(), expected->trustScopeEnd()));
+  }
+
+  contactStorage.removeContact(alice);
+  contactStorage.removeContact(bob);
+}
+
+BOOST_AUTO_TEST_CASE(BatchAndQueuedWrites)
+{
+  ContactStorage contactStorage(Name("/TestContactStorage/BatchAndQueuedWrites"));
+  std::vector<Contact> batch;
+  for (int i = 0; i < 10; ++i) {
+    batch.push_back(makeContact(Name("/TestContactStorage/BatchAndQueuedWrites/user-" +
+                                     std::to_string(i))));
+    contactStorage.removeContact(batch.back().getNameSpace());
+  }
+
+  BOOST_CHECK_EQUAL(contactStorage.addContacts(batch), 10);
+  // existing contacts are skipped
+  BOOST_CHECK_EQUAL(contactStorage.addContacts(batch), 0);
+
+  // a queued contact is visible before it is written
+  Name carol("/TestContactStorage/BatchAndQueuedWrites/carol");
+  contactStorage.removeContact(carol);
+  contactStorage.queueContact(makeContact(carol));
+  BOOST_CHECK_THROW(contactStorage.queueContact(makeContact(carol)), ContactStorage::Error);
+  BOOST_CHECK_THROW(contactStorage.addContact(makeContact(carol)), ContactStorage::Error);
+  BOOST_CHECK(contactStorage.getContact(carol) != nullptr);
+
+  std::vector<shared_ptr<Contact>> contacts;
+  contactStorage.getAllContacts(contacts);
+  BOOST_CHECK_EQUAL(contacts.size(), 11);
+
+  contactStorage.flush();
+  contacts.clear();
+  contactStorage.getAllContacts(contacts);
+  BOOST_CHECK_EQUAL(contacts.size(), 11);
+
+  // updates are applied after the queued contacts are written
+  contactStorage.updateAlias(carol, "Carol");
+  BOOST_CHECK_EQUAL(contactStorage.getContact(carol)->getAlias(), "Carol");
+
+  contactStorage.removeContact(carol);
+  for (const auto& contact : batch)
+    contactStorage.removeContact(contact.getNameSpace());
+}
+
+BOOST_AUTO_TEST_CASE(QueuedWriteFailure)
+{
+  Name identity("/TestContactStorage/QueuedWriteFailure");
+  ContactStorage contactStorage(identity);
+  Name alice = Name(identity).append("alice");
+  Name bob = Name(identity).append("bob");
+  contactStorage.removeContact(alice);
+  contactStorage.removeContact(bob);
+
+  std::promise<std::vector<Contact>> failure;
+  contactStorage.setOnWriteFailed([&] (const std::vector<Contact>& contacts, const std::string&) {
+    failure.set_value(contacts);
+  });
+
+  // another connection holds the write lock of the database
+  fs::path dbPath = fs::path(getenv("HOME")) / ".chronos" / contactStorage.getDBName();
+  sqlite3* other = nullptr;
+  BOOST_REQUIRE_EQUAL(sqlite3_open(dbPath.c_str(), &other), SQLITE_OK);
+  BOOST_REQUIRE_EQUAL(sqlite3_exec(other, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr),
+                      SQLITE_OK);
+
+  // the queued contact is kept while the lock is held, and written once it is released
+  contactStorage.queueContact(makeContact(alice));
+  BOOST_CHECK(contactStorage.getContact(alice) != nullptr);
+  sqlite3_exec(other, "ROLLBACK", nullptr, nullptr, nullptr);
+  contactStorage.flush();
+  BOOST_CHECK(contactStorage.getContact(alice) != nullptr);
+
+  // the writer gives up after a few attempts, and reports the contacts it could not write
+  BOOST_REQUIRE_EQUAL(sqlite3_exec(other, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr),
+                      SQLITE_OK);
+  contactStorage.queueContact(makeContact(bob));
+  contactStorage.flush();
+
+  std::future<std::vector<Contact>> failed = failure.get_future();
+  BOOST_REQUIRE(failed.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  std::vector<Contact> failedContacts = failed.get();
+  BOOST_REQUIRE_EQUAL(failedContacts.size(), 1);
+  BOOST_CHECK_EQUAL(failedContacts[0].getNameSpace(), bob);
+  BOOST_CHECK(contactStorage.getContact(bob) == nullptr);
+
+  sqlite3_exec(other, "ROLLBACK", nullptr, nullptr, nullptr);
+  sqlite3_close(other);
+  contactStorage.removeContact(alice);
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark, *boost::unit_test::disabled())
+{
+  const size_t N_CONTACTS = 1000;
+  const size_t N_LOOKUPS = 20000;
+
+  ContactStorage contactStorage(Name("/TestContactStorage/Benchmark"));
+  ndn::KeyChain keyChain("pib-memory:", "tpm-memory:");
+
+  std::vector<Name> identities;
+  std::vector<Contact> batch;
+  for (size_t i = 0; i < N_CONTACTS; ++i) {
+    identities.push_back(Name("/TestContactStorage/Benchmark/user-" + std::to_string(i)));
+    batch.push_back(makeContact(identities.back()));
+    contactStorage.removeContact(identities.back());
+  }
+
+  // importing the contacts one transaction per contact versus one batch
+  auto start = time::steady_clock::now();
+  for (const auto& contact : batch)
+    contactStorage.addContact(contact);
+  auto singleTime = time::steady_clock::now() - start;
+
+  for (const auto& identity : identities)
+    contactStorage.removeContact(identity);
+
+  start = time::steady_clock::now();
+  BOOST_CHECK_EQUAL(contactStorage.addContacts(batch), N_CONTACTS);
+  auto batchTime = time::steady_clock::now() - start;
+
+  BOOST_TEST_MESSAGE(N_CONTACTS << " contacts: "
+                     << time::duration_cast<time::milliseconds>(singleTime).count()
+                     << " ms to add them one by one, "
+                     << time::duration_cast<time::milliseconds>(batchTime).count()
+                     << " ms to add them in a batch");
+
+  Data profileData(Name("/TestContactStorage/Benchmark/DNS/PROFILE"));
+  profileData.setContent(reinterpret_cast<const uint8_t*>("profile"), 7);
+  keyChain.sign(profileData, ndn::security::signingWithSha256());
+  contactStorage.updateDnsSelfProfileData(profileData);
+
+  auto perSecond = [=] (time::steady_clock::Duration elapsed) {
+    auto us = time::duration_cast<time::microseconds>(elapsed).count();
+    return N_LOOKUPS * 1000000 / std::max<int64_t>(us, 1);
+  };
+
+  for (bool isCacheEnabled : {false, true}) {
+    contactStorage.m_isStatementCacheEnabled = isCacheEnabled;
+
+    start = time::steady_clock::now();
+    for (size_t i = 0; i < N_LOOKUPS; ++i)
+      BOOST_REQUIRE(contactStorage.getContact(identities[i % N_CONTACTS]) != nullptr);
+    auto contactTime = time::steady_clock::now() - start;
+
+    start = time::steady_clock::now();
+    for (size_t i = 0; i < N_LOOKUPS; ++i)
+      BOOST_REQUIRE(contactStorage.getDnsData("N/A", "PROFILE") != nullptr);
+    auto dnsTime = time::steady_clock::now() - start;
+
+    BOOST_TEST_MESSAGE("statement cache " << (isCacheEnabled ? "enabled: " : "disabled: ")
+                       << perSecond(contactTime) << " contact lookups/s, "
+                       << perSecond(dnsTime) << " DNS lookups/s");
+  }
+
+  // loading the contact list at startup, one lookup per contact versus the bulk loader
+  start = time::steady_clock::now();
+  std::vector<shared_ptr<Contact>> contacts;
+  for (const auto& identity : identities)
+    contacts.push_back(contactStorage.getContact(identity));
+  auto lookupTime = time::steady_clock::now() - start;
+
+  start = time::steady_clock::now();
+  contacts.clear();
+  contactStorage.getAllContacts(contacts);
+  auto bulkTime = time::steady_clock::now() - start;
+  BOOST_CHECK_GE(contacts.size(), N_CONTACTS);
+
+  BOOST_TEST_MESSAGE(N_CONTACTS << " contacts: "
+                     << time::duration_cast<time::milliseconds>(lookupTime).count()
+                     << " ms with one lookup per contact, "
+                     << time::duration_cast<time::milliseconds>(bulkTime).count()
+                     << " ms with the bulk loader");
+
+  for (const auto& identity : identities)
+    contactStorage.removeContact(identity);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } // namespace tests
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "content-store.hpp"
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace chronochat {
+
+namespace tests {
+
+class ContentStoreFixture
+{
+public:
+  ContentStoreFixture()
+    : clock(std::make_shared<time::UnitTestSteadyClock>())
+  {
+    time::setCustomClocks(clock);
+  }
+
+  ~ContentStoreFixture()
+  {
+    time::setCustomClocks();
+  }
+
+  static shared_ptr<Data>
+  makeData(const Name& name, time::milliseconds freshnessPeriod = time::milliseconds::zero())
+  {
+    auto data = std::make_shared<Data>(name);
+    data->setFreshnessPeriod(freshnessPeriod);
+    return data;
+  }
+
+public:
+  shared_ptr<time::UnitTestSteadyClock> clock;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestContentStore, ContentStoreFixture)
+
+BOOST_AUTO_TEST_CASE(Lru)
+{
+  ContentStore store(2, time::seconds(60));
+
+  store.insert("/alice/DNS/PROFILE", makeData("/alice/DNS/PROFILE/%FD%01"));
+  store.insert("/alice/DNS/ENDORSED", makeData("/alice/DNS/ENDORSED/%FD%01"));
+  BOOST_REQUIRE(store.find("/alice/DNS/PROFILE") != nullptr);
+  BOOST_CHECK_EQUAL(store.find("/alice/DNS/PROFILE")->getName(), "/alice/DNS/PROFILE/%FD%01");
+
+  // the least recently used entry is evicted
+  store.insert("/alice/KEY/1", makeData("/alice/KEY/1"));
+  BOOST_CHECK_EQUAL(store.size(), 2);
+  BOOST_CHECK(store.find("/alice/DNS/ENDORSED") == nullptr);
+  BOOST_CHECK(store.find("/alice/DNS/PROFILE") != nullptr);
+  BOOST_CHECK(store.find("/alice/KEY/1") != nullptr);
+
+  // a new data replaces the entry
+  store.insert("/alice/KEY/1", makeData("/alice/KEY/1/self"));
+  BOOST_CHECK_EQUAL(store.size(), 2);
+  BOOST_CHECK_EQUAL(store.find("/alice/KEY/1")->getName(), "/alice/KEY/1/self");
+
+  BOOST_CHECK_EQUAL(store.getNHits(), 5);
+  BOOST_CHECK_EQUAL(store.getNMisses(), 1);
+  BOOST_CHECK_CLOSE(store.getHitRate(), 5.0 / 6.0, 0.001);
+}
+
+BOOST_AUTO_TEST_CASE(Freshness)
+{
+  ContentStore store(10, time::seconds(60));
+
+  store.insert("/alice/DNS/PROFILE", makeData("/alice/DNS/PROFILE/%FD%01",
+                                              time::milliseconds(1000)));
+  store.insert("/alice/KEY/1", makeData("/alice/KEY/1"));
+
+  clock->advance(time::milliseconds(500));
+  BOOST_CHECK(store.find("/alice/DNS/PROFILE") != nullptr);
+
+  // the entry is not served once its FreshnessPeriod runs out
+  clock->advance(time::milliseconds(600));
+  BOOST_CHECK(store.find("/alice/DNS/PROFILE") == nullptr);
+  BOOST_CHECK_EQUAL(store.size(), 1);
+
+  // data without FreshnessPeriod is kept for the maximum lifetime
+  clock->advance(time::seconds(58));
+  BOOST_CHECK(store.find("/alice/KEY/1") != nullptr);
+  clock->advance(time::seconds(1));
+  BOOST_CHECK(store.find("/alice/KEY/1") == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Erase)
+{
+  ContentStore store(10, time::seconds(60));
+
+  store.insert("/alice/DNS", makeData("/alice/DNS/%FD%01"));
+  store.insert("/alice/DNS/PROFILE", makeData("/alice/DNS/PROFILE/%FD%01"));
+  store.insert("/alice/DNS/bob/ENDORSEE", makeData("/alice/DNS/bob/ENDORSEE/%FD%01"));
+  store.insert("/alice/KEY/1", makeData("/alice/KEY/1"));
+  store.insert("/alice/DNSSEC", makeData("/alice/DNSSEC"));
+
+  store.erase("/alice/DNS");
+  BOOST_CHECK_EQUAL(store.size(), 2);
+  BOOST_CHECK(store.find("/alice/DNS/PROFILE") == nullptr);
+  BOOST_CHECK(store.find("/alice/KEY/1") != nullptr);
+  BOOST_CHECK(store.find("/alice/DNSSEC") != nullptr);
+
+  store.clear();
+  BOOST_CHECK_EQUAL(store.size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+
+} // namespace chronochat
@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "discovery-cache.hpp"
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace chronochat {
+
+namespace tests {
+
+namespace fs = boost::filesystem;
+
+class DiscoveryCacheFixture
+{
+public:
+  DiscoveryCacheFixture()
+    : dir(fs::temp_directory_path() / fs::unique_path())
+    , path((dir / "discovery-cache").string())
+  {
+  }
+
+  ~DiscoveryCacheFixture()
+  {
+    boost::system::error_code error;
+    fs::remove_all(dir, error);
+  }
+
+  static DiscoveryCache::Entry
+  makeEntry(const std::string& chatroomName, time::system_clock::TimePoint timestamp)
+  {
+    DiscoveryCache::Entry entry;
+    entry.info.setName(Name::Component(chatroomName));
+    entry.info.setManager("/ndn/ucla/alice");
+    entry.info.setSyncPrefix("/ndn/broadcast/ChronoChat/" + chatroomName);
+    entry.info.setTrustModel(ChatroomInfo::TRUST_MODEL_NONE);
+    entry.info.addParticipant(Name("/ndn/ucla/alice"));
+    entry.timestamp = timestamp;
+    return entry;
+  }
+
+public:
+  fs::path dir;
+  std::string path;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestDiscoveryCache, DiscoveryCacheFixture)
+
+BOOST_AUTO_TEST_CASE(SaveAndLoad)
+{
+  DiscoveryCache cache(path, time::hours(24));
+  BOOST_CHECK(cache.load().empty());
+
+  // timestamps are kept with a millisecond precision
+  time::system_clock::TimePoint now =
+    time::fromUnixTimestamp(time::toUnixTimestamp(time::system_clock::now()));
+
+  std::vector<DiscoveryCache::Entry> entries;
+  entries.push_back(makeEntry("ndnd", now));
+  entries.push_back(makeEntry("nfd", now - time::hours(1)));
+  entries.push_back(makeEntry("repo", now - time::hours(48)));
+  cache.save(entries);
+
+  std::vector<DiscoveryCache::Entry> loaded = cache.load();
+  BOOST_REQUIRE_EQUAL(loaded.size(), 2);
+  BOOST_CHECK_EQUAL(loaded[0].info.getName(), Name::Component("ndnd"));
+  BOOST_CHECK(loaded[0].timestamp == now);
+  BOOST_CHECK_EQUAL(loaded[0].info.getSyncPrefix(), Name("/ndn/broadcast/ChronoChat/ndnd"));
+  BOOST_CHECK_EQUAL(loaded[0].info.getParticipants().size(), 1);
+  BOOST_CHECK_EQUAL(loaded[1].info.getName(), Name::Component("nfd"));
+
+  // saving replaces the previous content
+  entries.resize(1);
+  cache.save(entries);
+  BOOST_CHECK_EQUAL(cache.load().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Corrupted)
+{
+  DiscoveryCache cache(path, time::hours(24));
+  time::system_clock::TimePoint now = time::system_clock::now();
+
+  Block first = DiscoveryCache::encodeEntry(makeEntry("ndnd", now));
+  Block second = DiscoveryCache::encodeEntry(makeEntry("nfd", now));
+  const uint8_t garbage[] = {0x81, 0x02, 0x01, 0x02};
+
+  {
+    std::ofstream os(path, std::ios::binary);
+    os.write(reinterpret_cast<const char*>(first.wire()), first.size());
+    // a well formed block that is not an entry is skipped
+    os.write(reinterpret_cast<const char*>(garbage), sizeof(garbage));
+    os.write(reinterpret_cast<const char*>(second.wire()), second.size());
+    // a truncated entry ends the cache
+    os.write(reinterpret_cast<const char*>(first.wire()), first.size() / 2);
+  }
+
+  std::vector<DiscoveryCache::Entry> loaded = cache.load();
+  BOOST_REQUIRE_EQUAL(loaded.size(), 2);
+  BOOST_CHECK_EQUAL(loaded[0].info.getName(), Name::Component("ndnd"));
+  BOOST_CHECK_EQUAL(loaded[1].info.getName(), Name::Component("nfd"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+
+} // namespace chronochat
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "endorse-verification-cache.hpp"
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace chronochat {
+
+namespace tests {
+
+class EndorseVerificationCacheFixture
+{
+public:
+  EndorseVerificationCacheFixture()
+    : keyChain("pib-memory:", "tpm-memory:")
+    , endorsee("/TestEndorseVerificationCache/endorsee")
+    , introducer("/TestEndorseVerificationCache/introducer")
+    , nLookups(0)
+  {
+    ndn::security::Key key = keyChain.createIdentity(introducer).getDefaultKey();
+
+    Profile profile(endorsee);
+    profile["name"] = "endorsee";
+    std::vector<std::string> endorseList{"name"};
+    const uint8_t endorseeKey[] = {0x01, 0x02, 0x03, 0x04};
+
+    cert = std::make_shared<EndorseCertificate>(Name(endorsee).append("KEY").append("1"),
+                                                ndn::Buffer(endorseeKey, sizeof(endorseeKey)),
+                                                time::system_clock::now(),
+                                                time::system_clock::now() + time::days(365),
+                                                key.getName().get(-1), introducer,
+                                                profile, endorseList);
+    keyChain.sign(*cert, ndn::security::signingByKey(key)
+                           .setSignatureInfo(cert->getSignatureInfo()));
+
+    contact = std::make_shared<Contact>(introducer, "introducer", key.getName(),
+                                        time::system_clock::now(),
+                                        time::system_clock::now() + time::days(365),
+                                        key.getPublicKey(), true);
+    contact->addTrustScope(Name("/TestEndorseVerificationCache"));
+    trustScopes.addContact(*contact);
+
+    findContact = [this] (const Name& signer) {
+      nLookups++;
+      return signer == introducer ? contact : shared_ptr<Contact>();
+    };
+  }
+
+public:
+  ndn::KeyChain keyChain;
+  Name endorsee;
+  Name introducer;
+  shared_ptr<EndorseCertificate> cert;
+  shared_ptr<Contact> contact;
+  function<shared_ptr<Contact>(const Name&)> findContact;
+  TrustScopeIndex trustScopes;
+  size_t nLookups;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestEndorseVerificationCache, EndorseVerificationCacheFixture)
+
+BOOST_AUTO_TEST_CASE(Memoize)
+{
+  EndorseVerificationCache cache;
+
+  BOOST_CHECK(cache.verify(*cert, endorsee, findContact, trustScopes));
+  BOOST_CHECK_EQUAL(nLookups, 1);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+
+  // the verdict is reused without looking the signer up or verifying the signature again
+  BOOST_CHECK(cache.verify(*cert, endorsee, findContact, trustScopes));
+  BOOST_CHECK_EQUAL(nLookups, 1);
+
+  // a verdict outlives a change of the contact until the cache is cleared
+  contact->setIsIntroducer(false);
+  BOOST_CHECK(cache.verify(*cert, endorsee, findContact, trustScopes));
+  cache.clear();
+  BOOST_CHECK(!cache.verify(*cert, endorsee, findContact, trustScopes));
+  BOOST_CHECK_EQUAL(nLookups, 2);
+}
+
+BOOST_AUTO_TEST_CASE(Reject)
+{
+  EndorseVerificationCache cache;
+
+  // the introducer is not trusted for the endorsee
+  contact->deleteTrustScope(Name("/TestEndorseVerificationCache"));
+  contact->addTrustScope(Name("/Elsewhere"));
+  trustScopes.remove(introducer);
+  trustScopes.addContact(*contact);
+  BOOST_CHECK(!cache.verify(*cert, endorsee, findContact, trustScopes));
+
+  // the signature does not match the key of the signer
+  cache.clear();
+  trustScopes.add(introducer, Name("/TestEndorseVerificationCache"));
+  ndn::security::Key otherKey =
+    keyChain.createIdentity("/TestEndorseVerificationCache/other").getDefaultKey();
+  keyChain.sign(*cert, ndn::security::signingByKey(otherKey)
+                         .setSignatureInfo(cert->getSignatureInfo()));
+  BOOST_CHECK(!cache.verify(*cert, endorsee, findContact, trustScopes));
+
+  // the signer is unknown
+  cache.clear();
+  introducer = Name("/TestEndorseVerificationCache/stranger");
+  BOOST_CHECK(!cache.verify(*cert, endorsee, findContact, trustScopes));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+
+} // namespace chronochat
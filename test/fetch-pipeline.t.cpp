@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "fetch-pipeline.hpp"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+
+namespace chronochat {
+
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestFetchPipeline)
+
+BOOST_AUTO_TEST_CASE(Window)
+{
+  auto pipeline = std::make_shared<FetchPipeline>(3);
+
+  std::vector<int> started;
+  std::vector<function<void()>> pending;
+  for (int i = 0; i < 10; ++i) {
+    pipeline->add([&started, &pending, i] (const function<void()>& done) {
+      started.push_back(i);
+      pending.push_back(done);
+    });
+  }
+
+  int nFinished = 0;
+  pipeline->start([&] { ++nFinished; });
+  BOOST_CHECK_EQUAL(started.size(), 3);
+  BOOST_CHECK_EQUAL(pipeline->getNInFlight(), 3);
+
+  // fetches complete out of order, a new one starts for each completion
+  function<void()> done = pending[1];
+  pending.erase(pending.begin() + 1);
+  done();
+  BOOST_CHECK_EQUAL(started.size(), 4);
+  BOOST_CHECK_EQUAL(started.back(), 3);
+
+  while (!pending.empty()) {
+    done = pending.back();
+    pending.pop_back();
+    BOOST_CHECK_EQUAL(nFinished, 0);
+    done();
+  }
+
+  BOOST_CHECK_EQUAL(started.size(), 10);
+  for (int i = 0; i < 10; ++i)
+    BOOST_CHECK_EQUAL(std::count(started.begin(), started.end(), i), 1);
+  BOOST_CHECK_EQUAL(pipeline->getNInFlight(), 0);
+  BOOST_CHECK_EQUAL(pipeline->getMaxInFlight(), 3);
+  BOOST_CHECK_EQUAL(nFinished, 1);
+}
+
+BOOST_AUTO_TEST_CASE(Synchronous)
+{
+  auto pipeline = std::make_shared<FetchPipeline>(2);
+
+  size_t nCompleted = 0;
+  for (int i = 0; i < 1000; ++i) {
+    pipeline->add([&nCompleted] (const function<void()>& done) {
+      ++nCompleted;
+      done();
+    });
+  }
+
+  int nFinished = 0;
+  pipeline->start([&] { ++nFinished; });
+  BOOST_CHECK_EQUAL(nCompleted, 1000);
+  BOOST_CHECK_EQUAL(pipeline->getMaxInFlight(), 1);
+  BOOST_CHECK_EQUAL(nFinished, 1);
+
+  // an empty pipeline finishes right away
+  auto empty = std::make_shared<FetchPipeline>(2);
+  empty->start([&] { ++nFinished; });
+  BOOST_CHECK_EQUAL(nFinished, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+
+} // namespace chronochat
@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "group-key.hpp"
+#include "group-key-validation-policy.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/security/certificate-fetcher-offline.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/security/transform/private-key.hpp>
+#include <ndn-cxx/security/validation-policy-accept-all.hpp>
+#include <ndn-cxx/security/validator.hpp>
+#include <ndn-cxx/util/string-helper.hpp>
+
+#include <algorithm>
+
+namespace chronochat {
+namespace tests {
+
+static shared_ptr<Data>
+makeChatData(const Name& name, const std::string& text)
+{
+  auto data = std::make_shared<Data>(name);
+  data->setContent(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+  data->setFreshnessPeriod(time::seconds(60));
+  return data;
+}
+
+static std::string
+hmacHex(const GroupKey& key, const std::string& message)
+{
+  return ndn::toHex(*key.computeHmac(reinterpret_cast<const uint8_t*>(message.data()),
+                                     message.size()), false);
+}
+
+BOOST_AUTO_TEST_SUITE(TestGroupKey)
+
+BOOST_AUTO_TEST_CASE(Hmac)
+{
+  // RFC 4231, test cases 2 and 6
+  const std::string secret = "Jefe";
+  GroupKey key("/key", ndn::Buffer(secret.data(), secret.size()));
+  BOOST_CHECK_EQUAL(hmacHex(key, "what do ya want for nothing?"),
+                    "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843");
+
+  // a secret longer than a block
+  ndn::Buffer longSecret(131);
+  std::fill(longSecret.begin(), longSecret.end(), 0xaa);
+  GroupKey longKey("/key", longSecret);
+  BOOST_CHECK_EQUAL(hmacHex(longKey, "Test Using Larger Than Block-Size Key - Hash Key First"),
+                    "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+}
+
+BOOST_AUTO_TEST_CASE(SignVerify)
+{
+  Name chatroomPrefix("/ndn/broadcast/ChronoChat/Chatroom/lunch");
+  shared_ptr<GroupKey> key = GroupKey::generate(chatroomPrefix);
+  BOOST_CHECK(chatroomPrefix.isPrefixOf(key->getName()));
+
+  shared_ptr<Data> data = makeChatData("/ndn/alice/CHRONOCHAT-CHATDATA/lunch/1/5", "hello");
+  key->sign(*data);
+  BOOST_CHECK_EQUAL(data->getSignatureInfo().getSignatureType(),
+                    ndn::tlv::SignatureHmacWithSha256);
+  BOOST_CHECK_EQUAL(data->getSignatureInfo().getKeyLocator().getName(), key->getName());
+  BOOST_CHECK(key->verify(*data));
+
+  // as received from the network
+  Data received(data->wireEncode());
+  BOOST_CHECK(key->verify(received));
+
+  // a byte of the content changed on the way
+  ndn::Buffer wire(data->wireEncode().wire(), data->wireEncode().size());
+  const std::string text = "hello";
+  auto content = std::search(wire.begin(), wire.end(), text.begin(), text.end());
+  BOOST_REQUIRE(content != wire.end());
+  *content = 'j';
+  Data tampered(Block(wire.data(), wire.size()));
+  BOOST_CHECK(!key->verify(tampered));
+
+  // another key of the same room
+  BOOST_CHECK(!GroupKey::generate(chatroomPrefix)->verify(*data));
+
+  // the same secret under another name
+  const ndn::Buffer secret(16);
+  GroupKey first(Name(chatroomPrefix).append("GROUP-KEY").append("1"), secret);
+  GroupKey second(Name(chatroomPrefix).append("GROUP-KEY").append("2"), secret);
+  first.sign(*data);
+  BOOST_CHECK(first.verify(*data));
+  BOOST_CHECK(!second.verify(*data));
+
+  // an asymmetric signature
+  ndn::KeyChain keyChain("pib-memory:", "tpm-memory:");
+  keyChain.sign(*data, ndn::security::signingWithSha256());
+  BOOST_CHECK(!first.verify(*data));
+}
+
+BOOST_AUTO_TEST_CASE(Encode)
+{
+  shared_ptr<GroupKey> key = GroupKey::generate("/ndn/broadcast/ChronoChat/Chatroom/lunch");
+  GroupKey decoded(key->wireEncode());
+  BOOST_CHECK_EQUAL(decoded.getName(), key->getName());
+
+  shared_ptr<Data> data = makeChatData("/ndn/alice/CHRONOCHAT-CHATDATA/lunch/1/5", "hello");
+  key->sign(*data);
+  BOOST_CHECK(decoded.verify(*data));
+
+  BOOST_CHECK_THROW(GroupKey(key->getName().wireEncode()), GroupKey::Error);
+
+  ndn::EncodingBuffer buffer;
+  size_t length = key->getName().wireEncode(buffer);
+  length += buffer.prependVarNumber(length);
+  length += buffer.prependVarNumber(tlv::GroupKey);
+  BOOST_CHECK_THROW(GroupKey(buffer.block()), GroupKey::Error);
+}
+
+BOOST_AUTO_TEST_CASE(EncryptedEncode)
+{
+  namespace transform = ndn::security::transform;
+
+  shared_ptr<GroupKey> key = GroupKey::generate("/ndn/broadcast/ChronoChat/Chatroom/lunch");
+  auto transportKey = transform::generatePrivateKey(ndn::RsaKeyParams());
+  ndn::ConstBufferPtr transportPublicKey = transportKey->derivePublicKey();
+
+  Block encrypted = key->wireEncodeEncrypted(transportPublicKey->data(),
+                                             transportPublicKey->size());
+  BOOST_CHECK_EQUAL(encrypted.type(), tlv::EncryptedGroupKey);
+  // the secret is not in the clear
+  BOOST_CHECK(std::search(encrypted.begin(), encrypted.end(),
+                          key->wireEncode().value_begin(), key->wireEncode().value_end()) ==
+              encrypted.end());
+
+  GroupKey decrypted(encrypted, *transportKey);
+  BOOST_CHECK_EQUAL(decrypted.getName(), key->getName());
+  shared_ptr<Data> data = makeChatData("/ndn/alice/CHRONOCHAT-CHATDATA/lunch/1/5", "hello");
+  key->sign(*data);
+  BOOST_CHECK(decrypted.verify(*data));
+
+  // the key of somebody else
+  auto otherKey = transform::generatePrivateKey(ndn::RsaKeyParams());
+  BOOST_CHECK_THROW(GroupKey(encrypted, *otherKey), GroupKey::Error);
+
+  // a key which cannot encrypt
+  auto ecKey = transform::generatePrivateKey(ndn::EcKeyParams());
+  ndn::ConstBufferPtr ecPublicKey = ecKey->derivePublicKey();
+  BOOST_CHECK_THROW(key->wireEncodeEncrypted(ecPublicKey->data(), ecPublicKey->size()),
+                    GroupKey::Error);
+
+  BOOST_CHECK_THROW(GroupKey(key->wireEncode(), *transportKey), GroupKey::Error);
+}
+
+BOOST_AUTO_TEST_CASE(Validation)
+{
+  shared_ptr<const GroupKey> key;
+  auto policy = std::make_unique<GroupKeyValidationPolicy>([&key] { return key; });
+  policy->setInnerPolicy(std::make_unique<ndn::security::ValidationPolicyAcceptAll>());
+  ndn::security::Validator validator(std::move(policy),
+                                     std::make_unique<ndn::security::CertificateFetcherOffline>());
+
+  auto isValid = [&validator] (const Data& data) {
+    bool isValidated = false;
+    validator.validate(data,
+                       [&] (const Data&) { isValidated = true; },
+                       [] (const Data&, const ndn::security::ValidationError&) {});
+    return isValidated;
+  };
+
+  shared_ptr<GroupKey> roomKey = GroupKey::generate("/ndn/broadcast/ChronoChat/Chatroom/lunch");
+  shared_ptr<Data> data = makeChatData("/ndn/alice/CHRONOCHAT-CHATDATA/lunch/1/5", "hello");
+  roomKey->sign(*data);
+
+  // without the key of the room
+  BOOST_CHECK(!isValid(*data));
+
+  key = roomKey;
+  BOOST_CHECK(isValid(*data));
+
+  key = GroupKey::generate("/ndn/broadcast/ChronoChat/Chatroom/lunch");
+  BOOST_CHECK(!isValid(*data));
+
+  // the other packets go to the inner policy
+  ndn::KeyChain keyChain("pib-memory:", "tpm-memory:");
+  keyChain.sign(*data, ndn::security::signingWithSha256());
+  BOOST_CHECK(isValid(*data));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
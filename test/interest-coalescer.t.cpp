@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "interest-coalescer.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace chronochat {
+
+namespace tests {
+
+using ndn::security::DataValidationSuccessCallback;
+using ndn::security::DataValidationFailureCallback;
+using ndn::security::ValidationError;
+
+class CoalescerFixture
+{
+public:
+  CoalescerFixture()
+    : nSent(0)
+    , nValidated(0)
+    , nFailed(0)
+    , nTimedOut(0)
+  {
+  }
+
+  void
+  request(const Interest& interest)
+  {
+    coalescer.request(interest,
+                      [this] (const Data&) { ++nValidated; },
+                      [this] (const Data&, const ValidationError&) { ++nFailed; },
+                      [this] (const Interest&) { ++nTimedOut; },
+                      [this] (const Interest&,
+                              const DataValidationSuccessCallback& onValidated,
+                              const DataValidationFailureCallback& onValidationFailed,
+                              const InterestCoalescer::TimeoutCallback& onTimeout) {
+                        ++nSent;
+                        validated = onValidated;
+                        failed = onValidationFailed;
+                        timedOut = onTimeout;
+                      });
+  }
+
+public:
+  InterestCoalescer coalescer;
+
+  int nSent;
+  int nValidated;
+  int nFailed;
+  int nTimedOut;
+
+  // the callbacks of the last Interest sent
+  DataValidationSuccessCallback validated;
+  DataValidationFailureCallback failed;
+  InterestCoalescer::TimeoutCallback timedOut;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestInterestCoalescer, CoalescerFixture)
+
+BOOST_AUTO_TEST_CASE(FanOut)
+{
+  Interest interest(Name("/ndn/alice/DNS/PROFILE"));
+  interest.setCanBePrefix(true);
+  interest.setMustBeFresh(true);
+
+  for (int i = 0; i < 5; i++)
+    request(interest);
+  BOOST_CHECK_EQUAL(nSent, 1);
+  BOOST_CHECK_EQUAL(coalescer.size(), 1);
+  BOOST_CHECK_EQUAL(coalescer.getNCoalesced(), 4);
+
+  validated(Data(interest.getName()));
+  BOOST_CHECK_EQUAL(nValidated, 5);
+  BOOST_CHECK_EQUAL(coalescer.size(), 0);
+
+  // the next request is sent again, its failure reaches all the waiters
+  request(interest);
+  request(interest);
+  BOOST_CHECK_EQUAL(nSent, 2);
+  failed(Data(interest.getName()), ValidationError(ValidationError::INVALID_SIGNATURE));
+  BOOST_CHECK_EQUAL(nFailed, 2);
+
+  request(interest);
+  request(interest);
+  BOOST_CHECK_EQUAL(nSent, 3);
+  timedOut(interest);
+  BOOST_CHECK_EQUAL(nTimedOut, 2);
+
+  BOOST_CHECK_EQUAL(nValidated, 5);
+  BOOST_CHECK_EQUAL(coalescer.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Keys)
+{
+  Interest interest(Name("/ndn/alice/DNS/PROFILE"));
+  interest.setCanBePrefix(true);
+  interest.setMustBeFresh(true);
+  request(interest);
+
+  // another name
+  Interest other(Name("/ndn/bob/DNS/PROFILE"));
+  other.setCanBePrefix(true);
+  other.setMustBeFresh(true);
+  request(other);
+
+  // other selectors
+  Interest stale(interest);
+  stale.setMustBeFresh(false);
+  request(stale);
+
+  Interest exact(interest);
+  exact.setCanBePrefix(false);
+  request(exact);
+
+  BOOST_CHECK_EQUAL(nSent, 4);
+  BOOST_CHECK_EQUAL(coalescer.size(), 4);
+  BOOST_CHECK_EQUAL(coalescer.getNCoalesced(), 0);
+
+  // a different nonce or lifetime does not matter
+  Interest again(interest);
+  again.refreshNonce();
+  again.setInterestLifetime(time::milliseconds(10));
+  request(again);
+  BOOST_CHECK_EQUAL(nSent, 4);
+  BOOST_CHECK_EQUAL(coalescer.getNCoalesced(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+
+} // namespace chronochat
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "invitation-replay-cache.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+
+namespace chronochat {
+namespace tests {
+
+class InvitationReplayCacheFixture
+{
+public:
+  InvitationReplayCacheFixture()
+    : steadyClock(std::make_shared<time::UnitTestSteadyClock>())
+    , systemClock(std::make_shared<time::UnitTestSystemClock>(
+        time::duration_cast<time::nanoseconds>(time::system_clock::now().time_since_epoch())))
+    , keyChain("pib-memory:", "tpm-memory:")
+  {
+    time::setCustomClocks(steadyClock, systemClock);
+    alice = keyChain.createIdentity("/ndn/alice").getDefaultKey().getDefaultCertificate();
+    carol = keyChain.createIdentity("/ndn/carol").getDefaultKey().getDefaultCertificate();
+  }
+
+  ~InvitationReplayCacheFixture()
+  {
+    time::setCustomClocks();
+  }
+
+  void
+  advanceClocks(time::nanoseconds duration)
+  {
+    steadyClock->advance(duration);
+    systemClock->advance(duration);
+  }
+
+  /**
+   * @return the name of an invitation of @p inviter as received, with a fake signature
+   */
+  Name
+  makeInvitation(const std::string& chatroom, const ndn::security::Certificate& inviter,
+                 const std::string& signature = "signature")
+  {
+    Invitation invitation("/ndn/bob", chatroom, "/ucla", inviter);
+    return Name(invitation.getUnsignedInterestName()).append("keylocator").append(signature);
+  }
+
+  InvitationReplayCache::Decision
+  check(InvitationReplayCache& cache, const Name& interestName)
+  {
+    return cache.check(interestName, Invitation(interestName));
+  }
+
+  bool
+  setVerdict(InvitationReplayCache& cache, const Name& interestName, bool isValid)
+  {
+    return cache.setVerdict(interestName, Invitation(interestName), isValid);
+  }
+
+public:
+  shared_ptr<time::UnitTestSteadyClock> steadyClock;
+  shared_ptr<time::UnitTestSystemClock> systemClock;
+  ndn::KeyChain keyChain;
+  ndn::security::Certificate alice;
+  ndn::security::Certificate carol;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestInvitationReplayCache, InvitationReplayCacheFixture)
+
+BOOST_AUTO_TEST_CASE(Duplicate)
+{
+  InvitationReplayCache cache;
+  Name lunch = makeInvitation("lunch", alice);
+  Name dinner = makeInvitation("dinner", alice);
+
+  BOOST_CHECK_EQUAL(check(cache, lunch), InvitationReplayCache::PROCESS);
+  // a retransmission while the validation is pending, then after it
+  BOOST_CHECK_EQUAL(check(cache, lunch), InvitationReplayCache::DUPLICATE);
+  BOOST_CHECK(setVerdict(cache, lunch, true));
+  BOOST_CHECK_EQUAL(check(cache, lunch), InvitationReplayCache::DUPLICATE);
+
+  BOOST_CHECK_EQUAL(check(cache, dinner), InvitationReplayCache::PROCESS);
+  BOOST_CHECK(!setVerdict(cache, dinner, false));
+  BOOST_CHECK_EQUAL(check(cache, dinner), InvitationReplayCache::KNOWN_INVALID);
+
+  // an invitation whose validation was not completed may be tried again
+  Name breakfast = makeInvitation("breakfast", alice);
+  BOOST_CHECK_EQUAL(check(cache, breakfast), InvitationReplayCache::PROCESS);
+  cache.erase(breakfast);
+  BOOST_CHECK_EQUAL(check(cache, breakfast), InvitationReplayCache::PROCESS);
+
+  // a pending validation is given up after a while
+  advanceClocks(time::seconds(40));
+  BOOST_CHECK_EQUAL(check(cache, breakfast), InvitationReplayCache::PROCESS);
+
+  // remembered while its timestamp is in the window of acceptance, a replay afterwards
+  advanceClocks(time::minutes(1));
+  BOOST_CHECK_EQUAL(check(cache, lunch), InvitationReplayCache::DUPLICATE);
+  advanceClocks(time::minutes(2));
+  BOOST_CHECK_EQUAL(check(cache, lunch), InvitationReplayCache::REPLAY);
+}
+
+BOOST_AUTO_TEST_CASE(ForgedCopy)
+{
+  InvitationReplayCache cache;
+  Name lunch = makeInvitation("lunch", alice);
+  Name forged = Name(lunch.getPrefix(-1)).append("forged");
+
+  // the forged copy arrives first and fails, the invitation is validated all the same
+  BOOST_CHECK_EQUAL(check(cache, forged), InvitationReplayCache::PROCESS);
+  BOOST_CHECK(!setVerdict(cache, forged, false));
+  BOOST_CHECK_EQUAL(check(cache, lunch), InvitationReplayCache::PROCESS);
+  BOOST_CHECK(setVerdict(cache, lunch, true));
+
+  BOOST_CHECK_EQUAL(check(cache, forged), InvitationReplayCache::KNOWN_INVALID);
+  BOOST_CHECK_EQUAL(check(cache, lunch), InvitationReplayCache::DUPLICATE);
+}
+
+BOOST_AUTO_TEST_CASE(ValidationRate)
+{
+  InvitationReplayCache cache;
+  // invitations claiming to come from alice, which fail the validation
+  for (int i = 0; i < 64; i++) {
+    Name forged = makeInvitation("room" + std::to_string(i), alice, "forged");
+    BOOST_CHECK_EQUAL(check(cache, forged), InvitationReplayCache::PROCESS);
+    setVerdict(cache, forged, false);
+  }
+
+  // the validations are limited whoever the inviter claims to be
+  BOOST_CHECK_EQUAL(check(cache, makeInvitation("room64", alice)),
+                    InvitationReplayCache::RATE_LIMITED);
+  BOOST_CHECK_EQUAL(check(cache, makeInvitation("room64", carol)),
+                    InvitationReplayCache::RATE_LIMITED);
+
+  // the forged invitations did not use up the invitations of alice
+  advanceClocks(time::milliseconds(100));
+  Name lunch = makeInvitation("lunch", alice);
+  BOOST_CHECK_EQUAL(check(cache, lunch), InvitationReplayCache::PROCESS);
+  BOOST_CHECK(setVerdict(cache, lunch, true));
+  BOOST_CHECK_EQUAL(check(cache, makeInvitation("dinner", alice)),
+                    InvitationReplayCache::RATE_LIMITED);
+}
+
+BOOST_AUTO_TEST_CASE(InviterRate)
+{
+  InvitationReplayCache cache;
+  for (int i = 0; i < 10; i++) {
+    BOOST_CHECK(setVerdict(cache, makeInvitation("room" + std::to_string(i), alice), true));
+    advanceClocks(time::milliseconds(1));
+  }
+  BOOST_CHECK(!setVerdict(cache, makeInvitation("room10", alice), true));
+
+  // another inviter is not limited
+  BOOST_CHECK(setVerdict(cache, makeInvitation("room10", carol), true));
+
+  advanceClocks(time::seconds(3));
+  BOOST_CHECK(setVerdict(cache, makeInvitation("room11", alice), true));
+  BOOST_CHECK(!setVerdict(cache, makeInvitation("room12", alice), true));
+}
+
+BOOST_AUTO_TEST_CASE(InviterEviction)
+{
+  InvitationReplayCache cache;
+  for (int i = 0; i < 10; i++)
+    setVerdict(cache, makeInvitation("room" + std::to_string(i), alice), true);
+  BOOST_CHECK(!setVerdict(cache, makeInvitation("room10", alice), true));
+  advanceClocks(time::milliseconds(1));
+
+  // as many other inviters as are remembered
+  auto makeInviter = [this] (int i) {
+    ndn::security::Certificate inviter(carol);
+    inviter.setName(Name("/ndn/user" + std::to_string(i)).append(carol.getName().getSubName(2)));
+    return inviter;
+  };
+  for (int i = 0; i < 255; i++)
+    BOOST_CHECK(setVerdict(cache, makeInvitation("lunch", makeInviter(i)), true));
+
+  // a new inviter is not locked out, alice is the one seen least recently and is forgotten
+  BOOST_CHECK(setVerdict(cache, makeInvitation("lunch", makeInviter(255)), true));
+  BOOST_CHECK(setVerdict(cache, makeInvitation("room11", alice), true));
+}
+
+BOOST_AUTO_TEST_CASE(Capacity)
+{
+  InvitationReplayCache cache(4);
+  std::vector<Name> invitations;
+  for (int i = 0; i < 6; i++) {
+    invitations.push_back(makeInvitation("room" + std::to_string(i), i % 2 ? alice : carol));
+    BOOST_CHECK_EQUAL(check(cache, invitations.back()), InvitationReplayCache::PROCESS);
+  }
+  BOOST_CHECK_EQUAL(cache.size(), 4);
+
+  // the oldest invitations are forgotten first
+  BOOST_CHECK_EQUAL(check(cache, invitations[5]), InvitationReplayCache::DUPLICATE);
+  BOOST_CHECK_EQUAL(check(cache, invitations[0]), InvitationReplayCache::PROCESS);
+  BOOST_CHECK_EQUAL(cache.size(), 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
@@ -0,0 +1,219 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "invitation-sender.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/util/dummy-client-face.hpp>
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+
+namespace chronochat {
+namespace tests {
+
+static const Name ROUTING_PREFIX("/ndn/broadcast");
+static const Name::Component ROUTING_HINT_SEPARATOR = Name::Component::fromEscapedString("%F0%2E");
+
+class InvitationSenderFixture
+{
+public:
+  InvitationSenderFixture()
+    : steadyClock(std::make_shared<time::UnitTestSteadyClock>())
+    , keyChain("pib-memory:", "tpm-memory:")
+    , face(io, keyChain, {true, true})
+  {
+    time::setCustomClocks(steadyClock);
+    for (const std::string& identity : {"/ndn/bob", "/ndn/carol", "/ndn/dave", "/ndn/mallory"})
+      invitees[identity] =
+        keyChain.createIdentity(identity).getDefaultKey().getDefaultCertificate();
+    certificate = keyChain.createIdentity("/ndn/alice").getDefaultKey().getDefaultCertificate();
+  }
+
+  ~InvitationSenderFixture()
+  {
+    time::setCustomClocks();
+  }
+
+  void
+  advanceClocks(time::milliseconds tick, size_t nTicks = 1)
+  {
+    for (size_t i = 0; i < nTicks; i++) {
+      steadyClock->advance(tick);
+      io.poll();
+      io.reset();
+    }
+  }
+
+  /**
+   * @brief answer the invitation Interest @p interest as @p invitee, the way ControllerBackend
+   *        does
+   */
+  void
+  respond(const Interest& interest, bool accepted, const Name& invitee)
+  {
+    // strip the routing prefix and the separator
+    Name invitationName = interest.getName().getSubName(ROUTING_PREFIX.size() + 1);
+
+    Data response(invitationName);
+    response.setFreshnessPeriod(time::milliseconds(1000));
+    if (accepted) {
+      response.setName(Name(invitationName).append(Name("/ucla").wireEncode()));
+      response.setContent(invitees[invitee].wireEncode());
+    }
+    keyChain.sign(response, ndn::security::signingByCertificate(invitees[invitee]));
+
+    Data wrapped(Name(ROUTING_PREFIX).append(ROUTING_HINT_SEPARATOR)
+                 .append(response.getName()));
+    wrapped.setContent(response.wireEncode());
+    wrapped.setFreshnessPeriod(time::milliseconds(1000));
+    keyChain.sign(wrapped, ndn::security::signingWithSha256());
+    face.receive(wrapped);
+  }
+
+  const Interest*
+  findSent(const Name& invitee)
+  {
+    for (const Interest& interest : face.sentInterests)
+      if (interest.getName().getSubName(ROUTING_PREFIX.size() + 1, invitee.size()) == invitee)
+        return &interest;
+    return nullptr;
+  }
+
+  std::vector<ndn::Buffer>
+  getKeys(const std::vector<Invitation>& invitations)
+  {
+    std::vector<ndn::Buffer> keys;
+    for (const Invitation& invitation : invitations)
+      keys.push_back(invitees[invitation.getInviteeNameSpace()].getPublicKey());
+    return keys;
+  }
+
+public:
+  shared_ptr<time::UnitTestSteadyClock> steadyClock;
+  boost::asio::io_service io;
+  ndn::KeyChain keyChain;
+  ndn::util::DummyClientFace face;
+  ndn::security::Certificate certificate;
+  std::map<Name, ndn::security::Certificate> invitees;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestInvitationSender, InvitationSenderFixture)
+
+BOOST_AUTO_TEST_CASE(Batch)
+{
+  InvitationSender sender(face, keyChain, ROUTING_PREFIX, 2);
+  sender.setRetry(1, time::milliseconds(500));
+  sender.setInterestLifetime(time::milliseconds(1000));
+
+  std::vector<Invitation> invitations;
+  for (const std::string& invitee : {"/ndn/bob", "/ndn/carol", "/ndn/dave"})
+    invitations.push_back(Invitation(invitee, "lunch", "/ucla", certificate));
+
+  std::map<Name, InvitationSender::Outcome> outcomes;
+  InvitationSender::Progress progress;
+  size_t nProgress = 0;
+  sender.send(invitations, getKeys(invitations),
+              ndn::security::signingByCertificate(certificate),
+              [&] (const Invitation& invitation, InvitationSender::Outcome outcome) {
+                outcomes[invitation.getInviteeNameSpace()] = outcome;
+              },
+              [&] (const InvitationSender::Progress& p) {
+                progress = p;
+                nProgress++;
+              });
+  advanceClocks(time::milliseconds(1));
+
+  // a window of two
+  BOOST_CHECK_EQUAL(progress.nInvitations, 3);
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 2);
+  const Interest* bob = findSent("/ndn/bob");
+  const Interest* carol = findSent("/ndn/carol");
+  BOOST_REQUIRE(bob != nullptr && carol != nullptr);
+  BOOST_CHECK(bob->getCanBePrefix());
+
+  // the invitation is signed and parsable by the invitee
+  Invitation received(bob->getName().getSubName(ROUTING_PREFIX.size() + 1));
+  BOOST_CHECK_EQUAL(received.getChatroom(), "lunch");
+  BOOST_CHECK_EQUAL(received.getInviterCertificateName(), certificate.getFullName());
+
+  Interest bobInterest = *bob;
+  Interest carolInterest = *carol;
+  respond(bobInterest, true, "/ndn/bob");
+  respond(carolInterest, false, "/ndn/carol");
+  advanceClocks(time::milliseconds(1));
+
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 3);
+  BOOST_CHECK(findSent("/ndn/dave") != nullptr);
+  BOOST_CHECK_EQUAL(progress.nAccepted, 1);
+  BOOST_CHECK_EQUAL(progress.nRejected, 1);
+  BOOST_CHECK(outcomes[Name("/ndn/bob")] == InvitationSender::ACCEPTED);
+  BOOST_CHECK(outcomes[Name("/ndn/carol")] == InvitationSender::REJECTED);
+
+  // dave does not answer: one retry after the backoff, with the same signed Interest
+  Name daveName = face.sentInterests.back().getName();
+  advanceClocks(time::milliseconds(100), 16);
+  BOOST_CHECK_EQUAL(progress.nRetries, 1);
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 4);
+  BOOST_CHECK_EQUAL(face.sentInterests.back().getName(), daveName);
+
+  advanceClocks(time::milliseconds(100), 11);
+  BOOST_CHECK_EQUAL(face.sentInterests.size(), 4);
+  BOOST_CHECK_EQUAL(progress.nFailed, 1);
+  BOOST_CHECK_EQUAL(progress.getNDone(), 3);
+  BOOST_CHECK(outcomes[Name("/ndn/dave")] == InvitationSender::FAILED);
+  BOOST_CHECK_EQUAL(outcomes.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(ForgedResponse)
+{
+  InvitationSender sender(face, keyChain, ROUTING_PREFIX);
+  sender.setRetry(1, time::milliseconds(500));
+  sender.setInterestLifetime(time::milliseconds(1000));
+
+  std::vector<Invitation> invitations{Invitation("/ndn/bob", "lunch", "/ucla", certificate)};
+  std::vector<InvitationSender::Outcome> outcomes;
+  InvitationSender::Progress progress;
+  sender.send(invitations, getKeys(invitations),
+              ndn::security::signingByCertificate(certificate),
+              [&] (const Invitation&, InvitationSender::Outcome outcome) {
+                outcomes.push_back(outcome);
+              },
+              [&] (const InvitationSender::Progress& p) { progress = p; });
+  advanceClocks(time::milliseconds(1));
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 1);
+
+  // mallory accepts in the name of bob: taken as no answer, the invitation is sent again
+  Interest interest = face.sentInterests.back();
+  respond(interest, true, "/ndn/mallory");
+  advanceClocks(time::milliseconds(1));
+  BOOST_CHECK(outcomes.empty());
+  BOOST_CHECK_EQUAL(progress.nAccepted, 0);
+  BOOST_CHECK_EQUAL(progress.nRetries, 1);
+
+  advanceClocks(time::milliseconds(100), 6);
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 2);
+
+  // a response signed by bob but named after another invitation does not count either
+  Data response(Name("/ndn/bob/CHRONOCHAT-INVITATION/dinner").append(Name("/ucla").wireEncode()));
+  response.setContent(invitees["/ndn/bob"].wireEncode());
+  keyChain.sign(response, ndn::security::signingByCertificate(invitees["/ndn/bob"]));
+  Data wrapped(Name(face.sentInterests.back().getName()).append(Name("/ucla").wireEncode()));
+  wrapped.setContent(response.wireEncode());
+  keyChain.sign(wrapped, ndn::security::signingWithSha256());
+  face.receive(wrapped);
+  advanceClocks(time::milliseconds(1));
+
+  BOOST_REQUIRE_EQUAL(outcomes.size(), 1);
+  BOOST_CHECK(outcomes.front() == InvitationSender::FAILED);
+  BOOST_CHECK_EQUAL(progress.nAccepted, 0);
+  BOOST_CHECK_EQUAL(progress.nFailed, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
@@ -0,0 +1,94 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "invitation.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+
+namespace chronochat {
+namespace tests {
+
+class InvitationFixture
+{
+public:
+  InvitationFixture()
+    : keyChain("pib-memory:", "tpm-memory:")
+  {
+    certificate = keyChain.createIdentity("/ndn/alice").getDefaultKey().getDefaultCertificate();
+  }
+
+  Name
+  sign(const Invitation& invitation)
+  {
+    Interest interest(invitation.getUnsignedInterestName());
+    keyChain.sign(interest, ndn::security::signingByCertificate(certificate));
+    return interest.getName();
+  }
+
+public:
+  ndn::KeyChain keyChain;
+  ndn::security::Certificate certificate;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestInvitation, InvitationFixture)
+
+BOOST_AUTO_TEST_CASE(Legacy)
+{
+  Invitation sent("/ndn/bob", "lunch", "/ndn/ucla", certificate, false);
+  Invitation invitation(sign(sent));
+
+  BOOST_CHECK(!invitation.isCompact());
+  BOOST_CHECK(invitation.hasInviterCertificate());
+  BOOST_CHECK_EQUAL(invitation.getInviteeNameSpace(), Name("/ndn/bob"));
+  BOOST_CHECK_EQUAL(invitation.getChatroom(), "lunch");
+  BOOST_CHECK_EQUAL(invitation.getInviterRoutingPrefix(), Name("/ndn/ucla"));
+  BOOST_CHECK_EQUAL(invitation.getInviterCertificate().getName(), certificate.getName());
+  BOOST_CHECK_EQUAL(invitation.getInviterCertificateName(), certificate.getFullName());
+  BOOST_CHECK_EQUAL(invitation.getTimestamp(), sent.getTimestamp());
+  BOOST_CHECK_EQUAL(invitation.getUnsignedInterestName(), sent.getUnsignedInterestName());
+}
+
+BOOST_AUTO_TEST_CASE(Compact)
+{
+  Invitation sent("/ndn/bob", "lunch", "/ndn/ucla", certificate);
+  Invitation legacy("/ndn/bob", "lunch", "/ndn/ucla", certificate, false);
+  BOOST_CHECK_LT(sent.getUnsignedInterestName().wireEncode().size(),
+                 legacy.getUnsignedInterestName().wireEncode().size());
+
+  Invitation invitation(sign(sent));
+  BOOST_CHECK(invitation.isCompact());
+  BOOST_CHECK(!invitation.hasInviterCertificate());
+  BOOST_CHECK_EQUAL(invitation.getInviteeNameSpace(), Name("/ndn/bob"));
+  BOOST_CHECK_EQUAL(invitation.getChatroom(), "lunch");
+  BOOST_CHECK_EQUAL(invitation.getInviterRoutingPrefix(), Name("/ndn/ucla"));
+  BOOST_CHECK_EQUAL(invitation.getInviterCertificateName(), certificate.getFullName());
+  BOOST_CHECK_EQUAL(invitation.getUnsignedInterestName(), sent.getUnsignedInterestName());
+
+  // only the certificate the invitation refers to is accepted
+  ndn::security::Certificate other =
+    keyChain.createIdentity("/ndn/carol").getDefaultKey().getDefaultCertificate();
+  BOOST_CHECK_THROW(invitation.setInviterCertificate(other), Invitation::Error);
+  BOOST_CHECK(!invitation.hasInviterCertificate());
+
+  invitation.setInviterCertificate(certificate);
+  BOOST_CHECK(invitation.hasInviterCertificate());
+  BOOST_CHECK_EQUAL(invitation.getInviterCertificate().getName(), certificate.getName());
+}
+
+BOOST_AUTO_TEST_CASE(Malformed)
+{
+  BOOST_CHECK_THROW(Invitation("/ndn/bob/CHRONOCHAT-INVITATION/lunch"), Invitation::Error);
+  BOOST_CHECK_THROW(Invitation("/ndn/bob/CHRONOCHAT-INVITATION/lunch/a/b/c/d/e"),
+                    Invitation::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
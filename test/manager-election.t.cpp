@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "manager-election.hpp"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <random>
+#include <set>
+
+namespace chronochat {
+
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestManagerElection)
+
+static std::list<Name>
+makeParticipants(size_t nParticipants)
+{
+  std::list<Name> participants;
+  for (size_t i = 0; i < nParticipants; ++i)
+    participants.push_back(Name("/ndn/ucla/user-" + std::to_string(i)));
+  return participants;
+}
+
+BOOST_AUTO_TEST_CASE(Rank)
+{
+  Name::Component chatroom("ndnd");
+  std::list<Name> participants = makeParticipants(20);
+
+  ManagerElection election(chatroom, participants);
+  BOOST_REQUIRE_EQUAL(election.getOrder().size(), 20);
+
+  // every participant computes the same order whatever the order of its roster
+  std::list<Name> reversed(participants.rbegin(), participants.rend());
+  reversed.push_back(participants.front());
+  ManagerElection other(chatroom, reversed);
+  BOOST_CHECK(election.getOrder() == other.getOrder());
+
+  // ranks are distinct and ordered by priority
+  for (size_t i = 0; i < election.getOrder().size(); ++i) {
+    const Name& participant = election.getOrder()[i];
+    BOOST_CHECK_EQUAL(election.getRank(participant), i);
+    BOOST_CHECK(election.getBackoff(participant) ==
+                ManagerElection::SLOT * static_cast<int64_t>(i));
+    if (i > 0)
+      BOOST_CHECK_LE(ManagerElection::getPriority(chatroom, election.getOrder()[i - 1]),
+                     ManagerElection::getPriority(chatroom, participant));
+  }
+
+  BOOST_CHECK_EQUAL(election.getRank(Name("/ndn/ucla/stranger")), 20);
+
+  // different chatrooms are likely to elect different managers
+  std::set<Name> managers;
+  for (int i = 0; i < 10; ++i)
+    managers.insert(ManagerElection(Name::Component("room-" + std::to_string(i)),
+                                    participants).getOrder().front());
+  BOOST_CHECK_GT(managers.size(), 1);
+}
+
+class ElectionSimulation
+{
+public:
+  class Result
+  {
+  public:
+    size_t nPublishers = 0;
+    time::milliseconds convergence = time::milliseconds::zero();
+  };
+
+  /**
+   * @brief simulate the takeover after the manager is lost
+   *
+   * Participant i detects the loss of the manager at a random skew and fires its timer
+   * takeoverDelays[i] later, unless a publication from a new manager reached it before.
+   * Each publication reaches each participant after a random propagation delay.
+   * A negative delay denotes a participant that is gone too.
+   */
+  Result
+  run(const std::vector<time::milliseconds>& takeoverDelays)
+  {
+    static const time::milliseconds NEVER = time::milliseconds::max();
+    size_t nParticipants = takeoverDelays.size();
+
+    std::vector<time::milliseconds> fireTimes(nParticipants, NEVER);
+    for (size_t i = 0; i < nParticipants; ++i) {
+      if (takeoverDelays[i] >= time::milliseconds::zero())
+        fireTimes[i] = time::milliseconds(m_skew(m_generator)) + takeoverDelays[i];
+    }
+
+    std::vector<size_t> order(nParticipants);
+    for (size_t i = 0; i < nParticipants; ++i)
+      order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&] (size_t a, size_t b) { return fireTimes[a] < fireTimes[b]; });
+
+    Result result;
+    std::vector<time::milliseconds> informedTimes(nParticipants, NEVER);
+    for (size_t i : order) {
+      if (fireTimes[i] == NEVER || informedTimes[i] <= fireTimes[i])
+        continue;
+
+      ++result.nPublishers;
+      informedTimes[i] = fireTimes[i];
+      for (size_t j = 0; j < nParticipants; ++j) {
+        time::milliseconds arrival = fireTimes[i] + time::milliseconds(m_delay(m_generator));
+        informedTimes[j] = std::min(informedTimes[j], arrival);
+      }
+    }
+
+    for (size_t i = 0; i < nParticipants; ++i) {
+      if (fireTimes[i] != NEVER)
+        result.convergence = std::max(result.convergence, informedTimes[i]);
+    }
+    return result;
+  }
+
+private:
+  std::mt19937 m_generator{42};
+  // participants detect the loss of the manager up to 200 ms apart
+  std::uniform_int_distribution<int> m_skew{0, 200};
+  std::uniform_int_distribution<int> m_delay{10, 100};
+};
+
+BOOST_AUTO_TEST_CASE(Simulation)
+{
+  Name::Component chatroom("ndnd");
+
+  for (size_t nParticipants : {10, 100, 1000}) {
+    std::list<Name> participants = makeParticipants(nParticipants);
+    ManagerElection election(chatroom, participants);
+
+    ElectionSimulation simulation;
+
+    // the random 500-2000 ms timers used before
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> random(500, 2000);
+    std::vector<time::milliseconds> randomDelays;
+    for (size_t i = 0; i < nParticipants; ++i)
+      randomDelays.push_back(time::milliseconds(random(generator)));
+    ElectionSimulation::Result randomResult = simulation.run(randomDelays);
+
+    std::vector<time::milliseconds> rankedDelays;
+    for (const auto& participant : participants)
+      rankedDelays.push_back(election.getBackoff(participant));
+    ElectionSimulation::Result rankedResult = simulation.run(rankedDelays);
+
+    // the first ranked participant is gone as well, the second one takes over
+    std::vector<time::milliseconds> failoverDelays = rankedDelays;
+    for (size_t i = 0; i < nParticipants; ++i) {
+      if (failoverDelays[i] == time::milliseconds::zero())
+        failoverDelays[i] = time::milliseconds(-1);
+    }
+    ElectionSimulation::Result failoverResult = simulation.run(failoverDelays);
+
+    BOOST_TEST_MESSAGE(nParticipants << " participants: random "
+                       << randomResult.nPublishers - 1 << " duplicates, "
+                       << randomResult.convergence.count() << " ms; ranked "
+                       << rankedResult.nPublishers - 1 << " duplicates, "
+                       << rankedResult.convergence.count() << " ms; failover "
+                       << failoverResult.nPublishers - 1 << " duplicates, "
+                       << failoverResult.convergence.count() << " ms");
+
+    BOOST_CHECK_EQUAL(rankedResult.nPublishers, 1);
+    BOOST_CHECK_EQUAL(failoverResult.nPublishers, 1);
+    BOOST_CHECK_LE(rankedResult.nPublishers, randomResult.nPublishers);
+    BOOST_CHECK(rankedResult.convergence < randomResult.convergence);
+    // one round: the skew plus one propagation delay, after the backoff of the winner
+    BOOST_CHECK(rankedResult.convergence <= time::milliseconds(300));
+    BOOST_CHECK(failoverResult.convergence <= ManagerElection::SLOT + time::milliseconds(300));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+
+} // namespace chronochat
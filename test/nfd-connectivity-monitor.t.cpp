@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "nfd-connectivity-monitor.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+
+#include <cstdlib>
+#include <thread>
+
+namespace chronochat {
+namespace tests {
+
+namespace fs = boost::filesystem;
+using boost::asio::local::stream_protocol;
+
+/**
+ * @brief a forwarder which only accepts connections on its Unix socket, and closes them all
+ *        when it stops
+ */
+class FakeForwarder
+{
+public:
+  FakeForwarder(boost::asio::io_service& io, const std::string& socketPath)
+    : m_io(io)
+    , m_socketPath(socketPath)
+  {
+  }
+
+  ~FakeForwarder()
+  {
+    stop();
+  }
+
+  void
+  start()
+  {
+    fs::remove(m_socketPath);
+    stream_protocol::endpoint endpoint(m_socketPath);
+    m_acceptor = std::make_unique<stream_protocol::acceptor>(m_io, endpoint);
+    accept();
+  }
+
+  void
+  stop()
+  {
+    if (m_acceptor != nullptr) {
+      m_acceptor->close();
+      m_acceptor.reset();
+    }
+    for (auto& client : m_clients)
+      client->close();
+    m_clients.clear();
+    fs::remove(m_socketPath);
+  }
+
+  size_t
+  getNClients() const
+  {
+    return m_clients.size();
+  }
+
+private:
+  void
+  accept()
+  {
+    auto client = std::make_shared<stream_protocol::socket>(m_io);
+    m_acceptor->async_accept(*client, [this, client] (const boost::system::error_code& error) {
+      if (error)
+        return;
+      m_clients.push_back(client);
+      accept();
+    });
+  }
+
+private:
+  boost::asio::io_service& m_io;
+  std::string m_socketPath;
+  unique_ptr<stream_protocol::acceptor> m_acceptor;
+  std::vector<shared_ptr<stream_protocol::socket>> m_clients;
+};
+
+class NfdConnectivityMonitorFixture
+{
+public:
+  NfdConnectivityMonitorFixture()
+    : steadyClock(std::make_shared<time::UnitTestSteadyClock>())
+    , socketPath((fs::temp_directory_path() / fs::unique_path("chronochat-%%%%%%%%.sock"))
+                 .string())
+    , forwarder(io, socketPath)
+    , monitor(io, "unix://" + socketPath)
+  {
+    time::setCustomClocks(steadyClock);
+    monitor.setBackoff(time::milliseconds(10), time::milliseconds(80));
+    monitor.onConnectivityChanged.connect([this] (bool isConnected) {
+      transitions.push_back(isConnected);
+    });
+  }
+
+  ~NfdConnectivityMonitorFixture()
+  {
+    time::setCustomClocks();
+  }
+
+  /**
+   * @brief advance the clock of the retries, polling the sockets after each tick
+   *
+   * A zero @p tick only polls the sockets, which is enough for them to see a connection
+   * accepted or closed on the same host.
+   */
+  void
+  advanceClocks(time::milliseconds tick, size_t nTicks = 1)
+  {
+    for (size_t i = 0; i < nTicks; i++) {
+      steadyClock->advance(tick);
+      io.poll();
+      io.reset();
+    }
+  }
+
+  /**
+   * @brief poll the sockets without advancing the clock until @p condition holds, for at most
+   *        a second
+   *
+   * The TCP resolver completes on a thread of its own, in real time.
+   */
+  void
+  pollUntil(const std::function<bool()>& condition)
+  {
+    for (int i = 0; i < 200 && !condition(); i++) {
+      advanceClocks(time::milliseconds(0));
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  }
+
+public:
+  shared_ptr<time::UnitTestSteadyClock> steadyClock;
+  boost::asio::io_service io;
+  std::string socketPath;
+  FakeForwarder forwarder;
+  NfdConnectivityMonitor monitor;
+  std::vector<bool> transitions;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestNfdConnectivityMonitor, NfdConnectivityMonitorFixture)
+
+BOOST_AUTO_TEST_CASE(StartStop)
+{
+  forwarder.start();
+  monitor.start();
+  advanceClocks(time::milliseconds(0), 5);
+  BOOST_CHECK(monitor.isConnected());
+  BOOST_CHECK_EQUAL(forwarder.getNClients(), 1);
+  BOOST_REQUIRE_EQUAL(transitions.size(), 1);
+  BOOST_CHECK(transitions[0]);
+
+  // the closed connection is noticed right away, before any retry is due
+  forwarder.stop();
+  advanceClocks(time::milliseconds(0), 5);
+  BOOST_CHECK(!monitor.isConnected());
+  BOOST_REQUIRE_EQUAL(transitions.size(), 2);
+  BOOST_CHECK(!transitions[1]);
+
+  // the attempts slow down to one every 40 to 80 ms, after the first quick ones
+  size_t nAttempts = monitor.getNAttempts();
+  advanceClocks(time::milliseconds(1), 1000);
+  BOOST_CHECK_GE(monitor.getNAttempts() - nAttempts, 1000 / 80 - 1);
+  BOOST_CHECK_LE(monitor.getNAttempts() - nAttempts, 1000 / 40 + 4);
+  BOOST_CHECK_EQUAL(transitions.size(), 2);
+
+  // the forwarder is back within the maximum backoff
+  forwarder.start();
+  advanceClocks(time::milliseconds(1), 80);
+  BOOST_CHECK(monitor.isConnected());
+  BOOST_REQUIRE_EQUAL(transitions.size(), 3);
+  BOOST_CHECK(transitions[2]);
+
+  // the backoff starts over after a connection, the first retry connects again
+  forwarder.stop();
+  advanceClocks(time::milliseconds(0), 5);
+  nAttempts = monitor.getNAttempts();
+  forwarder.start();
+  advanceClocks(time::milliseconds(1), 10);
+  BOOST_CHECK(monitor.isConnected());
+  BOOST_CHECK_EQUAL(monitor.getNAttempts() - nAttempts, 1);
+  BOOST_CHECK_EQUAL(transitions.size(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(NoForwarder)
+{
+  monitor.start();
+  advanceClocks(time::milliseconds(1), 200);
+  BOOST_CHECK(!monitor.isConnected());
+  BOOST_CHECK(transitions.empty());
+  BOOST_CHECK_GT(monitor.getNAttempts(), 1);
+
+  forwarder.start();
+  advanceClocks(time::milliseconds(1), 80);
+  BOOST_CHECK(monitor.isConnected());
+  BOOST_CHECK_EQUAL(transitions.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Recheck)
+{
+  forwarder.start();
+  monitor.start();
+  advanceClocks(time::milliseconds(0), 5);
+  BOOST_REQUIRE(monitor.isConnected());
+
+  // a face failed while the forwarder is still there
+  monitor.recheck();
+  advanceClocks(time::milliseconds(0), 5);
+  BOOST_CHECK(monitor.isConnected());
+  BOOST_REQUIRE_EQUAL(transitions.size(), 3);
+  BOOST_CHECK(transitions[1] == false && transitions[2] == true);
+
+  monitor.stop();
+  forwarder.stop();
+  advanceClocks(time::milliseconds(1), 100);
+  BOOST_CHECK_EQUAL(transitions.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(Tcp)
+{
+  using boost::asio::ip::tcp;
+  tcp::acceptor acceptor(io, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+  tcp::socket client(io);
+  acceptor.async_accept(client, [] (const boost::system::error_code&) {});
+
+  NfdConnectivityMonitor tcpMonitor(io, "tcp4://127.0.0.1:" +
+                                        std::to_string(acceptor.local_endpoint().port()));
+  tcpMonitor.start();
+  pollUntil([&] { return tcpMonitor.isConnected(); });
+  BOOST_CHECK(tcpMonitor.isConnected());
+  BOOST_CHECK(client.is_open());
+
+  client.close();
+  acceptor.close();
+  pollUntil([&] { return !tcpMonitor.isConnected(); });
+  BOOST_CHECK(!tcpMonitor.isConnected());
+}
+
+BOOST_AUTO_TEST_CASE(DefaultTransport)
+{
+  const char* transportEnviron = std::getenv("NDN_CLIENT_TRANSPORT");
+  std::string oldTransport = transportEnviron != nullptr ? transportEnviron : "";
+
+  // the environment comes before the client configuration, like for a face
+  setenv("NDN_CLIENT_TRANSPORT", "tcp://127.0.0.1:6363", 1);
+  BOOST_CHECK_EQUAL(NfdConnectivityMonitor::getDefaultTransportUri(), "tcp://127.0.0.1:6363");
+
+  if (transportEnviron != nullptr)
+    setenv("NDN_CLIENT_TRANSPORT", oldTransport.c_str(), 1);
+  else
+    unsetenv("NDN_CLIENT_TRANSPORT");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "rtt-table.hpp"
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace chronochat {
+
+namespace tests {
+
+class RttTableFixture
+{
+public:
+  RttTableFixture()
+    : steadyClock(std::make_shared<ndn::time::UnitTestSteadyClock>())
+  {
+    time::setCustomClocks(steadyClock);
+  }
+
+  ~RttTableFixture()
+  {
+    time::setCustomClocks();
+  }
+
+public:
+  shared_ptr<ndn::time::UnitTestSteadyClock> steadyClock;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestRttTable, RttTableFixture)
+
+BOOST_AUTO_TEST_CASE(Estimator)
+{
+  RttTable table;
+  Name alice("/ndn/alice");
+
+  // no measurement yet
+  BOOST_CHECK(table.getTimeout(alice) == time::milliseconds(1000));
+
+  // first sample: srtt = 100ms, rttvar = 50ms, rto = 100 + 4 * 50
+  table.addMeasurement(alice, time::milliseconds(100));
+  BOOST_CHECK_EQUAL(table.getTimeout(alice).count(), 300);
+
+  // srtt = 7/8 * 100 + 1/8 * 180 = 110, rttvar = 3/4 * 50 + 1/4 * 80 = 57.5
+  table.addMeasurement(alice, time::milliseconds(180));
+  BOOST_CHECK_EQUAL(table.getTimeout(alice).count(), 340);
+
+  // the timeout never goes below the minimum
+  Name bob("/ndn/bob");
+  for (int i = 0; i < 20; i++)
+    table.addMeasurement(bob, time::milliseconds(1));
+  BOOST_CHECK_EQUAL(table.getTimeout(bob).count(), 200);
+
+  BOOST_CHECK_EQUAL(table.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(Backoff)
+{
+  RttTable table;
+  Name alice("/ndn/alice");
+
+  table.addMeasurement(alice, time::milliseconds(100));
+  BOOST_CHECK_EQUAL(table.getTimeout(alice, 1).count(), 600);
+  BOOST_CHECK_EQUAL(table.getTimeout(alice, 2).count(), 1200);
+
+  // the backoff is capped
+  BOOST_CHECK_EQUAL(table.getTimeout(alice, 10).count(), 8000);
+  BOOST_CHECK_EQUAL(table.getTimeout(alice, 1000).count(), 8000);
+}
+
+BOOST_AUTO_TEST_CASE(DeadDestination)
+{
+  RttTable::Options options;
+  options.nFailuresToDead = 2;
+  options.deadPeriod = time::milliseconds(10000);
+  RttTable table(options);
+  Name alice("/ndn/alice");
+
+  BOOST_CHECK(!table.isDead(alice));
+
+  // a success resets the count of failures
+  table.addFailure(alice);
+  table.addSuccess(alice);
+  table.addFailure(alice);
+  BOOST_CHECK(!table.isDead(alice));
+
+  table.addFailure(alice);
+  BOOST_CHECK(table.isDead(alice));
+  BOOST_CHECK(!table.isDead(Name("/ndn/bob")));
+
+  steadyClock->advance(time::milliseconds(9000));
+  BOOST_CHECK(table.isDead(alice));
+
+  // the destination is tried again after the dead period
+  steadyClock->advance(time::milliseconds(2000));
+  BOOST_CHECK(!table.isDead(alice));
+
+  // and comes back to life with its first answer
+  table.addSuccess(alice);
+  table.addFailure(alice);
+  BOOST_CHECK(!table.isDead(alice));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+
+} // namespace chronochat
@@ -0,0 +1,48 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "startup-timer.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+#include <sstream>
+
+namespace chronochat {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestStartupTimer)
+
+BOOST_AUTO_TEST_CASE(Phases)
+{
+  auto clock = std::make_shared<time::UnitTestSteadyClock>();
+  time::setCustomClocks(clock);
+
+  StartupTimer timer;
+  clock->advance(time::milliseconds(12));
+  timer.mark("dialogs");
+  clock->advance(time::milliseconds(30));
+  timer.mark("tray");
+  clock->advance(time::milliseconds(5));
+
+  BOOST_REQUIRE_EQUAL(timer.getPhases().size(), 2);
+  BOOST_CHECK_EQUAL(timer.getPhases()[0].first, "dialogs");
+  BOOST_CHECK(timer.getPhases()[0].second == time::milliseconds(12));
+  BOOST_CHECK(timer.getPhases()[1].second == time::milliseconds(30));
+  // the time after the last mark is not counted
+  BOOST_CHECK(timer.getTotal() == time::milliseconds(42));
+
+  std::ostringstream os;
+  os << timer;
+  BOOST_CHECK_EQUAL(os.str(), "startup: dialogs 12ms, tray 30ms, total 42ms");
+
+  time::setCustomClocks();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat
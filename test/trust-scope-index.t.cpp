@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "trust-scope-index.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace chronochat {
+
+namespace tests {
+
+static shared_ptr<Contact>
+makeIntroducer(const Name& identity, bool isIntroducer = true)
+{
+  const uint8_t key[] = {0x01, 0x02, 0x03, 0x04};
+  return std::make_shared<Contact>(identity, identity.toUri(),
+                                   Name(identity).append("KEY").append("1"),
+                                   time::system_clock::now(),
+                                   time::system_clock::now() + time::days(365),
+                                   ndn::Buffer(key, sizeof(key)), isIntroducer);
+}
+
+BOOST_AUTO_TEST_SUITE(TestTrustScopeIndex)
+
+BOOST_AUTO_TEST_CASE(FindIntroducers)
+{
+  TrustScopeIndex index;
+  index.add("/ndn/alice", "/ndn/edu/ucla");
+  index.add("/ndn/bob", "/ndn/edu");
+  index.add("/ndn/bob", "/ndn/org/bob");
+  index.add("/ndn/carol", "/ndn/edu/ucla/cs");
+  index.add("/ndn/carol", "/ndn/edu/ucla/cs");
+  BOOST_CHECK_EQUAL(index.size(), 4);
+
+  std::vector<Name> expected{"/ndn/alice", "/ndn/bob", "/ndn/carol"};
+  std::vector<Name> found = index.findIntroducers("/ndn/edu/ucla/cs/dave");
+  BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), expected.begin(), expected.end());
+
+  // scopes are prefixes of whole components
+  expected = {"/ndn/bob"};
+  found = index.findIntroducers("/ndn/edu/uclaX");
+  BOOST_CHECK_EQUAL_COLLECTIONS(found.begin(), found.end(), expected.begin(), expected.end());
+
+  BOOST_CHECK(index.findIntroducers("/ndn/org").empty());
+  BOOST_CHECK(index.canVouch("/ndn/bob", "/ndn/org/bob/phone"));
+  BOOST_CHECK(!index.canVouch("/ndn/alice", "/ndn/org/bob/phone"));
+  BOOST_CHECK(index.canVouch("/ndn/alice", "/ndn/edu/ucla"));
+  BOOST_CHECK(!index.canVouch("/ndn/alice", "/ndn/edu"));
+
+  index.remove("/ndn/bob");
+  BOOST_CHECK_EQUAL(index.size(), 2);
+  BOOST_CHECK(!index.canVouch("/ndn/bob", "/ndn/org/bob/phone"));
+  BOOST_CHECK(!index.canVouch("/ndn/bob", "/ndn/edu/ucla"));
+  BOOST_CHECK(index.canVouch("/ndn/alice", "/ndn/edu/ucla/cs"));
+  BOOST_CHECK(index.canVouch("/ndn/carol", "/ndn/edu/ucla/cs"));
+
+  index.clear();
+  BOOST_CHECK_EQUAL(index.size(), 0);
+  BOOST_CHECK(index.findIntroducers("/ndn/edu/ucla/cs/dave").empty());
+}
+
+BOOST_AUTO_TEST_CASE(Contacts)
+{
+  TrustScopeIndex index;
+
+  shared_ptr<Contact> alice = makeIntroducer("/ndn/alice");
+  alice->addTrustScope("/ndn/edu/ucla");
+  index.addContact(*alice);
+
+  // the scopes of a contact that is not an introducer are ignored
+  shared_ptr<Contact> bob = makeIntroducer("/ndn/bob", false);
+  bob->addTrustScope("/ndn/edu");
+  index.addContact(*bob);
+
+  BOOST_CHECK_EQUAL(index.size(), 1);
+
+  // the index agrees with the regular expressions of the contacts
+  for (const Name& name : {Name("/ndn/edu/ucla/dave"), Name("/ndn/edu/ucla"),
+                           Name("/ndn/edu/mit/dave"), Name("/ndn")})
+    BOOST_CHECK_EQUAL(index.canVouch("/ndn/alice", name), alice->canBeTrustedFor(name));
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark, *boost::unit_test::disabled())
+{
+  const size_t N_INTRODUCERS = 5000;
+  const size_t N_LOOKUPS = 1000;
+
+  std::vector<shared_ptr<Contact>> contacts;
+  TrustScopeIndex index;
+  for (size_t i = 0; i < N_INTRODUCERS; ++i) {
+    shared_ptr<Contact> contact = makeIntroducer(Name("/ndn/introducer-" + std::to_string(i)));
+    contact->addTrustScope(Name("/ndn/site-" + std::to_string(i % 100)));
+    contact->addTrustScope(Name("/ndn/site-" + std::to_string(i % 100))
+                           .append("group-" + std::to_string(i)));
+    contacts.push_back(contact);
+    index.addContact(*contact);
+  }
+
+  auto endorsee = [] (size_t i) {
+    return Name("/ndn/site-" + std::to_string(i % 100))
+             .append("group-" + std::to_string(i % N_INTRODUCERS))
+             .append("user-" + std::to_string(i));
+  };
+
+  // every introducer of the site, the one of the group is among them
+  const size_t nExpected = N_INTRODUCERS / 100;
+
+  auto start = time::steady_clock::now();
+  size_t nRegexMatches = 0;
+  for (size_t i = 0; i < N_LOOKUPS; ++i) {
+    Name name = endorsee(i);
+    for (const auto& contact : contacts)
+      if (contact->canBeTrustedFor(name))
+        nRegexMatches++;
+  }
+  auto regexTime = time::steady_clock::now() - start;
+
+  start = time::steady_clock::now();
+  size_t nIndexMatches = 0;
+  for (size_t i = 0; i < N_LOOKUPS; ++i)
+    nIndexMatches += index.findIntroducers(endorsee(i)).size();
+  auto indexTime = time::steady_clock::now() - start;
+
+  BOOST_CHECK_EQUAL(nIndexMatches, nRegexMatches);
+  BOOST_CHECK_EQUAL(nIndexMatches, N_LOOKUPS * nExpected);
+
+  BOOST_TEST_MESSAGE(N_INTRODUCERS << " introducers, " << N_LOOKUPS << " endorsees: "
+                     << time::duration_cast<time::milliseconds>(regexTime).count()
+                     << " ms matching the regular expressions of every contact, "
+                     << time::duration_cast<time::microseconds>(indexTime).count()
+                     << " us with the trust scope index");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+
+} // namespace chronochat
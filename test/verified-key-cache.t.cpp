@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2020, Regents of the University of California
+ *
+ * BSD license, See the LICENSE file for more information
+ */
+
+#include "verified-key-cache.hpp"
+#include "verified-key-validation-policy.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <ndn-cxx/security/certificate-fetcher-offline.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/security/validation-policy-config.hpp>
+#include <ndn-cxx/security/validator.hpp>
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+
+namespace chronochat {
+namespace tests {
+
+using ndn::security::Certificate;
+
+// the rule of validation-chat.conf for the chat data
+static const std::string CHAT_RULES = R"CONF(
+rule
+{
+  id "ALL2"
+  for data
+  filter
+  {
+    type name
+    regex (<>*)$
+  }
+  checker
+  {
+    type customized
+    sig-type rsa-sha256
+    key-locator
+    {
+      type name
+      hyper-relation
+      {
+        k-regex ^([^<KEY>]*)<KEY><>$
+        k-expand \\1
+        h-relation is-strict-prefix-of
+        p-regex (<>*)$
+        p-expand \\1
+      }
+    }
+  }
+}
+)CONF";
+
+class VerifiedKeyCacheFixture
+{
+public:
+  VerifiedKeyCacheFixture()
+    : systemClock(std::make_shared<time::UnitTestSystemClock>(
+        time::duration_cast<time::nanoseconds>(time::system_clock::now().time_since_epoch())))
+    , keyChain("pib-memory:", "tpm-memory:")
+  {
+    time::setCustomClocks(nullptr, systemClock);
+  }
+
+  ~VerifiedKeyCacheFixture()
+  {
+    time::setCustomClocks();
+  }
+
+  shared_ptr<Data>
+  makeChatData(const Name& session, uint64_t seqNo, const ndn::security::Key& key)
+  {
+    auto data = std::make_shared<Data>(Name(session).appendNumber(seqNo));
+    data->setContent(reinterpret_cast<const uint8_t*>("hello"), 5);
+    keyChain.sign(*data, ndn::security::signingByKey(key));
+    return data;
+  }
+
+public:
+  shared_ptr<time::UnitTestSystemClock> systemClock;
+  ndn::KeyChain keyChain;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestVerifiedKeyCache, VerifiedKeyCacheFixture)
+
+BOOST_AUTO_TEST_CASE(Verify)
+{
+  ndn::security::Key alice = keyChain.createIdentity("/ndn/alice").getDefaultKey();
+  ndn::security::Key bob = keyChain.createIdentity("/ndn/bob").getDefaultKey();
+  Name session("/ndn/alice/CHRONOCHAT-CHATDATA/lunch/1");
+
+  VerifiedKeyCache cache;
+  shared_ptr<Data> data = makeChatData(session, 1, alice);
+  BOOST_CHECK(!cache.verify(*data));
+
+  Certificate certificate = alice.getDefaultCertificate();
+  cache.insert(session, certificate);
+  BOOST_CHECK_EQUAL(cache.size(), 1);
+  BOOST_CHECK(cache.hasKey(session, alice.getName()));
+  BOOST_CHECK(cache.hasKey(session, certificate.getName()));
+  BOOST_CHECK(!cache.hasKey(session, bob.getName()));
+
+  BOOST_CHECK(cache.verify(*data));
+  BOOST_CHECK(cache.verify(*makeChatData(session, 2, alice)));
+
+  // another session of the same key is not known
+  BOOST_CHECK(!cache.verify(*makeChatData("/ndn/alice/CHRONOCHAT-CHATDATA/lunch/2", 1, alice)));
+
+  // another key in the session goes to the full validation
+  BOOST_CHECK(!cache.verify(*makeChatData(session, 3, bob)));
+
+  // a tampered packet
+  ndn::Buffer wire(data->wireEncode().wire(), data->wireEncode().size());
+  const std::string text = "hello";
+  auto content = std::search(wire.begin(), wire.end(), text.begin(), text.end());
+  BOOST_REQUIRE(content != wire.end());
+  *content = 'j';
+  BOOST_CHECK(!cache.verify(Data(Block(wire.data(), wire.size()))));
+
+  // the key expires with its certificate
+  systemClock->advance(certificate.getValidityPeriod().getPeriod().second -
+                       time::system_clock::now() + time::days(1));
+  BOOST_CHECK(!cache.verify(*data));
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+
+  cache.insert(session, certificate);
+  cache.erase(session);
+  BOOST_CHECK_EQUAL(cache.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Benchmark, *boost::unit_test::disabled())
+{
+  const size_t N_MESSAGES = 1000;
+
+  // /ndn is the trust anchor, it certifies the key of /ndn/alice
+  ndn::security::Identity root = keyChain.createIdentity("/ndn", ndn::RsaKeyParams());
+  ndn::security::Key alice =
+    keyChain.createIdentity("/ndn/alice", ndn::RsaKeyParams()).getDefaultKey();
+
+  Certificate aliceCertificate;
+  aliceCertificate.setName(Name(alice.getName()).append("ndn").appendVersion());
+  aliceCertificate.setContentType(ndn::tlv::ContentType_Key);
+  aliceCertificate.setFreshnessPeriod(time::hours(1));
+  aliceCertificate.setContent(alice.getPublicKey().data(), alice.getPublicKey().size());
+  ndn::SignatureInfo signatureInfo;
+  signatureInfo.setValidityPeriod(ndn::security::ValidityPeriod(
+    time::system_clock::now() - time::days(1), time::system_clock::now() + time::days(365)));
+  keyChain.sign(aliceCertificate,
+                ndn::security::signingByIdentity(root).setSignatureInfo(signatureInfo));
+
+  Name session("/ndn/alice/CHRONOCHAT-CHATDATA/lunch/1");
+  std::vector<shared_ptr<Data>> messages;
+  for (size_t i = 0; i < N_MESSAGES; ++i)
+    messages.push_back(makeChatData(session, i + 1, alice));
+
+  // the validator of a chat dialog, with or without the fast path
+  VerifiedKeyCache cache;
+  auto makeValidator = [&] (bool hasFastPath) {
+    auto configPolicy = std::make_unique<ndn::security::ValidationPolicyConfig>();
+    ndn::security::ValidationPolicyConfig& config = *configPolicy;
+    unique_ptr<ndn::security::ValidationPolicy> policy;
+    if (hasFastPath) {
+      policy = std::make_unique<VerifiedKeyValidationPolicy>(cache);
+      policy->setInnerPolicy(std::move(configPolicy));
+    }
+    else
+      policy = std::move(configPolicy);
+    auto validator = std::make_unique<ndn::security::Validator>(
+      std::move(policy), std::make_unique<ndn::security::CertificateFetcherOffline>());
+    config.load(CHAT_RULES, "validation-chat.conf");
+    validator->loadAnchor("/ndn", Certificate(root.getDefaultKey().getDefaultCertificate()));
+    // the certificate of alice was fetched and verified with her first message
+    validator->cacheVerifiedCertificate(Certificate(aliceCertificate));
+    return validator;
+  };
+
+  auto validateAll = [&] (ndn::security::Validator& validator) {
+    size_t nValidated = 0;
+    auto start = time::steady_clock::now();
+    for (const auto& message : messages)
+      validator.validate(*message,
+                         [&] (const Data&) { nValidated++; },
+                         [] (const Data&, const ndn::security::ValidationError&) {});
+    BOOST_CHECK_EQUAL(nValidated, N_MESSAGES);
+    return time::duration_cast<time::microseconds>(time::steady_clock::now() - start);
+  };
+
+  unique_ptr<ndn::security::Validator> fullValidator = makeValidator(false);
+  time::microseconds fullTime = validateAll(*fullValidator);
+
+  unique_ptr<ndn::security::Validator> fastValidator = makeValidator(true);
+  cache.insert(session, aliceCertificate);
+  time::microseconds fastTime = validateAll(*fastValidator);
+
+  BOOST_TEST_MESSAGE(N_MESSAGES << " chat messages of one session: "
+                     << fullTime.count() / N_MESSAGES << " us per message with the full "
+                     << "validation, " << fastTime.count() / N_MESSAGES
+                     << " us with the verified key of the session");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace chronochat